@@ -0,0 +1,48 @@
+/***************************************************************************
+ *  foxxll/common/timer.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/common/timer.hpp>
+
+#if FOXXLL_TIMESTAMP_TSC
+
+#include <thread>
+
+namespace foxxll {
+
+//! measures the time stamp counter against the steady clock
+static double calibrate_tsc()
+{
+    using clock = std::chrono::steady_clock;
+
+    const clock::time_point begin = clock::now();
+    const ticks_type tsc_begin = timestamp_ticks();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    const ticks_type tsc_end = timestamp_ticks();
+    const clock::time_point end = clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+    return seconds / static_cast<double>(tsc_end - tsc_begin);
+}
+
+double tsc_seconds_per_tick()
+{
+    static const double seconds_per_tick = calibrate_tsc();
+    return seconds_per_tick;
+}
+
+} // namespace foxxll
+
+#endif // FOXXLL_TIMESTAMP_TSC
+
+/**************************************************************************/
@@ -17,14 +17,22 @@
 #define FOXXLL_COMMON_TIMER_HEADER
 
 #include <chrono>
+#include <cstdint>
 #include <limits>
 #include <mutex>
 #include <string>
 
+#include <foxxll/config.hpp>
+
+#if FOXXLL_TIMESTAMP_COARSE
+ #include <time.h>
+#elif FOXXLL_TIMESTAMP_TSC
+ #include <x86intrin.h>
+#endif
+
 #include <tlx/logger/core.hpp>
 
 #include <foxxll/common/utils.hpp>
-#include <foxxll/config.hpp>
 #include <tlx/string/format_si_iec_units.hpp>
 
 namespace foxxll {
@@ -41,6 +49,72 @@ static inline double timestamp()
         ).count()) / 1e6;
 }
 
+//! \name Fast Timestamps
+//! \{
+
+//! Integer timestamp in ticks, see timestamp_ticks().
+using ticks_type = uint64_t;
+
+/*!
+ * Returns a timestamp in ticks of the clock selected by the CMake option
+ * FOXXLL_TIMESTAMP_SOURCE, which times I/O operations in the statistics:
+ *
+ * - steady: std::chrono::steady_clock in nanoseconds (default).
+ * - coarse: CLOCK_MONOTONIC_COARSE in nanoseconds, which skips reading the
+ *   hardware clock but only advances with the kernel's tick (1-4 ms), hence
+ *   only sums over many operations are meaningful, not their latencies.
+ * - tsc: the CPU's time stamp counter, calibrated against the steady clock.
+ *   Requires an invariant TSC, as all x86 CPUs of the last decade have.
+ *
+ * Ticks are integers, such that the statistics sum them with atomic integer
+ * additions, and are converted to seconds only when queried.
+ */
+static inline ticks_type timestamp_ticks()
+{
+#if FOXXLL_TIMESTAMP_COARSE
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<ticks_type>(ts.tv_sec) * 1000000000
+           + static_cast<ticks_type>(ts.tv_nsec);
+#elif FOXXLL_TIMESTAMP_TSC
+    return static_cast<ticks_type>(__rdtsc());
+#else
+    return static_cast<ticks_type>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count());
+#endif
+}
+
+#if FOXXLL_TIMESTAMP_TSC
+//! Seconds per tick of the time stamp counter, calibrated on the first call.
+double tsc_seconds_per_tick();
+#endif
+
+//! Returns the length of a tick of timestamp_ticks() in seconds.
+static inline double seconds_per_tick()
+{
+#if FOXXLL_TIMESTAMP_TSC
+    return tsc_seconds_per_tick();
+#else
+    return 1e-9;
+#endif
+}
+
+//! Converts a number of ticks to seconds.
+static inline double ticks_to_seconds(ticks_type ticks)
+{
+    return static_cast<double>(ticks) * seconds_per_tick();
+}
+
+//! Converts seconds to a number of ticks.
+static inline ticks_type seconds_to_ticks(double seconds)
+{
+    return static_cast<ticks_type>(seconds / seconds_per_tick());
+}
+
+//! \}
+
 /*!
  * Class timer is a simple stop watch timer. It uses the timestamp() function
  * to get the current time when start() is called. Then, after some processing,
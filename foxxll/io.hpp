@@ -15,16 +15,22 @@
 #define FOXXLL_IO_HEADER
 
 #include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io/chunked_memory_file.hpp>
+#include <foxxll/io/compressed_file.hpp>
 #include <foxxll/io/create_file.hpp>
 #include <foxxll/io/disk_queues.hpp>
 #include <foxxll/io/file.hpp>
 #include <foxxll/io/fileperblock_file.hpp>
 #include <foxxll/io/iostats.hpp>
+#include <foxxll/io/latency_histogram.hpp>
 #include <foxxll/io/linuxaio_file.hpp>
 #include <foxxll/io/memory_file.hpp>
+#include <foxxll/io/metrics_exporter.hpp>
 #include <foxxll/io/mmap_file.hpp>
 #include <foxxll/io/request.hpp>
 #include <foxxll/io/request_operations.hpp>
+#include <foxxll/io/request_queue_stats.hpp>
+#include <foxxll/io/request_tracer.hpp>
 #include <foxxll/io/syscall_file.hpp>
 #include <foxxll/io/wincall_file.hpp>
 
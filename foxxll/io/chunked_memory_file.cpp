@@ -0,0 +1,258 @@
+/***************************************************************************
+ *  foxxll/io/chunked_memory_file.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/io/chunked_memory_file.hpp>
+
+#if FOXXLL_HAVE_MMAP_FILE
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#include <tlx/logger/core.hpp>
+
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/common/utils.hpp>
+#include <foxxll/io/iostats.hpp>
+
+namespace foxxll {
+
+chunked_memory_file::chunked_memory_file(
+    int queue_id, int allocator_id, unsigned int device_id)
+    : file(device_id),
+      disk_queued_file(queue_id, allocator_id),
+      table_(nullptr), num_chunks_(0), size_(0),
+      page_size_(static_cast<size_t>(sysconf(_SC_PAGESIZE)))
+{ }
+
+chunked_memory_file::~chunked_memory_file()
+{
+    if (!tables_.empty())
+    {
+        const chunk_table& table = *tables_.back();
+        for (size_t i = 0; i < num_chunks_; ++i)
+            deallocate_chunk(table.chunks[i].load(std::memory_order_relaxed));
+    }
+}
+
+char* chunked_memory_file::allocate_chunk()
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif
+
+    // over-allocate by one huge page and trim the excess on both sides to
+    // obtain a chunk aligned to huge_page_size.
+    const size_t map_size = chunk_size + huge_page_size;
+    void* mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+    if (mem == MAP_FAILED)
+    {
+        FOXXLL_THROW_ERRNO(
+            io_error, "mmap() failed to allocate a chunk of " <<
+                chunk_size << " bytes"
+        );
+    }
+
+    char* raw = static_cast<char*>(mem);
+    const size_t head =
+        (huge_page_size - reinterpret_cast<uintptr_t>(raw) % huge_page_size)
+        % huge_page_size;
+    char* chunk = raw + head;
+
+    if (head > 0)
+        munmap(raw, head);
+    if (huge_page_size - head > 0)
+        munmap(chunk + chunk_size, huge_page_size - head);
+
+#ifdef MADV_HUGEPAGE
+    // only a hint: fails silently if transparent huge pages are disabled
+    madvise(chunk, chunk_size, MADV_HUGEPAGE);
+#endif
+
+    return chunk;
+}
+
+void chunked_memory_file::deallocate_chunk(char* chunk)
+{
+    if (chunk != nullptr && munmap(chunk, chunk_size) != 0)
+        TLX_LOG1 << "chunked_memory_file: munmap() failed: " << strerror(errno);
+}
+
+void chunked_memory_file::release_range(char* ptr, size_t bytes)
+{
+    if (bytes == 0)
+        return;
+
+#if defined(FOXXLL_MEMFILE_LAZY_FREE) && defined(MADV_FREE)
+    // pages are reclaimed lazily under memory pressure and may keep their
+    // contents until then.
+    int advice = MADV_FREE;
+#else
+    // pages are dropped immediately and read back as zeros.
+    int advice = MADV_DONTNEED;
+#endif
+
+    if (madvise(ptr, bytes, advice) != 0)
+        TLX_LOG1 << "chunked_memory_file: madvise() failed: " << strerror(errno);
+}
+
+void chunked_memory_file::serve(void* buffer, offset_type offset, size_type bytes,
+                                request::read_or_write op)
+{
+    assert(offset + bytes <= size_.load(std::memory_order_relaxed));
+
+    file_stats::scoped_read_write_timer read_write_timer(
+        file_stats_, bytes, op == request::WRITE);
+
+    const chunk_table* table = table_.load(std::memory_order_acquire);
+    char* buf = static_cast<char*>(buffer);
+
+    while (bytes > 0)
+    {
+        const size_t index = static_cast<size_t>(offset / chunk_size);
+        const size_t inner = static_cast<size_t>(offset % chunk_size);
+        const size_t part = std::min<size_t>(bytes, chunk_size - inner);
+
+        char* chunk = table->chunks[index].load(std::memory_order_acquire);
+        assert(chunk != nullptr);
+
+        if (op == request::READ)
+            memcpy(buf, chunk + inner, part);
+        else
+            memcpy(chunk + inner, buf, part);
+
+        buf += part;
+        offset += part;
+        bytes -= part;
+    }
+}
+
+const char* chunked_memory_file::io_type() const
+{
+    return "chunked_memory";
+}
+
+void chunked_memory_file::lock()
+{
+    // nothing to do
+}
+
+file::offset_type chunked_memory_file::size()
+{
+    return size_.load(std::memory_order_acquire);
+}
+
+void chunked_memory_file::set_size(offset_type newsize)
+{
+    std::unique_lock<std::mutex> lock(resize_mutex_);
+    assert(newsize <= std::numeric_limits<size_t>::max());
+
+    const size_t new_chunks =
+        static_cast<size_t>(div_ceil(newsize, offset_type(chunk_size)));
+    const offset_type oldsize = size_.load(std::memory_order_relaxed);
+
+    if (new_chunks > num_chunks_)
+    {
+        chunk_table* table = tables_.empty() ? nullptr : tables_.back().get();
+        bool replace = (table == nullptr || table->capacity < new_chunks);
+
+        if (replace)
+        {
+            // create larger table, the old one is retired but kept alive
+            // for concurrent readers.
+            size_t capacity = std::max<size_t>(
+                new_chunks, table ? 2 * table->capacity : 16);
+            std::unique_ptr<chunk_table> next(new chunk_table(capacity));
+
+            for (size_t i = 0; i < num_chunks_; ++i)
+                next->chunks[i].store(
+                    table->chunks[i].load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+
+            tables_.emplace_back(std::move(next));
+            table = tables_.back().get();
+        }
+
+        for (size_t i = num_chunks_; i < new_chunks; ++i)
+            table->chunks[i].store(allocate_chunk(), std::memory_order_release);
+
+        if (replace)
+            table_.store(table, std::memory_order_release);
+    }
+    else if (new_chunks < num_chunks_)
+    {
+        chunk_table* table = tables_.back().get();
+        for (size_t i = new_chunks; i < num_chunks_; ++i)
+            deallocate_chunk(
+                table->chunks[i].exchange(nullptr, std::memory_order_acq_rel));
+    }
+
+    if (newsize < oldsize && new_chunks > 0)
+    {
+        // drop the tail of the last chunk, such that regrowing the file
+        // yields zeroed memory as with ftruncate().
+        const offset_type tail = newsize - (new_chunks - 1) * offset_type(chunk_size);
+        const size_t inner = static_cast<size_t>(
+            div_ceil(tail, offset_type(page_size_)) * page_size_);
+        if (inner < chunk_size)
+        {
+            char* chunk = tables_.back()->chunks[new_chunks - 1].load(
+                std::memory_order_relaxed);
+            if (madvise(chunk + inner, chunk_size - inner, MADV_DONTNEED) != 0)
+                TLX_LOG1 << "chunked_memory_file: madvise() failed: " << strerror(errno);
+        }
+    }
+
+    num_chunks_ = new_chunks;
+    size_.store(newsize, std::memory_order_release);
+}
+
+void chunked_memory_file::discard(offset_type offset, offset_type size)
+{
+    std::unique_lock<std::mutex> lock(resize_mutex_);
+
+    // madvise() operates on whole pages only: shrink range to page boundaries
+    offset_type begin = div_ceil(offset, offset_type(page_size_)) * page_size_;
+    offset_type end = (offset + size) / page_size_ * page_size_;
+
+    TLX_LOG0 << "discard at " << offset << " len " << size
+             << " released [" << begin << "," << end << ")";
+
+    const chunk_table* table = table_.load(std::memory_order_relaxed);
+    end = std::min(end, size_.load(std::memory_order_relaxed));
+
+    while (begin < end)
+    {
+        const size_t index = static_cast<size_t>(begin / chunk_size);
+        const size_t inner = static_cast<size_t>(begin % chunk_size);
+        const size_t part = static_cast<size_t>(
+            std::min<offset_type>(end - begin, chunk_size - inner));
+
+        char* chunk = table->chunks[index].load(std::memory_order_relaxed);
+        if (chunk != nullptr)
+            release_range(chunk + inner, part);
+
+        begin += part;
+    }
+}
+
+} // namespace foxxll
+
+#endif // #if FOXXLL_HAVE_MMAP_FILE
+
+/**************************************************************************/
@@ -0,0 +1,124 @@
+/***************************************************************************
+ *  foxxll/io/chunked_memory_file.hpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef FOXXLL_IO_CHUNKED_MEMORY_FILE_HEADER
+#define FOXXLL_IO_CHUNKED_MEMORY_FILE_HEADER
+
+#include <foxxll/config.hpp>
+
+#if FOXXLL_HAVE_MMAP_FILE
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <foxxll/io/disk_queued_file.hpp>
+#include <foxxll/io/request.hpp>
+
+namespace foxxll {
+
+//! \addtogroup foxxll_fileimpl
+//! \{
+
+/*!
+ * Implementation of file based on anonymous memory mappings, which are
+ * allocated in fixed-size chunks aligned to huge pages.
+ *
+ * In contrast to memory_file, growing the file never moves existing data,
+ * requests are served without a global lock, and discarded regions are
+ * returned to the operating system with madvise().
+ *
+ * The chunk pointers are kept in a table which is only replaced (never
+ * modified in place below its current fill) when it runs out of capacity.
+ * Replaced tables are retired but kept until destruction, such that serve()
+ * may read a table without taking a lock.
+ */
+class chunked_memory_file final : public disk_queued_file
+{
+public:
+    //! size of one memory chunk, a multiple of huge_page_size
+    static constexpr size_t chunk_size = 64 * 1024 * 1024;
+
+    //! alignment of chunks, such that they can be backed by huge pages
+    static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+private:
+    //! fixed capacity table of chunk pointers
+    struct chunk_table
+    {
+        explicit chunk_table(size_t capacity)
+            : capacity(capacity),
+              chunks(new std::atomic<char*>[capacity])
+        {
+            for (size_t i = 0; i < capacity; ++i)
+                chunks[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        const size_t capacity;
+        std::unique_ptr<std::atomic<char*>[]> chunks;
+    };
+
+    //! currently published chunk table, read by serve() without lock
+    std::atomic<const chunk_table*> table_;
+
+    //! all tables ever published, retired ones are freed on destruction
+    std::vector<std::unique_ptr<chunk_table> > tables_;
+
+    //! number of chunks currently mapped
+    size_t num_chunks_;
+
+    //! size of "file"
+    std::atomic<offset_type> size_;
+
+    //! operating system page size, granularity of discard()
+    const size_t page_size_;
+
+    //! sequentialize set_size() calls, not taken by serve()
+    std::mutex resize_mutex_;
+
+    //! map a new chunk of chunk_size bytes aligned to huge_page_size
+    static char * allocate_chunk();
+
+    //! unmap a chunk previously returned by allocate_chunk()
+    static void deallocate_chunk(char* chunk);
+
+    //! release the physical memory of a page aligned range of a chunk
+    static void release_range(char* ptr, size_t bytes);
+
+public:
+    //! constructs file object.
+    chunked_memory_file(
+        int queue_id = DEFAULT_QUEUE,
+        int allocator_id = NO_ALLOCATOR,
+        unsigned int device_id = DEFAULT_DEVICE_ID);
+
+    ~chunked_memory_file();
+
+    void serve(void* buffer, offset_type offset, size_type bytes,
+               request::read_or_write op) final;
+    offset_type size() final;
+    void set_size(offset_type newsize) final;
+    void lock() final;
+    void discard(offset_type offset, offset_type size) final;
+    const char * io_type() const final;
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // #if FOXXLL_HAVE_MMAP_FILE
+
+#endif // !FOXXLL_IO_CHUNKED_MEMORY_FILE_HEADER
+
+/**************************************************************************/
@@ -0,0 +1,619 @@
+/***************************************************************************
+ *  foxxll/io/compressed_file.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tlx/logger/core.hpp>
+#include <tlx/unused.hpp>
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/common/exceptions.hpp>
+#include <foxxll/common/utils.hpp>
+#include <foxxll/io/compressed_file.hpp>
+#include <foxxll/io/disk_queues.hpp>
+#include <foxxll/io/serving_request.hpp>
+
+namespace foxxll {
+
+namespace {
+
+/******************************************************************************/
+// LZ4 block format codec
+//
+// A greedy compressor with a single hash table probe per position. It emits
+// the standard LZ4 block format: sequences of a token, literals, a 16-bit
+// match offset, and match length extensions. The last five bytes are always
+// literals and no match starts within the last twelve bytes.
+
+constexpr size_t lz4_min_match = 4;
+constexpr size_t lz4_last_literals = 5;
+constexpr size_t lz4_match_find_limit = 12;
+constexpr size_t lz4_max_offset = 65535;
+constexpr unsigned lz4_hash_bits = 14;
+
+//! maximum compressed size of n bytes
+size_t lz4_compress_bound(size_t n)
+{
+    return n + n / 255 + 16;
+}
+
+uint32_t lz4_read32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t lz4_hash(uint32_t seq)
+{
+    return (seq * 2654435761U) >> (32 - lz4_hash_bits);
+}
+
+//! write a length extension of a token nibble, returns false on overflow
+bool lz4_write_length(uint8_t*& op, const uint8_t* oend, size_t len)
+{
+    for ( ; len >= 255; len -= 255) {
+        if (op >= oend) return false;
+        *op++ = 255;
+    }
+    if (op >= oend) return false;
+    *op++ = static_cast<uint8_t>(len);
+    return true;
+}
+
+//! emit one sequence of literals followed by an optional match (mlen == 0)
+bool lz4_write_sequence(
+    uint8_t*& op, const uint8_t* oend,
+    const uint8_t* literals, size_t litlen, size_t offset, size_t mlen)
+{
+    if (op >= oend) return false;
+    uint8_t* token = op++;
+
+    size_t ml = mlen ? mlen - lz4_min_match : 0;
+    *token = static_cast<uint8_t>(
+        (std::min<size_t>(litlen, 15) << 4) | std::min<size_t>(ml, 15));
+
+    if (litlen >= 15 && !lz4_write_length(op, oend, litlen - 15))
+        return false;
+
+    if (static_cast<size_t>(oend - op) < litlen) return false;
+    memcpy(op, literals, litlen);
+    op += litlen;
+
+    if (mlen == 0)
+        return true;
+
+    if (oend - op < 2) return false;
+    *op++ = static_cast<uint8_t>(offset & 0xFF);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+
+    if (ml >= 15 && !lz4_write_length(op, oend, ml - 15))
+        return false;
+
+    return true;
+}
+
+//! compress n bytes from src into dst of capacity cap. Returns the compressed
+//! size or zero if it does not fit.
+size_t lz4_compress(const void* source, size_t n, void* dest, size_t cap)
+{
+    const uint8_t* src = static_cast<const uint8_t*>(source);
+    uint8_t* dst = static_cast<uint8_t*>(dest);
+    uint8_t* op = dst;
+    const uint8_t* oend = dst + cap;
+
+    size_t anchor = 0;
+
+    if (n > lz4_match_find_limit)
+    {
+        // positions are stored +1, zero marks an empty slot. The table of
+        // each thread is reused without clearing: stale entries of earlier
+        // inputs are rejected like hash collisions by comparing the bytes.
+        static thread_local std::vector<uint32_t> table;
+        table.resize(size_t(1) << lz4_hash_bits, 0);
+
+        const size_t limit = n - lz4_match_find_limit;
+        const size_t match_limit = n - lz4_last_literals;
+
+        size_t ip = 0;
+        while (ip < limit)
+        {
+            const uint32_t seq = lz4_read32(src + ip);
+            const uint32_t h = lz4_hash(seq);
+            const size_t ref = table[h];
+            table[h] = static_cast<uint32_t>(ip + 1);
+
+            if (ref == 0 || ref > ip || ip - (ref - 1) > lz4_max_offset ||
+                lz4_read32(src + ref - 1) != seq)
+            {
+                ++ip;
+                continue;
+            }
+
+            const size_t match = ref - 1;
+            size_t mlen = lz4_min_match;
+            while (ip + mlen < match_limit && src[match + mlen] == src[ip + mlen])
+                ++mlen;
+
+            if (!lz4_write_sequence(op, oend, src + anchor, ip - anchor,
+                                    ip - match, mlen))
+                return 0;
+
+            ip += mlen;
+            anchor = ip;
+        }
+    }
+
+    if (!lz4_write_sequence(op, oend, src + anchor, n - anchor, 0, 0))
+        return 0;
+
+    return static_cast<size_t>(op - dst);
+}
+
+//! decompress n bytes from src into exactly out_n bytes at dst. Returns false
+//! if the input is malformed.
+bool lz4_decompress(const void* source, size_t n, void* dest, size_t out_n)
+{
+    const uint8_t* src = static_cast<const uint8_t*>(source);
+    uint8_t* dst = static_cast<uint8_t*>(dest);
+    size_t ip = 0, op = 0;
+
+    while (ip < n)
+    {
+        const unsigned token = src[ip++];
+
+        size_t litlen = token >> 4;
+        if (litlen == 15) {
+            uint8_t b;
+            do {
+                if (ip >= n) return false;
+                b = src[ip++];
+                litlen += b;
+            } while (b == 255);
+        }
+
+        if (litlen > n - ip || litlen > out_n - op) return false;
+        memcpy(dst + op, src + ip, litlen);
+        ip += litlen;
+        op += litlen;
+
+        // last sequence has no match
+        if (ip == n) break;
+
+        if (n - ip < 2) return false;
+        const size_t offset = src[ip] | (size_t(src[ip + 1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) return false;
+
+        size_t mlen = token & 15;
+        if (mlen == 15) {
+            uint8_t b;
+            do {
+                if (ip >= n) return false;
+                b = src[ip++];
+                mlen += b;
+            } while (b == 255);
+        }
+        mlen += lz4_min_match;
+
+        if (mlen > out_n - op) return false;
+        // byte-wise copy, source and destination may overlap
+        for (size_t i = 0; i < mlen; ++i, ++op)
+            dst[op] = dst[op - offset];
+    }
+
+    return op == out_n;
+}
+
+/******************************************************************************/
+
+//! aligned temporary buffer for direct I/O to the underlying file
+class aligned_buffer
+{
+public:
+    explicit aligned_buffer(size_t bytes)
+        : ptr_(static_cast<char*>(aligned_alloc<BlockAlignment>(bytes)))
+    { }
+
+    aligned_buffer(const aligned_buffer&) = delete;
+    aligned_buffer& operator = (const aligned_buffer&) = delete;
+
+    ~aligned_buffer()
+    {
+        aligned_dealloc<BlockAlignment>(ptr_);
+    }
+
+    char * get() const { return ptr_; }
+
+private:
+    char* ptr_;
+};
+
+//! round up to a multiple of BlockAlignment
+file::offset_type round_up_to_alignment(file::offset_type bytes)
+{
+    return div_ceil(bytes, file::offset_type(BlockAlignment)) * BlockAlignment;
+}
+
+} // namespace
+
+/******************************************************************************/
+
+compressed_file::compressed_file(
+    const file_ptr& base, algorithm_type algorithm,
+    int allocator_id, unsigned int device_id, size_t num_workers)
+    : file(device_id, base->get_file_stats()),
+      base_(base),
+      algorithm_(algorithm),
+      allocator_id_(allocator_id),
+      size_(0),
+      phys_end_(0),
+      logical_bytes_(0),
+      physical_bytes_(0),
+      terminate_(false)
+{
+    need_alignment_ = base_->need_alignment();
+
+    // create the base file's queue now: we share its queue id, and the first
+    // queue created for an id determines its type (e.g. linuxaio).
+    disk_queues::get_instance()->make_queue(base_.get());
+
+    if (num_workers == 0)
+        num_workers = std::max(1u, std::thread::hardware_concurrency() / 2);
+
+    for (size_t i = 0; i < num_workers; ++i)
+        workers_.emplace_back([this]() { worker(); });
+}
+
+compressed_file::~compressed_file()
+{
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        terminate_ = true;
+    }
+    queue_cv_.notify_all();
+
+    for (std::thread& t : workers_)
+        t.join();
+}
+
+size_t compressed_file::compress_bound(algorithm_type algorithm, size_t n)
+{
+    assert(algorithm == LZ4);
+    tlx::unused(algorithm);
+    return lz4_compress_bound(n);
+}
+
+size_t compressed_file::compress(
+    algorithm_type algorithm,
+    const void* source, size_t n, void* dest, size_t cap)
+{
+    assert(algorithm == LZ4);
+    tlx::unused(algorithm);
+    return lz4_compress(source, n, dest, cap);
+}
+
+bool compressed_file::decompress(
+    algorithm_type algorithm,
+    const void* source, size_t n, void* dest, size_t out_n)
+{
+    assert(algorithm == LZ4);
+    tlx::unused(algorithm);
+    return lz4_decompress(source, n, dest, out_n);
+}
+
+compressed_file::algorithm_type
+compressed_file::parse_algorithm(const std::string& spec)
+{
+    if (spec == "lz4")
+        return LZ4;
+
+    FOXXLL_THROW(
+        std::runtime_error,
+        "Unsupported compression '" << spec << "', only lz4 is available."
+    );
+}
+
+void compressed_file::worker()
+{
+    for ( ; ; )
+    {
+        request_ptr req;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(
+                lock, [this]() { return terminate_ || !queue_.empty(); });
+
+            if (queue_.empty())
+                return;
+
+            req = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        // calls serve() and signals completion
+        static_cast<serving_request*>(req.get())->serve();
+    }
+}
+
+request_ptr compressed_file::submit(request_ptr req)
+{
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        queue_.push_back(req);
+    }
+    queue_cv_.notify_one();
+    return req;
+}
+
+request_ptr compressed_file::aread(
+    void* buffer, offset_type pos, size_type bytes,
+    const completion_handler& on_complete)
+{
+    return submit(
+        tlx::make_counting<serving_request>(
+            on_complete, this, buffer, pos, bytes, request::READ
+        ));
+}
+
+request_ptr compressed_file::awrite(
+    void* buffer, offset_type pos, size_type bytes,
+    const completion_handler& on_complete)
+{
+    return submit(
+        tlx::make_counting<serving_request>(
+            on_complete, this, buffer, pos, bytes, request::WRITE
+        ));
+}
+
+void compressed_file::serve(void* buffer, offset_type offset, size_type bytes,
+                            request::read_or_write op)
+{
+    assert(algorithm_ == LZ4);
+
+    if (op == request::WRITE)
+    {
+        const offset_type raw_phys_bytes = round_up_to_alignment(bytes);
+
+        const size_t bound = compress_bound(algorithm_, bytes);
+        aligned_buffer cbuf(static_cast<size_t>(round_up_to_alignment(bound)));
+        size_t cbytes = compress(algorithm_, buffer, bytes, cbuf.get(), bound);
+
+        // store raw if compression does not save at least one aligned unit
+        const bool raw =
+            (cbytes == 0 || round_up_to_alignment(cbytes) >= raw_phys_bytes);
+
+        extent ext;
+        ext.data_bytes = raw ? bytes : cbytes;
+        ext.phys_bytes = round_up_to_alignment(ext.data_bytes);
+        ext.logical_bytes = bytes;
+        ext.raw = raw;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            remove_extent(offset);
+            ext.phys_offset = allocate(ext.phys_bytes);
+            extents_[offset] = ext;
+            logical_bytes_ += ext.logical_bytes;
+            physical_bytes_ += ext.phys_bytes;
+        }
+
+        TLX_LOG << "compressed_file::serve() write " << offset << " + " << bytes
+                << " -> " << ext.phys_offset << " + " << ext.data_bytes
+                << (raw ? " raw" : "");
+
+        request_ptr req;
+        if (raw) {
+            req = base_->awrite(buffer, ext.phys_offset, bytes);
+        }
+        else {
+            memset(cbuf.get() + cbytes, 0, ext.phys_bytes - cbytes);
+            req = base_->awrite(cbuf.get(), ext.phys_offset, ext.phys_bytes);
+        }
+        req->wait(false);
+    }
+    else
+    {
+        extent ext;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            extent_map_type::const_iterator it = extents_.find(offset);
+            if (it == extents_.end()) {
+                // never written: deliver zeros like a sparse file
+                lock.unlock();
+                memset(buffer, 0, bytes);
+                return;
+            }
+            ext = it->second;
+        }
+
+        if (bytes > ext.logical_bytes) {
+            FOXXLL_THROW(
+                io_error,
+                "compressed_file: read of " << bytes << " bytes at " << offset <<
+                    " exceeds the block of " << ext.logical_bytes << " bytes written there"
+            );
+        }
+
+        if (ext.raw) {
+            base_->aread(buffer, ext.phys_offset, bytes)->wait(false);
+            return;
+        }
+
+        aligned_buffer cbuf(static_cast<size_t>(ext.phys_bytes));
+        base_->aread(cbuf.get(), ext.phys_offset, ext.phys_bytes)->wait(false);
+
+        bool ok;
+        if (bytes == ext.logical_bytes) {
+            ok = decompress(algorithm_, cbuf.get(), ext.data_bytes, buffer, bytes);
+        }
+        else {
+            std::vector<char> block(ext.logical_bytes);
+            ok = decompress(algorithm_, cbuf.get(), ext.data_bytes,
+                            block.data(), ext.logical_bytes);
+            memcpy(buffer, block.data(), bytes);
+        }
+
+        if (!ok) {
+            FOXXLL_THROW(
+                io_error,
+                "compressed_file: corrupt compressed block at " << offset
+            );
+        }
+    }
+}
+
+file::offset_type compressed_file::allocate(offset_type bytes)
+{
+    // first fit in the free regions, otherwise append
+    for (space_map_type::iterator it = free_space_.begin();
+         it != free_space_.end(); ++it)
+    {
+        if (it->second < bytes)
+            continue;
+
+        const offset_type pos = it->first;
+        const offset_type rest = it->second - bytes;
+        free_space_.erase(it);
+        if (rest > 0)
+            free_space_[pos + bytes] = rest;
+        return pos;
+    }
+
+    const offset_type pos = phys_end_;
+    phys_end_ += bytes;
+    if (phys_end_ > base_->size())
+        base_->set_size(phys_end_);
+    return pos;
+}
+
+void compressed_file::deallocate(offset_type pos, offset_type bytes)
+{
+    space_map_type::iterator succ = free_space_.lower_bound(pos);
+
+    if (succ != free_space_.end() && succ->first == pos + bytes) {
+        bytes += succ->second;
+        succ = free_space_.erase(succ);
+    }
+
+    if (succ != free_space_.begin()) {
+        space_map_type::iterator pred = std::prev(succ);
+        if (pred->first + pred->second == pos) {
+            pos = pred->first;
+            bytes += pred->second;
+            free_space_.erase(pred);
+        }
+    }
+
+    if (pos + bytes == phys_end_)
+        phys_end_ = pos;
+    else
+        free_space_[pos] = bytes;
+}
+
+void compressed_file::remove_extent(offset_type offset)
+{
+    extent_map_type::iterator it = extents_.find(offset);
+    if (it == extents_.end())
+        return;
+
+    deallocate(it->second.phys_offset, it->second.phys_bytes);
+    logical_bytes_ -= it->second.logical_bytes;
+    physical_bytes_ -= it->second.phys_bytes;
+    extents_.erase(it);
+}
+
+void compressed_file::discard(offset_type offset, offset_type size)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // remove consecutive blocks written in the discarded region. The freed
+    // physical space is passed on to the underlying file while holding the
+    // lock, such that it cannot be reallocated in between.
+    for (offset_type pos = offset; pos < offset + size; )
+    {
+        extent_map_type::iterator it = extents_.find(pos);
+        if (it == extents_.end())
+            break;
+
+        pos += it->second.logical_bytes;
+        base_->discard(it->second.phys_offset, it->second.phys_bytes);
+        remove_extent(it->first);
+    }
+}
+
+file::offset_type compressed_file::size()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return size_;
+}
+
+void compressed_file::set_size(offset_type newsize)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_ = newsize;
+}
+
+void compressed_file::lock()
+{
+    base_->lock();
+}
+
+void compressed_file::sync()
+{
+    base_->sync();
+}
+
+void compressed_file::close_remove()
+{
+    base_->close_remove();
+}
+
+int compressed_file::get_queue_id() const
+{
+    return base_->get_queue_id();
+}
+
+int compressed_file::get_allocator_id() const
+{
+    return allocator_id_;
+}
+
+const char* compressed_file::io_type() const
+{
+    return "compressed";
+}
+
+external_size_type compressed_file::logical_bytes() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return logical_bytes_;
+}
+
+external_size_type compressed_file::physical_bytes() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return physical_bytes_;
+}
+
+} // namespace foxxll
+
+/**************************************************************************/
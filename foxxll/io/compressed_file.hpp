@@ -0,0 +1,197 @@
+/***************************************************************************
+ *  foxxll/io/compressed_file.hpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef FOXXLL_IO_COMPRESSED_FILE_HEADER
+#define FOXXLL_IO_COMPRESSED_FILE_HEADER
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <foxxll/io/file.hpp>
+#include <foxxll/io/request.hpp>
+
+namespace foxxll {
+
+//! \addtogroup foxxll_fileimpl
+//! \{
+
+/*!
+ * File decorator which transparently compresses blocks written to an
+ * underlying file and decompresses them on reading.
+ *
+ * Each write is compressed as a whole and stored at a physical location of
+ * the underlying file chosen by an internal extent map, since block_manager
+ * hands out fixed logical offsets. Incompressible data is stored raw. Reads
+ * must start at the logical offset of a previous write and may not be larger
+ * than it, which is always the case for blocks of the block_manager.
+ *
+ * Compression and decompression run on a pool of worker threads, which then
+ * issue the physical I/O to the underlying file's disk queue. Hence, the
+ * decorator has no request queue of its own.
+ */
+class compressed_file final : public file
+{
+    constexpr static bool debug = false;
+
+public:
+    //! supported compression algorithms
+    enum algorithm_type { LZ4 = 1 };
+
+    //! Constructs file object.
+    //! \param base underlying file storing the compressed blocks
+    //! \param algorithm compression algorithm
+    //! \param allocator_id linked disk_allocator
+    //! \param device_id physical device identifier
+    //! \param num_workers number of compression threads, 0 -> half the cores
+    compressed_file(
+        const file_ptr& base,
+        algorithm_type algorithm = LZ4,
+        int allocator_id = NO_ALLOCATOR,
+        unsigned int device_id = DEFAULT_DEVICE_ID,
+        size_t num_workers = 0);
+
+    ~compressed_file();
+
+    //! parse a compression specification like "lz4", throws
+    //! std::runtime_error if the algorithm is not supported.
+    static algorithm_type parse_algorithm(const std::string& spec);
+
+    //! maximum size of n bytes after compression with algorithm
+    static size_t compress_bound(algorithm_type algorithm, size_t n);
+
+    //! compress n bytes from source into dest of capacity cap. Returns the
+    //! compressed size or zero if it does not fit.
+    static size_t compress(
+        algorithm_type algorithm,
+        const void* source, size_t n, void* dest, size_t cap);
+
+    //! decompress n bytes from source into exactly out_n bytes at dest.
+    //! Returns false if the input is malformed.
+    static bool decompress(
+        algorithm_type algorithm,
+        const void* source, size_t n, void* dest, size_t out_n);
+
+    using file::aread;
+    using file::awrite;
+
+    request_ptr aread(
+        void* buffer, offset_type pos, size_type bytes,
+        const completion_handler& on_complete = completion_handler()) final;
+
+    request_ptr awrite(
+        void* buffer, offset_type pos, size_type bytes,
+        const completion_handler& on_complete = completion_handler()) final;
+
+    //! synchronously (de)compress and transfer a block, called by the workers.
+    void serve(void* buffer, offset_type offset, size_type bytes,
+               request::read_or_write op) final;
+
+    offset_type size() final;
+    void set_size(offset_type newsize) final;
+    void lock() final;
+    void sync() final;
+    void discard(offset_type offset, offset_type size) final;
+    void close_remove() final;
+
+    int get_queue_id() const final;
+    int get_allocator_id() const final;
+
+    const char * io_type() const final;
+
+    //! return number of bytes written before compression
+    external_size_type logical_bytes() const;
+
+    //! return number of bytes occupied in the underlying file
+    external_size_type physical_bytes() const;
+
+private:
+    //! location of a compressed block in the underlying file
+    struct extent
+    {
+        //! offset in the underlying file
+        offset_type phys_offset;
+        //! allocated bytes in the underlying file, a multiple of BlockAlignment
+        offset_type phys_bytes;
+        //! bytes of compressed data
+        size_type data_bytes;
+        //! uncompressed size of the block
+        size_type logical_bytes;
+        //! whether the block was stored without compression
+        bool raw;
+    };
+
+    using extent_map_type = std::unordered_map<offset_type, extent>;
+    using space_map_type = std::map<offset_type, offset_type>;
+
+    //! underlying file
+    file_ptr base_;
+
+    //! compression algorithm
+    algorithm_type algorithm_;
+
+    int allocator_id_;
+
+    //! logical size of the file
+    offset_type size_;
+
+    //! protects extents_, free_space_, phys_end_ and the byte counters
+    mutable std::mutex mutex_;
+
+    //! extent map: logical offset -> physical location
+    extent_map_type extents_;
+
+    //! free regions of the underlying file below phys_end_
+    space_map_type free_space_;
+
+    //! end of the used space in the underlying file
+    offset_type phys_end_;
+
+    //! statistics
+    external_size_type logical_bytes_, physical_bytes_;
+
+    //! \name Worker Pool
+    //! \{
+
+    std::vector<std::thread> workers_;
+    std::deque<request_ptr> queue_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    bool terminate_;
+
+    void worker();
+    request_ptr submit(request_ptr req);
+
+    //! \}
+
+    //! allocate physical space, expects mutex_ to be locked
+    offset_type allocate(offset_type bytes);
+
+    //! free physical space, expects mutex_ to be locked
+    void deallocate(offset_type pos, offset_type bytes);
+
+    //! remove the extent of a logical offset, expects mutex_ to be locked
+    void remove_extent(offset_type offset);
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !FOXXLL_IO_COMPRESSED_FILE_HEADER
+
+/**************************************************************************/
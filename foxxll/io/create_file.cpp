@@ -69,6 +69,26 @@ file_ptr create_file(disk_config& cfg, int mode, int disk_allocator_id)
         config::get_instance()->update_max_device_id(cfg.device_id);
     }
 
+    // *** Wrap fileio Implementation in a compressed_file
+
+    if (!cfg.compress.empty())
+    {
+        disk_config base_cfg = cfg;
+        base_cfg.compress.clear();
+
+        file_ptr base = create_file(base_cfg, mode, file::NO_ALLOCATOR);
+
+        // take over settings changed by the fileio (e.g. raw_device)
+        std::string compress = cfg.compress;
+        cfg = base_cfg;
+        cfg.compress = compress;
+
+        return tlx::make_counting<compressed_file>(
+            base, compressed_file::parse_algorithm(cfg.compress),
+            disk_allocator_id, cfg.device_id
+        );
+    }
+
     // *** Select fileio Implementation
 
     if (cfg.io_impl == "syscall")
@@ -180,6 +200,15 @@ file_ptr create_file(disk_config& cfg, int mode, int disk_allocator_id)
         result->lock();
         return result;
     }
+    else if (cfg.io_impl == "chunked_memory")
+    {
+        tlx::counting_ptr<chunked_memory_file> result =
+            tlx::make_counting<chunked_memory_file>(
+                cfg.queue, disk_allocator_id, cfg.device_id
+            );
+        result->lock();
+        return result;
+    }
 #endif
 #if FOXXLL_HAVE_WINCALL_FILE
     else if (cfg.io_impl == "wincall")
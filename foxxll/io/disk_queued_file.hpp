@@ -33,6 +33,9 @@ public:
         : queue_id_(queue_id), allocator_id_(allocator_id)
     { }
 
+    using file::aread;
+    using file::awrite;
+
     request_ptr aread(
         void* buffer, offset_type pos, size_type bytes,
         const completion_handler& on_complete = completion_handler()) override;
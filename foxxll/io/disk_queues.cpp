@@ -19,6 +19,7 @@
 #include <foxxll/io/linuxaio_queue.hpp>
 #include <foxxll/io/linuxaio_request.hpp>
 #include <foxxll/io/request_queue_impl_qwqr.hpp>
+#include <foxxll/io/request_tracer.hpp>
 #include <foxxll/io/serving_request.hpp>
 
 namespace foxxll {
@@ -81,6 +82,7 @@ void disk_queues::add_request(request_ptr& req, disk_id_type disk)
     else
         q = qi->second;
 
+    request_tracer::trace(req.get(), request_tracer::SUBMIT);
     q->add_request(req);
 }
 
@@ -107,6 +109,28 @@ request_queue* disk_queues::get_queue(disk_id_type disk)
         return nullptr;
 }
 
+request_queue_stats_data disk_queues::get_queue_stats(disk_id_type disk)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    request_queue_map::iterator qi = queues_.find(disk);
+    if (qi == queues_.end())
+        return request_queue_stats_data();
+
+    return request_queue_stats_data(qi->second->get_stats());
+}
+
+std::vector<std::pair<disk_queues::disk_id_type, request_queue_stats_data> >
+disk_queues::get_queue_stats()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    std::vector<std::pair<disk_id_type, request_queue_stats_data> > result;
+    for (const auto& q : queues_)
+        result.emplace_back(q.first, request_queue_stats_data(q.second->get_stats()));
+    return result;
+}
+
 void disk_queues::set_priority_op(const request_queue::priority_op& op)
 {
     std::unique_lock<std::mutex> lock(mutex_);
@@ -18,6 +18,8 @@
 
 #include <map>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include <foxxll/io/file.hpp>
 #include <foxxll/io/iostats.hpp>
@@ -26,6 +28,7 @@
 #include <foxxll/io/request.hpp>
 #include <foxxll/io/request_queue.hpp>
 #include <foxxll/io/request_queue_impl_qwqr.hpp>
+#include <foxxll/io/request_queue_stats.hpp>
 #include <foxxll/io/serving_request.hpp>
 #include <foxxll/singleton.hpp>
 
@@ -40,7 +43,10 @@ class disk_queues : public singleton<disk_queues>
 {
     friend class singleton<disk_queues>;
 
+public:
     using disk_id_type = int64_t;
+
+private:
     using request_queue_map = std::map<disk_id_type, request_queue*>;
 
 protected:
@@ -67,6 +73,16 @@ public:
 
     request_queue * get_queue(disk_id_type disk);
 
+    //! Returns the gauges of the queue of a disk: waiting and in-flight
+    //! requests and the time requests waited in it.
+    //! \param disk disk number of the queue
+    //! \return gauges, all zero if the disk has no queue
+    request_queue_stats_data get_queue_stats(disk_id_type disk);
+
+    //! Returns the gauges of all queues, ordered by disk number.
+    std::vector<std::pair<disk_id_type, request_queue_stats_data> >
+    get_queue_stats();
+
     ~disk_queues();
 
     //! Changes requests priorities.
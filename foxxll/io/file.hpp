@@ -132,6 +132,26 @@ public:
         void* buffer, offset_type pos, size_type bytes,
         const completion_handler& on_complete = completion_handler()) = 0;
 
+    //! Schedules an asynchronous read request attributed to an I/O tag,
+    //! regardless of the scoped_io_tag of the calling thread.
+    request_ptr aread(
+        void* buffer, offset_type pos, size_type bytes, io_tag_type tag,
+        const completion_handler& on_complete = completion_handler())
+    {
+        scoped_io_tag scope(tag);
+        return aread(buffer, pos, bytes, on_complete);
+    }
+
+    //! Schedules an asynchronous write request attributed to an I/O tag,
+    //! regardless of the scoped_io_tag of the calling thread.
+    request_ptr awrite(
+        void* buffer, offset_type pos, size_type bytes, io_tag_type tag,
+        const completion_handler& on_complete = completion_handler())
+    {
+        scoped_io_tag scope(tag);
+        return awrite(buffer, pos, bytes, on_complete);
+    }
+
     virtual void serve(void* buffer, offset_type offset, size_type bytes,
                        request::read_or_write op) = 0;
 
@@ -139,6 +159,15 @@ public:
     //! \param newsize new file size
     virtual void set_size(offset_type newsize) = 0;
 
+    //! Changes the size of the file and allocates the disk space of the
+    //! extension, such that the first writes to it are not slowed down by
+    //! the file system. Falls back to set_size() if not supported.
+    //! \param newsize new file size
+    virtual void preallocate(offset_type newsize)
+    {
+        set_size(newsize);
+    }
+
     //! Returns size of the file.
     //! \return file size in bytes
     virtual offset_type size() = 0;
@@ -154,6 +183,10 @@ public:
     //! Locks file for reading and writing (acquires a lock in the file system).
     virtual void lock() = 0;
 
+    //! Flushes the written data of the file to stable storage. Requests must
+    //! have completed before.
+    virtual void sync() { }
+
     //! Discard a region of the file (mark it unused).
     //! Some specialized file types may need to know freed regions
     virtual void discard(offset_type offset, offset_type size)
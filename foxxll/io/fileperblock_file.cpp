@@ -54,6 +54,9 @@ fileperblock_file<base_file_type>::fileperblock_file(
 template <class base_file_type>
 fileperblock_file<base_file_type>::~fileperblock_file()
 {
+    open_files_index_.clear();
+    open_files_.clear();
+
     if (lock_file_)
         lock_file_->close_remove();
 }
@@ -72,10 +75,67 @@ void fileperblock_file<base_file_type>::serve(
     void* buffer, offset_type offset,
     size_type bytes, request::read_or_write op)
 {
-    base_file_type base_file(filename_for_block(offset), mode_, get_queue_id(),
-                             NO_ALLOCATOR, DEFAULT_DEVICE_ID, file_stats_);
-    base_file.set_size(bytes);
-    base_file.serve(buffer, 0, bytes, op);
+    // hold a reference, the file may be evicted from the cache concurrently
+    base_file_ptr base_file = get_block_file(offset, bytes);
+    base_file->serve(buffer, 0, bytes, op);
+}
+
+template <class base_file_type>
+typename fileperblock_file<base_file_type>::base_file_ptr
+fileperblock_file<base_file_type>::get_block_file(offset_type offset, size_type bytes)
+{
+    base_file_ptr evicted;
+    std::unique_lock<std::mutex> lock(open_files_mutex_);
+
+    auto it = open_files_index_.find(offset);
+    if (it != open_files_index_.end())
+    {
+        // move to front of LRU list
+        open_files_.splice(open_files_.begin(), open_files_, it->second);
+        open_file& entry = open_files_.front();
+        if (entry.size < bytes)
+        {
+            entry.file->set_size(bytes);
+            entry.size = bytes;
+        }
+        return entry.file;
+    }
+
+    base_file_ptr base_file(
+        new base_file_type(filename_for_block(offset), mode_, get_queue_id(),
+                           NO_ALLOCATOR, DEFAULT_DEVICE_ID, file_stats_)
+    );
+    base_file->set_size(bytes);
+
+    if (open_files_.size() >= open_files_cache_size)
+    {
+        // evict least recently used file, it is closed after unlocking
+        evicted = std::move(open_files_.back().file);
+        open_files_index_.erase(open_files_.back().offset);
+        open_files_.pop_back();
+    }
+
+    open_files_.push_front(open_file { offset, base_file, bytes });
+    open_files_index_[offset] = open_files_.begin();
+
+    lock.unlock();
+    return base_file;
+}
+
+template <class base_file_type>
+typename fileperblock_file<base_file_type>::base_file_ptr
+fileperblock_file<base_file_type>::invalidate_block_file(offset_type offset)
+{
+    std::unique_lock<std::mutex> lock(open_files_mutex_);
+
+    auto it = open_files_index_.find(offset);
+    if (it == open_files_index_.end())
+        return base_file_ptr();
+
+    base_file_ptr base_file = std::move(it->second->file);
+    open_files_.erase(it->second);
+    open_files_index_.erase(it);
+    return base_file;
 }
 
 template <class base_file_type>
@@ -105,6 +165,9 @@ template <class base_file_type>
 void fileperblock_file<base_file_type>::discard(offset_type offset, offset_type length)
 {
     tlx::unused(length);
+    // close the cached file, otherwise its space is not freed on remove()
+    invalidate_block_file(offset);
+
 #ifdef FOXXLL_FILEPERBLOCK_NO_DELETE
     if (::truncate(filename_for_block(offset).c_str(), 0) != 0)
         TLX_LOG1 << "truncate() error on path=" << filename_for_block(offset)
@@ -121,6 +184,8 @@ void fileperblock_file<base_file_type>::discard(offset_type offset, offset_type
 template <class base_file_type>
 void fileperblock_file<base_file_type>::export_files(offset_type offset, offset_type length, std::string filename)
 {
+    invalidate_block_file(offset);
+
     std::string original(filename_for_block(offset));
     filename.insert(0, original.substr(0, original.find_last_of("/") + 1));
     if (::remove(filename.c_str()) != 0)
@@ -13,7 +13,13 @@
 #ifndef FOXXLL_IO_FILEPERBLOCK_FILE_HEADER
 #define FOXXLL_IO_FILEPERBLOCK_FILE_HEADER
 
+#include <list>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <tlx/counting_ptr.hpp>
 
 #include <foxxll/io/disk_queued_file.hpp>
 
@@ -29,16 +35,47 @@ class fileperblock_file : public disk_queued_file
 {
     constexpr static bool debug = false;
 
+public:
+    //! maximum number of per-block files kept open in the LRU cache
+    constexpr static size_t open_files_cache_size = 64;
+
 private:
+    using base_file_ptr = tlx::counting_ptr<base_file_type>;
+
+    //! entry of the open files cache: offset, opened file and its size
+    struct open_file
+    {
+        offset_type offset;
+        base_file_ptr file;
+        offset_type size;
+    };
+
+    using open_file_list = std::list<open_file>;
+
     std::string filename_prefix_;
     int mode_;
     offset_type current_size_;
     tlx::counting_ptr<base_file_type> lock_file_;
 
+    //! open per-block files, most recently used first
+    open_file_list open_files_;
+    //! index into open_files_ by block offset
+    std::unordered_map<offset_type, typename open_file_list::iterator> open_files_index_;
+    //! protects open_files_ and open_files_index_
+    std::mutex open_files_mutex_;
+
 protected:
     //! Constructs a file name for a given block.
     std::string filename_for_block(offset_type offset);
 
+    //! Returns an open file for the block at offset which is at least bytes
+    //! long, either from the cache or by opening it.
+    base_file_ptr get_block_file(offset_type offset, size_type bytes);
+
+    //! Removes the block at offset from the open files cache, returns the
+    //! file pointer such that it can be closed outside the lock.
+    base_file_ptr invalidate_block_file(offset_type offset);
+
 public:
     //! Constructs file object.
     //! param filename_prefix_  filename prefix, numbering will be appended to it
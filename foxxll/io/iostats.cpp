@@ -33,118 +33,114 @@ namespace foxxll {
 // file_stats
 
 file_stats::file_stats(unsigned int device_id)
-    : device_id_(device_id),
-      read_count_(0), write_count_(0),
-      read_bytes_(0), write_bytes_(0),
-      read_time_(0.0), write_time_(0.0),
-      p_begin_read_(0.0), p_begin_write_(0.0),
-      acc_reads_(0), acc_writes_(0)
+    : device_id_(device_id)
 { }
 
-void file_stats::write_started(const size_t size, double now)
+ticks_type file_stats::write_started(const size_t size, ticks_type now)
 {
-    if (now == 0.0)
-        now = timestamp();
-
-    {
-        std::unique_lock<std::mutex> write_lock(write_mutex_);
-
-        ++write_count_;
-        write_bytes_ += size;
-        const double diff = now - p_begin_write_;
-        write_time_ += (acc_writes_++) * diff;
-        p_begin_write_ = now;
-    }
+    write_count_.fetch_add(1, std::memory_order_relaxed);
+    write_bytes_.fetch_add(size, std::memory_order_relaxed);
 
+    // reuse the timestamp of an opened busy period as start
     stats::get_instance()->p_write_started(now);
+    busy_.started(now);
+    if (now == 0)
+        now = timestamp_ticks();
+    return now;
 }
 
-void file_stats::write_canceled(const size_t size)
+void file_stats::write_canceled(const size_t size, ticks_type start)
 {
-    {
-        std::unique_lock<std::mutex> write_lock(write_mutex_);
+    write_count_.fetch_sub(1, std::memory_order_relaxed);
+    write_bytes_.fetch_sub(size, std::memory_order_relaxed);
 
-        --write_count_;
-        write_bytes_ -= size;
-    }
-    write_finished();
+    write_done(start);
 }
 
-void file_stats::write_finished()
+void file_stats::write_finished(ticks_type start)
 {
-    double now = timestamp();
-
-    {
-        std::unique_lock<std::mutex> write_lock(write_mutex_);
-
-        const double diff = now - p_begin_write_;
-        write_time_ += (acc_writes_--) * diff;
-        p_begin_write_ = now;
-    }
-
-    stats::get_instance()->p_write_finished(now);
+    write_latency_.add(ticks_to_seconds(write_done(start)));
 }
 
-void file_stats::write_op_finished(const size_t size, double duration)
+ticks_type file_stats::write_done(ticks_type start)
 {
-    std::unique_lock<std::mutex> write_lock(write_mutex_);
+    // the device's busy period is contained in the global one, and the
+    // timestamp closing either is reused as end
+    ticks_type now = 0;
+    busy_.finished(now);
+    stats::get_instance()->p_write_finished(now);
+    if (now == 0)
+        now = timestamp_ticks();
 
-    ++write_count_;
-    write_time_ += duration;
-    write_bytes_ += size;
+    write_time_.fetch_add(now - start, std::memory_order_relaxed);
+    return now - start;
 }
 
-void file_stats::read_started(const size_t size, double now)
+void file_stats::write_op_finished(const size_t size, ticks_type duration)
 {
-    if (now == 0.0)
-        now = timestamp();
-
-    {
-        std::unique_lock<std::mutex> read_lock(read_mutex_);
+    write_count_.fetch_add(1, std::memory_order_relaxed);
+    write_bytes_.fetch_add(size, std::memory_order_relaxed);
+    write_time_.fetch_add(duration, std::memory_order_relaxed);
+    write_latency_.add(ticks_to_seconds(duration));
+}
 
-        ++read_count_;
-        read_bytes_ += size;
-        const double diff = now - p_begin_read_;
-        read_time_ += (acc_reads_++) * diff;
-        p_begin_read_ = now;
-    }
+ticks_type file_stats::read_started(const size_t size, ticks_type now)
+{
+    read_count_.fetch_add(1, std::memory_order_relaxed);
+    read_bytes_.fetch_add(size, std::memory_order_relaxed);
 
+    // reuse the timestamp of an opened busy period as start
     stats::get_instance()->p_read_started(now);
+    busy_.started(now);
+    if (now == 0)
+        now = timestamp_ticks();
+    return now;
 }
 
-void file_stats::read_canceled(const size_t size)
+void file_stats::read_canceled(const size_t size, ticks_type start)
 {
-    {
-        std::unique_lock<std::mutex> read_lock(read_mutex_);
+    read_count_.fetch_sub(1, std::memory_order_relaxed);
+    read_bytes_.fetch_sub(size, std::memory_order_relaxed);
 
-        --read_count_;
-        read_bytes_ -= size;
-    }
-    read_finished();
+    read_done(start);
 }
 
-void file_stats::read_finished()
+void file_stats::read_finished(ticks_type start)
 {
-    double now = timestamp();
+    read_latency_.add(ticks_to_seconds(read_done(start)));
+}
 
-    {
-        std::unique_lock<std::mutex> read_lock(read_mutex_);
+ticks_type file_stats::read_done(ticks_type start)
+{
+    // the device's busy period is contained in the global one, and the
+    // timestamp closing either is reused as end
+    ticks_type now = 0;
+    busy_.finished(now);
+    stats::get_instance()->p_read_finished(now);
+    if (now == 0)
+        now = timestamp_ticks();
 
-        const double diff = now - p_begin_read_;
-        read_time_ += (acc_reads_--) * diff;
-        p_begin_read_ = now;
-    }
+    read_time_.fetch_add(now - start, std::memory_order_relaxed);
+    return now - start;
+}
 
-    stats::get_instance()->p_read_finished(now);
+void file_stats::read_op_finished(const size_t size, ticks_type duration)
+{
+    read_count_.fetch_add(1, std::memory_order_relaxed);
+    read_bytes_.fetch_add(size, std::memory_order_relaxed);
+    read_time_.fetch_add(duration, std::memory_order_relaxed);
+    read_latency_.add(ticks_to_seconds(duration));
 }
 
-void file_stats::read_op_finished(const size_t size, double duration)
+void file_stats::op_posted(ticks_type& now)
 {
-    std::unique_lock<std::mutex> write_lock(read_mutex_);
+    busy_.started(now);
+}
 
-    ++read_count_;
-    read_time_ += duration;
-    read_bytes_ += size;
+void file_stats::op_completed()
+{
+    ticks_type now = 0;
+    busy_.finished(now);
 }
 
 /******************************************************************************/
@@ -166,6 +162,9 @@ file_stats_data file_stats_data::operator + (const file_stats_data& a) const
     fsd.write_bytes_ = write_bytes_ + a.write_bytes_;
     fsd.read_time_ = read_time_ + a.read_time_;
     fsd.write_time_ = write_time_ + a.write_time_;
+    fsd.busy_time_ = busy_time_ + a.busy_time_;
+    fsd.read_latency_ = read_latency_ + a.read_latency_;
+    fsd.write_latency_ = write_latency_ + a.write_latency_;
 
     return fsd;
 }
@@ -186,166 +185,126 @@ file_stats_data file_stats_data::operator - (const file_stats_data& a) const
     fsd.write_bytes_ = write_bytes_ - a.write_bytes_;
     fsd.read_time_ = read_time_ - a.read_time_;
     fsd.write_time_ = write_time_ - a.write_time_;
+    fsd.busy_time_ = busy_time_ - a.busy_time_;
+    fsd.read_latency_ = read_latency_ - a.read_latency_;
+    fsd.write_latency_ = write_latency_ - a.write_latency_;
 
     return fsd;
 }
 
 /******************************************************************************/
-// stats
-
-stats::stats()
-    : creation_time_(timestamp()),
-      p_reads_(0.0), p_writes_(0.0),
-      p_begin_read_(0.0), p_begin_write_(0.0),
-      p_ios_(0.0),
-      p_begin_io_(0.0),
-
-      acc_reads_(0.0), acc_writes_(0.0),
-      acc_ios_(0.0),
-
-      t_waits_(0.0), p_waits_(0.0),
-      p_begin_wait_(0.0),
-      t_wait_read_(0.0), p_wait_read_(0.0),
-      p_begin_wait_read_(0.0),
-      t_wait_write_(0.0), p_wait_write_(0.0),
-      p_begin_wait_write_(0.0),
-      acc_waits_(0.0),
-      acc_wait_read_(0.0), acc_wait_write_(0.0)
-{ }
+// tag_stats_data
 
-#ifndef FOXXLL_DO_NOT_COUNT_WAIT_TIME
-void stats::wait_started(wait_op_type wait_op)
+tag_stats_data tag_stats_data::operator + (const tag_stats_data& a) const
 {
-    const double now = timestamp();
-    {
-        std::unique_lock<std::mutex> wait_lock(wait_mutex_);
-
-        double diff = now - p_begin_wait_;
-        t_waits_ += acc_waits_ * diff;
-        p_begin_wait_ = now;
-        p_waits_ += (acc_waits_++) ? diff : 0.0;
-
-        if (wait_op == WAIT_OP_READ) {
-            diff = now - p_begin_wait_read_;
-            t_wait_read_ += acc_wait_read_ * diff;
-            p_begin_wait_read_ = now;
-            p_wait_read_ += (acc_wait_read_++) ? diff : 0.0;
-        }
-        else /* if (wait_op == WAIT_OP_WRITE) */ {
-            // wait_any() is only used from write_pool and buffered_writer, so account WAIT_OP_ANY for WAIT_OP_WRITE, too
-            diff = now - p_begin_wait_write_;
-            t_wait_write_ += acc_wait_write_ * diff;
-            p_begin_wait_write_ = now;
-            p_wait_write_ += (acc_wait_write_++) ? diff : 0.0;
-        }
-    }
+    FOXXLL_THROW_IF(
+        tag_ != a.tag_, std::runtime_error,
+        "foxxll::tag_stats_data objects do not belong to the same tag"
+    );
+
+    tag_stats_data tsd = *this;
+    tsd.read_count_ += a.read_count_;
+    tsd.write_count_ += a.write_count_;
+    tsd.read_bytes_ += a.read_bytes_;
+    tsd.write_bytes_ += a.write_bytes_;
+    tsd.read_time_ += a.read_time_;
+    tsd.write_time_ += a.write_time_;
+    tsd.wait_read_time_ += a.wait_read_time_;
+    tsd.wait_write_time_ += a.wait_write_time_;
+    return tsd;
 }
 
-void stats::wait_finished(const wait_op_type wait_op)
+tag_stats_data tag_stats_data::operator - (const tag_stats_data& a) const
 {
-    const double now = timestamp();
-    {
-        std::unique_lock<std::mutex> wait_lock(wait_mutex_);
-
-        double diff = now - p_begin_wait_;
-        t_waits_ += acc_waits_ * diff;
-        p_begin_wait_ = now;
-        p_waits_ += (acc_waits_--) ? diff : 0.0;
-
-        if (wait_op == WAIT_OP_READ) {
-            double diff2 = now - p_begin_wait_read_;
-            t_wait_read_ += acc_wait_read_ * diff2;
-            p_begin_wait_read_ = now;
-            p_wait_read_ += (acc_wait_read_--) ? diff2 : 0.0;
-        }
-        else /* if (wait_op == WAIT_OP_WRITE) */ {
-            double diff2 = now - p_begin_wait_write_;
-            t_wait_write_ += acc_wait_write_ * diff2;
-            p_begin_wait_write_ = now;
-            p_wait_write_ += (acc_wait_write_--) ? diff2 : 0.0;
-        }
-#ifdef FOXXLL_WAIT_LOG_ENABLED
-        if (waitlog)
-            TLX_LOG1
-                << (now - last_reset) << "\t"
-                << ((wait_op == WAIT_OP_READ) ? diff : 0.0) << "\t"
-                << ((wait_op != WAIT_OP_READ) ? diff : 0.0) << "\t"
-                << t_wait_read_ << "\t" << t_wait_write_ << "\n" << line_prefix << std::flush;
-#endif
-    }
+    FOXXLL_THROW_IF(
+        tag_ != a.tag_, std::runtime_error,
+        "foxxll::tag_stats_data objects do not belong to the same tag"
+    );
+
+    tag_stats_data tsd = *this;
+    tsd.read_count_ -= a.read_count_;
+    tsd.write_count_ -= a.write_count_;
+    tsd.read_bytes_ -= a.read_bytes_;
+    tsd.write_bytes_ -= a.write_bytes_;
+    tsd.read_time_ -= a.read_time_;
+    tsd.write_time_ -= a.write_time_;
+    tsd.wait_read_time_ -= a.wait_read_time_;
+    tsd.wait_write_time_ -= a.wait_write_time_;
+    return tsd;
 }
-#endif
 
-void stats::p_write_started(const double now)
-{
-    {
-        std::unique_lock<std::mutex> write_lock(write_mutex_);
+/******************************************************************************/
+// scoped_io_tag
 
-        const double diff = now - p_begin_write_;
-        p_begin_write_ = now;
-        p_writes_ += (acc_writes_++) ? diff : 0.0;
-    }
-    {
-        std::unique_lock<std::mutex> io_lock(io_mutex_);
+thread_local io_tag_type scoped_io_tag::current_ = 0;
 
-        const double diff = now - p_begin_io_;
-        p_ios_ += (acc_ios_++) ? diff : 0.0;
-        p_begin_io_ = now;
-    }
-}
+/******************************************************************************/
+// stats
 
-void stats::p_write_finished(const double now)
-{
-    {
-        std::unique_lock<std::mutex> write_lock(write_mutex_);
+constexpr size_t stats::max_io_tags;
 
-        const double diff = now - p_begin_write_;
-        p_begin_write_ = now;
-        p_writes_ += (acc_writes_--) ? diff : 0.0;
-    }
-    {
-        std::unique_lock<std::mutex> io_lock(io_mutex_);
+stats::stats()
+    : creation_time_(timestamp())
+{
+    tag_names_[0] = "untagged";
+}
 
-        const double diff = now - p_begin_io_;
-        p_ios_ += (acc_ios_--) ? diff : 0.0;
-        p_begin_io_ = now;
-    }
+#ifndef FOXXLL_DO_NOT_COUNT_WAIT_TIME
+ticks_type stats::wait_started(wait_op_type)
+{
+    return timestamp_ticks();
 }
 
-void stats::p_read_started(const double now)
+void stats::wait_finished(
+    const wait_op_type wait_op, ticks_type start, io_tag_type tag)
 {
-    {
-        std::unique_lock<std::mutex> read_lock(read_mutex_);
+    const ticks_type duration = timestamp_ticks() - start;
 
-        const double diff = now - p_begin_read_;
-        p_begin_read_ = now;
-        p_reads_ += (acc_reads_++) ? diff : 0.0;
-    }
-    {
-        std::unique_lock<std::mutex> io_lock(io_mutex_);
+    t_waits_.fetch_add(duration, std::memory_order_relaxed);
+
+    // wait_any() is only used from write_pool and buffered_writer, so
+    // account WAIT_OP_ANY for WAIT_OP_WRITE, too
+    if (wait_op == WAIT_OP_READ)
+        t_wait_read_.fetch_add(duration, std::memory_order_relaxed);
+    else
+        t_wait_write_.fetch_add(duration, std::memory_order_relaxed);
 
-        const double diff = now - p_begin_io_;
-        p_ios_ += (acc_ios_++) ? diff : 0.0;
-        p_begin_io_ = now;
+    if (tag != 0) {
+        if (wait_op == WAIT_OP_READ)
+            get_tag_stats(tag)->wait_read_finished(duration);
+        else
+            get_tag_stats(tag)->wait_write_finished(duration);
     }
 }
+#endif
+
+// the parallel I/O time is started first and finished last, such that it
+// contains the parallel read and write times.
 
-void stats::p_read_finished(const double now)
+void stats::p_write_started(ticks_type& now)
 {
-    {
-        std::unique_lock<std::mutex> read_lock(read_mutex_);
+    p_ios_.started(now);
+    p_writes_.started(now);
+}
 
-        const double diff = now - p_begin_read_;
-        p_begin_read_ = now;
-        p_reads_ += (acc_reads_--) ? diff : 0.0;
-    }
-    {
-        std::unique_lock<std::mutex> io_lock(io_mutex_);
+void stats::p_write_finished(ticks_type& now)
+{
+    ticks_type end = 0;
+    p_writes_.finished(now);
+    p_ios_.finished(end);
+}
 
-        const double diff = now - p_begin_io_;
-        p_ios_ += (acc_ios_--) ? diff : 0.0;
-        p_begin_io_ = now;
-    }
+void stats::p_read_started(ticks_type& now)
+{
+    p_ios_.started(now);
+    p_reads_.started(now);
+}
+
+void stats::p_read_finished(ticks_type& now)
+{
+    ticks_type end = 0;
+    p_reads_.finished(now);
+    p_ios_.finished(end);
 }
 
 file_stats* stats::create_file_stats(unsigned int device_id)
@@ -357,11 +316,10 @@ file_stats* stats::create_file_stats(unsigned int device_id)
                 return fs.get_device_id() < id;
             }
         );
-    if (it != file_stats_list_.end() && it->get_device_id())
+    if (it != file_stats_list_.end() && it->get_device_id() == device_id)
         return &*it;
 
-    file_stats_list_.emplace(it, /* construction: */ device_id);
-    return &file_stats_list_.back();
+    return &*file_stats_list_.emplace(it, /* construction: */ device_id);
 }
 
 std::vector<file_stats_data> stats::deepcopy_file_stats_data_list() const
@@ -372,6 +330,41 @@ std::vector<file_stats_data> stats::deepcopy_file_stats_data_list() const
     };
 }
 
+io_tag_type stats::get_io_tag(const std::string& name)
+{
+    std::unique_lock<std::mutex> lock(tag_mutex_);
+
+    const size_t num_tags = num_io_tags_.load(std::memory_order_relaxed);
+    for (size_t t = 1; t < num_tags; ++t) {
+        if (tag_names_[t] == name)
+            return static_cast<io_tag_type>(t);
+    }
+
+    if (num_tags == max_io_tags) {
+        FOXXLL_THROW(bad_parameter,
+                     "Cannot register I/O tag '" << name << "', all "
+                                                 << max_io_tags - 1 << " tags are in use.");
+    }
+
+    tag_names_[num_tags] = name;
+    // publish the name together with the tag
+    num_io_tags_.store(num_tags + 1, std::memory_order_release);
+    return static_cast<io_tag_type>(num_tags);
+}
+
+std::vector<tag_stats_data> stats::deepcopy_tag_stats_data_list() const
+{
+    const size_t num_tags = num_io_tags_.load(std::memory_order_acquire);
+
+    std::vector<tag_stats_data> list;
+    list.reserve(num_tags - 1);
+    for (size_t t = 1; t < num_tags; ++t) {
+        list.emplace_back(
+            static_cast<io_tag_type>(t), tag_names_[t], tag_stats_[t]);
+    }
+    return list;
+}
+
 std::ostream& operator << (std::ostream& o, const stats& s)
 {
     o << stats_data(s);
@@ -441,6 +434,14 @@ struct FileStatsDataCompare {
     }
 };
 
+struct TagStatsDataCompare {
+    long long operator () (const tag_stats_data& a, const tag_stats_data& b) const
+    {
+        return static_cast<long long>(a.get_tag())
+               - static_cast<long long>(b.get_tag());
+    }
+};
+
 stats_data stats_data::operator + (const stats_data& a) const
 {
     stats_data s;
@@ -455,6 +456,16 @@ stats_data stats_data::operator + (const stats_data& a) const
         }
     );
 
+    tlx::merge_combine(
+        tag_stats_data_list_.cbegin(), tag_stats_data_list_.cend(),
+        a.tag_stats_data_list_.cbegin(), a.tag_stats_data_list_.cend(),
+        std::back_inserter(s.tag_stats_data_list_),
+        TagStatsDataCompare(),
+        [](const tag_stats_data& a, const tag_stats_data& b) {
+            return a + b;
+        }
+    );
+
     s.p_reads_ = p_reads_ + a.p_reads_;
     s.p_writes_ = p_writes_ + a.p_writes_;
     s.p_ios_ = p_ios_ + a.p_ios_;
@@ -479,6 +490,16 @@ stats_data stats_data::operator - (const stats_data& a) const
         }
     );
 
+    tlx::merge_combine(
+        tag_stats_data_list_.cbegin(), tag_stats_data_list_.cend(),
+        a.tag_stats_data_list_.cbegin(), a.tag_stats_data_list_.cend(),
+        std::back_inserter(s.tag_stats_data_list_),
+        TagStatsDataCompare(),
+        [](const tag_stats_data& a, const tag_stats_data& b) {
+            return a - b;
+        }
+    );
+
     s.p_reads_ = p_reads_ - a.p_reads_;
     s.p_writes_ = p_writes_ - a.p_writes_;
     s.p_ios_ = p_ios_ - a.p_ios_;
@@ -494,6 +515,15 @@ size_t stats_data::num_files() const
     return file_stats_data_list_.size();
 }
 
+tag_stats_data stats_data::get_tag_stats_data(io_tag_type tag) const
+{
+    for (const tag_stats_data& tsd : tag_stats_data_list_) {
+        if (tsd.get_tag() == tag)
+            return tsd;
+    }
+    return tag_stats_data();
+}
+
 unsigned stats_data::get_read_count() const
 {
     return fetch_sum<unsigned>(
@@ -646,6 +676,76 @@ stats_data::summary<double> stats_data::get_pio_speed_summary() const
     };
 }
 
+stats_data::summary<double> stats_data::get_busy_time_summary() const
+{
+    return {
+               file_stats_data_list_, [](const file_stats_data& fsd) {
+                   return fsd.get_busy_time();
+               }
+    };
+}
+
+stats_data::summary<double> stats_data::get_utilization_summary() const
+{
+    return {
+               file_stats_data_list_, [this](const file_stats_data& fsd) {
+                   return elapsed_ > 0.0 ? fsd.get_busy_time() / elapsed_ : 0.0;
+               }
+    };
+}
+
+std::vector<unsigned> stats_data::get_saturated_devices(
+    double saturated, double idle) const
+{
+    const auto utilization = get_utilization_summary();
+
+    std::vector<unsigned> devices;
+    if (utilization.values_per_device.size() < 2 || utilization.min >= idle)
+        return devices;
+
+    for (const auto& u : utilization.values_per_device) {
+        if (u.first >= saturated)
+            devices.push_back(u.second);
+    }
+    return devices;
+}
+
+latency_histogram_data stats_data::get_read_latency() const
+{
+    latency_histogram_data h;
+    for (const file_stats_data& fsd : file_stats_data_list_)
+        h = h + fsd.get_read_latency();
+    return h;
+}
+
+latency_histogram_data stats_data::get_write_latency() const
+{
+    latency_histogram_data h;
+    for (const file_stats_data& fsd : file_stats_data_list_)
+        h = h + fsd.get_write_latency();
+    return h;
+}
+
+stats_data::summary<double>
+stats_data::get_read_latency_summary(double q) const
+{
+    return {
+               file_stats_data_list_, [q](const file_stats_data& fsd) {
+                   return fsd.get_read_latency().percentile(q);
+               }
+    };
+}
+
+stats_data::summary<double>
+stats_data::get_write_latency_summary(double q) const
+{
+    return {
+               file_stats_data_list_, [q](const file_stats_data& fsd) {
+                   return fsd.get_write_latency().percentile(q);
+               }
+    };
+}
+
 double stats_data::get_io_wait_time() const
 {
     return t_wait;
@@ -661,6 +761,17 @@ double stats_data::get_wait_write_time() const
     return t_wait_write_;
 }
 
+//! print percentiles of a latency histogram in milliseconds
+static void print_latency_percentiles(
+    std::ostream& o, const latency_histogram_data& h)
+{
+    o << h.percentile(0.5) * 1e3 << " / "
+      << h.percentile(0.9) * 1e3 << " / "
+      << h.percentile(0.99) * 1e3 << " / "
+      << h.percentile(0.999) * 1e3 << " / "
+      << h.percentile(1.0) * 1e3 << " ms";
+}
+
 void stats_data::to_ostream(std::ostream& o, const std::string line_prefix) const
 {
     constexpr double one_mib = 1024.0 * 1024;
@@ -709,6 +820,21 @@ void stats_data::to_ostream(std::ostream& o, const std::string line_prefix) cons
           << "\n" << line_prefix;
     }
 
+    const latency_histogram_data read_latency = get_read_latency();
+    if (read_latency.get_count() != 0) {
+        o << " read latency (p50/p90/p99/p99.9/max)       : ";
+        print_latency_percentiles(o, read_latency);
+        o << "\n" << line_prefix;
+    }
+    if (nf > 1 && read_latency.get_count() != 0) {
+        const auto read_p99_summary = get_read_latency_summary(0.99);
+        o << "  p99 read latency per file                 : "
+          << "min: " << read_p99_summary.min * 1e3 << " ms, "
+          << "median: " << read_p99_summary.median * 1e3 << " ms, "
+          << "max: " << read_p99_summary.max * 1e3 << " ms"
+          << "\n" << line_prefix;
+    }
+
     o << " total number of writes                     : "
       << add_IEC_binary_multiplier(get_write_count()) << "\n" << line_prefix
       << " average block size (write)                 : "
@@ -736,6 +862,21 @@ void stats_data::to_ostream(std::ostream& o, const std::string line_prefix) cons
           << "\n" << line_prefix;
     }
 
+    const latency_histogram_data write_latency = get_write_latency();
+    if (write_latency.get_count() != 0) {
+        o << " write latency (p50/p90/p99/p99.9/max)      : ";
+        print_latency_percentiles(o, write_latency);
+        o << "\n" << line_prefix;
+    }
+    if (nf > 1 && write_latency.get_count() != 0) {
+        const auto write_p99_summary = get_write_latency_summary(0.99);
+        o << "   p99 write latency per file               : "
+          << "min: " << write_p99_summary.min * 1e3 << " ms, "
+          << "median: " << write_p99_summary.median * 1e3 << " ms, "
+          << "max: " << write_p99_summary.max * 1e3 << " ms"
+          << "\n" << line_prefix;
+    }
+
     o << " time spent in I/O (parallel I/O time)      : " << get_pio_time() << " s"
       << " @ " << (static_cast<double>((get_read_bytes()) + get_write_bytes()) / one_mib / get_pio_time()) << " MiB/s"
       << "\n" << line_prefix;
@@ -746,6 +887,19 @@ void stats_data::to_ostream(std::ostream& o, const std::string line_prefix) cons
           << "max: " << pio_speed_summary.max / one_mib << " MiB/s"
           << "\n" << line_prefix;
     }
+    const auto utilization_summary = get_utilization_summary();
+    if (nf != 0) {
+        o << " device utilization (busy time / elapsed)   : ";
+        if (nf > 1) {
+            o << "min: " << utilization_summary.min * 100.0 << " %, "
+              << "median: " << utilization_summary.median * 100.0 << " %, "
+              << "max: " << utilization_summary.max * 100.0 << " %";
+        }
+        else {
+            o << utilization_summary.max * 100.0 << " %";
+        }
+        o << "\n" << line_prefix;
+    }
 #ifndef FOXXLL_DO_NOT_COUNT_WAIT_TIME
     o << " I/O wait time                              : "
       << get_io_wait_time() << " s\n" << line_prefix;
@@ -756,6 +910,24 @@ void stats_data::to_ostream(std::ostream& o, const std::string line_prefix) cons
         o << " I/O wait4write time                        : "
           << get_wait_write_time() << " s\n" << line_prefix;
 #endif
+    for (const tag_stats_data& tsd : tag_stats_data_list_)
+    {
+        if (tsd.get_read_count() == 0 && tsd.get_write_count() == 0 &&
+            tsd.get_wait_read_time() == 0.0 && tsd.get_wait_write_time() == 0.0)
+            continue;
+
+        o << " I/O tag " << tsd.get_name() << "\n" << line_prefix
+          << "  read                                      : "
+          << add_IEC_binary_multiplier(tsd.get_read_bytes(), "B")
+          << " in " << tsd.get_read_count() << " requests, "
+          << tsd.get_read_time() << " s, waited "
+          << tsd.get_wait_read_time() << " s\n" << line_prefix
+          << "  written                                   : "
+          << add_IEC_binary_multiplier(tsd.get_write_bytes(), "B")
+          << " in " << tsd.get_write_count() << " requests, "
+          << tsd.get_write_time() << " s, waited "
+          << tsd.get_wait_write_time() << " s\n" << line_prefix;
+    }
     o << " Time since the last reset                  : "
       << get_elapsed_time() << " s";
 
@@ -784,6 +956,26 @@ void stats_data::to_ostream(std::ostream& o, const std::string line_prefix) cons
         }
     }
 
+    const std::vector<unsigned> saturated = get_saturated_devices();
+    if (!saturated.empty())
+    {
+        o << "\n" << line_prefix
+          << "WARNING: Saturated disk(s) detected while others idle.\n" << line_prefix
+          << " Saturated: ";
+        for (size_t i = 0; i < saturated.size(); ++i)
+        {
+            for (const auto& u : utilization_summary.values_per_device)
+            {
+                if (u.second == saturated[i])
+                    o << (i ? ", " : "") << u.second << "@ " << u.first * 100.0 << " %";
+            }
+        }
+        o << "\n" << line_prefix
+          << " Least utilized: "
+          << utilization_summary.values_per_device.front().second
+          << "@ " << utilization_summary.values_per_device.front().first * 100.0 << " %";
+    }
+
     if (static_cast<double>(read_bytes_summary.min) / read_bytes_summary.max < 0.5 ||
         static_cast<double>(write_bytes_summary.min) / write_bytes_summary.max < 0.5)
     {
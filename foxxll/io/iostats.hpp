@@ -18,11 +18,16 @@
 #define FOXXLL_IO_IOSTATS_HEADER
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <limits>
 #include <list>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -34,6 +39,7 @@
 #include <foxxll/common/timer.hpp>
 #include <foxxll/common/types.hpp>
 #include <foxxll/common/utils.hpp>
+#include <foxxll/io/latency_histogram.hpp>
 #include <foxxll/singleton.hpp>
 
 namespace foxxll {
@@ -42,24 +48,117 @@ namespace foxxll {
 //!
 //! \{
 
+/*!
+ * Accumulates the time during which at least one of many concurrent
+ * operations is running, without a lock.
+ *
+ * The number of running operations is an atomic counter, incremented with
+ * compare-and-swap. Only the operation starting a busy period (0 to 1) and
+ * the one ending it (1 to 0) take a timestamp. They briefly mark the counter
+ * as -1 meanwhile, so that other operations wait only at these transitions
+ * and never while the device is busy. Taking the timestamps there keeps the
+ * periods ordered, hence the periods of a counter which is started after and
+ * finished before another one are contained in the other's.
+ */
+class parallel_time
+{
+    //! number of running operations, -1 while a busy period opens or closes
+    std::atomic<int> active_ { 0 };
+    //! begin of the current busy period, guarded by active_ == -1
+    ticks_type begin_ = 0;
+    //! ticks of the finished busy periods
+    std::atomic<ticks_type> total_ { 0 };
+
+public:
+    //! Counts a started operation. If it opens a busy period, its begin is
+    //! now, taking a timestamp if now is still zero.
+    void started(ticks_type& now)
+    {
+        int active = active_.load(std::memory_order_relaxed);
+        for ( ; ; )
+        {
+            if (active < 0) {
+                std::this_thread::yield();
+                active = active_.load(std::memory_order_relaxed);
+            }
+            else if (active == 0) {
+                if (active_.compare_exchange_weak(
+                        active, -1, std::memory_order_acquire)) {
+                    if (now == 0)
+                        now = timestamp_ticks();
+                    begin_ = now;
+                    active_.store(1, std::memory_order_release);
+                    return;
+                }
+            }
+            else if (active_.compare_exchange_weak(
+                         active, active + 1, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    //! Counts a finished operation. If it closes a busy period, now is set to
+    //! a fresh timestamp as its end.
+    void finished(ticks_type& now)
+    {
+        int active = active_.load(std::memory_order_relaxed);
+        for ( ; ; )
+        {
+            assert(active != 0);
+            if (active < 0) {
+                std::this_thread::yield();
+                active = active_.load(std::memory_order_relaxed);
+            }
+            else if (active == 1) {
+                if (active_.compare_exchange_weak(
+                        active, -1, std::memory_order_acquire)) {
+                    now = timestamp_ticks();
+                    total_.fetch_add(now - begin_, std::memory_order_relaxed);
+                    active_.store(0, std::memory_order_release);
+                    return;
+                }
+            }
+            else if (active_.compare_exchange_weak(
+                         active, active - 1, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    //! seconds of the finished busy periods
+    double total() const
+    {
+        return ticks_to_seconds(total_.load(std::memory_order_relaxed));
+    }
+};
+
+/*!
+ * I/O statistics of one file.
+ *
+ * All counters are atomic, such that the I/O threads of many files update
+ * them without locks. The time of an operation is added in ticks of
+ * timestamp_ticks() when it finishes.
+ */
 class file_stats
 {
     //! associated device id
     const unsigned device_id_;
 
     //! number of operations: read/write
-    unsigned read_count_, write_count_;
+    std::atomic<unsigned> read_count_ { 0 }, write_count_ { 0 };
     //! number of bytes read/written
-    external_size_type read_bytes_, write_bytes_;
-    //! seconds spent in operations
-    double read_time_, write_time_;
-    //! start time of parallel operation
-    double p_begin_read_, p_begin_write_;
-
-    //! number of requests, participating in parallel operation
-    int acc_reads_, acc_writes_;
-
-    std::mutex read_mutex_, write_mutex_;
+    std::atomic<external_size_type> read_bytes_ { 0 }, write_bytes_ { 0 };
+    //! ticks spent in operations
+    std::atomic<ticks_type> read_time_ { 0 }, write_time_ { 0 };
+    //! distribution of the latencies of operations
+    latency_histogram read_latency_, write_latency_;
+    //! seconds during which any operation on the device was running
+    parallel_time busy_;
+
+    //! stops timing a started operation and returns its duration
+    ticks_type write_done(ticks_type start);
+    ticks_type read_done(ticks_type start);
 
 public:
     //! construct zero initialized
@@ -72,6 +171,7 @@ public:
 
         bool is_write_;
         bool running_ = false;
+        ticks_type start_ = 0;
 
     public:
         explicit scoped_read_write_timer(
@@ -91,9 +191,9 @@ public:
             if (!running_) {
                 running_ = true;
                 if (is_write_)
-                    file_stats_.write_started(size);
+                    start_ = file_stats_.write_started(size);
                 else
-                    file_stats_.read_started(size);
+                    start_ = file_stats_.read_started(size);
             }
         }
 
@@ -101,9 +201,9 @@ public:
         {
             if (running_) {
                 if (is_write_)
-                    file_stats_.write_finished();
+                    file_stats_.write_finished(start_);
                 else
-                    file_stats_.read_finished();
+                    file_stats_.read_finished(start_);
                 running_ = false;
             }
         }
@@ -115,6 +215,7 @@ public:
         file_stats& file_stats_;
 
         bool running_ = false;
+        ticks_type start_ = 0;
 
     public:
         explicit scoped_write_timer(file_stats* file_stats, size_type size)
@@ -132,14 +233,14 @@ public:
         {
             if (!running_) {
                 running_ = true;
-                file_stats_.write_started(size);
+                start_ = file_stats_.write_started(size);
             }
         }
 
         void stop()
         {
             if (running_) {
-                file_stats_.write_finished();
+                file_stats_.write_finished(start_);
                 running_ = false;
             }
         }
@@ -151,6 +252,7 @@ public:
         file_stats& file_stats_;
 
         bool running_ = false;
+        ticks_type start_ = 0;
 
     public:
         explicit scoped_read_timer(file_stats* file_stats, size_type size)
@@ -168,14 +270,14 @@ public:
         {
             if (!running_) {
                 running_ = true;
-                file_stats_.read_started(size);
+                start_ = file_stats_.read_started(size);
             }
         }
 
         void stop()
         {
             if (running_) {
-                file_stats_.read_finished();
+                file_stats_.read_finished(start_);
                 running_ = false;
             }
         }
@@ -193,28 +295,28 @@ public:
     //! \return total number of read_count_
     unsigned get_read_count() const
     {
-        return read_count_;
+        return read_count_.load(std::memory_order_relaxed);
     }
 
     //! Returns total number of write_count_.
     //! \return total number of write_count_
     unsigned get_write_count() const
     {
-        return write_count_;
+        return write_count_.load(std::memory_order_relaxed);
     }
 
     //! Returns number of bytes read from disks.
     //! \return number of bytes read
     external_size_type get_read_bytes() const
     {
-        return read_bytes_;
+        return read_bytes_.load(std::memory_order_relaxed);
     }
 
     //! Returns number of bytes written to the disks.
     //! \return number of bytes written
     external_size_type get_write_bytes() const
     {
-        return write_bytes_;
+        return write_bytes_.load(std::memory_order_relaxed);
     }
 
     //! Time that would be spent in read syscalls if all parallel read_count_
@@ -222,7 +324,7 @@ public:
     //! \return seconds spent in reading
     double get_read_time() const
     {
-        return read_time_;
+        return ticks_to_seconds(read_time_.load(std::memory_order_relaxed));
     }
 
     //! Time that would be spent in write syscalls if all parallel write_count_
@@ -230,19 +332,54 @@ public:
     //! \return seconds spent in writing
     double get_write_time() const
     {
-        return write_time_;
+        return ticks_to_seconds(write_time_.load(std::memory_order_relaxed));
+    }
+
+    //! Distribution of the latencies of finished reads.
+    const latency_histogram & get_read_latency() const
+    {
+        return read_latency_;
+    }
+
+    //! Distribution of the latencies of finished writes.
+    const latency_histogram & get_write_latency() const
+    {
+        return write_latency_;
+    }
+
+    //! Period of time when at least one operation was running on the
+    //! device, i.e. the time the device was busy.
+    //! \return seconds spent busy
+    double get_busy_time() const
+    {
+        return busy_.total();
     }
 
     // for library use
-    void write_started(const size_t size_, double now = 0.0);
-    void write_canceled(const size_t size_);
-    void write_finished();
-    void write_op_finished(const size_t size_, double duration);
-
-    void read_started(const size_t size_, double now = 0.0);
-    void read_canceled(const size_t size_);
-    void read_finished();
-    void read_op_finished(const size_t size_, double duration);
+
+    //! counts a write and returns its start time in ticks, now if given
+    ticks_type write_started(const size_t size_, ticks_type now = 0);
+    //! undoes the counting of a started write
+    void write_canceled(const size_t size_, ticks_type start);
+    //! adds the time of a write started at start
+    void write_finished(ticks_type start);
+    //! counts a write which took duration ticks
+    void write_op_finished(const size_t size_, ticks_type duration);
+
+    //! counts a read and returns its start time in ticks, now if given
+    ticks_type read_started(const size_t size_, ticks_type now = 0);
+    //! undoes the counting of a started read
+    void read_canceled(const size_t size_, ticks_type start);
+    //! adds the time of a read started at start
+    void read_finished(ticks_type start);
+    //! counts a read which took duration ticks
+    void read_op_finished(const size_t size_, ticks_type duration);
+
+    //! marks the device busy for an operation timed by read/write_op_finished
+    //! (e.g. posted to the kernel), starting now, taking a timestamp if zero
+    void op_posted(ticks_type& now);
+    //! ends the busy time of an operation marked by op_posted
+    void op_completed();
 };
 
 class file_stats_data
@@ -255,13 +392,18 @@ class file_stats_data
     external_size_type read_bytes_, write_bytes_;
     //! seconds spent in operations
     double read_time_, write_time_;
+    //! seconds the device was busy
+    double busy_time_;
+    //! distribution of the latencies of operations
+    latency_histogram_data read_latency_, write_latency_;
 
 public:
     file_stats_data()
         : device_id_(std::numeric_limits<unsigned>::max()),
           read_count_(0), write_count_(0),
           read_bytes_(0), write_bytes_(0),
-          read_time_(0.0), write_time_(0.0)
+          read_time_(0.0), write_time_(0.0),
+          busy_time_(0.0)
     { }
 
     //! construct file_stats_data by taking current values from file_stats
@@ -272,7 +414,10 @@ public:
           read_bytes_(fs.get_read_bytes()),
           write_bytes_(fs.get_write_bytes()),
           read_time_(fs.get_read_time()),
-          write_time_(fs.get_write_time())
+          write_time_(fs.get_write_time()),
+          busy_time_(fs.get_busy_time()),
+          read_latency_(fs.get_read_latency()),
+          write_latency_(fs.get_write_latency())
     { }
 
     file_stats_data operator + (const file_stats_data& a) const;
@@ -312,6 +457,130 @@ public:
     {
         return write_time_;
     }
+
+    double get_busy_time() const
+    {
+        return busy_time_;
+    }
+
+    const latency_histogram_data & get_read_latency() const
+    {
+        return read_latency_;
+    }
+
+    const latency_histogram_data & get_write_latency() const
+    {
+        return write_latency_;
+    }
+};
+
+//! Tag naming the originator of I/O requests, e.g. a stage of a pipeline.
+//! Tags are obtained from stats::get_io_tag(), zero means untagged.
+using io_tag_type = uint16_t;
+
+/*!
+ * I/O statistics of the requests carrying one tag.
+ *
+ * The time of a request is its service time in the I/O layer, the wait time
+ * is the time threads waited for the request in request::wait(). Untagged
+ * requests are not counted, such that requests take timestamps for their
+ * tag only if they carry one.
+ */
+class tag_stats
+{
+    //! number of operations: read/write
+    std::atomic<unsigned> read_count_ { 0 }, write_count_ { 0 };
+    //! number of bytes read/written
+    std::atomic<external_size_type> read_bytes_ { 0 }, write_bytes_ { 0 };
+    //! ticks spent in operations
+    std::atomic<ticks_type> read_time_ { 0 }, write_time_ { 0 };
+    //! ticks threads waited for the operations
+    std::atomic<ticks_type> wait_read_time_ { 0 }, wait_write_time_ { 0 };
+
+public:
+    tag_stats() = default;
+
+    //! non-copyable: delete copy-constructor
+    tag_stats(const tag_stats&) = delete;
+    //! non-copyable: delete assignment operator
+    tag_stats& operator = (const tag_stats&) = delete;
+
+    //! counts a finished operation of size bytes which took duration ticks
+    void read_finished(size_t size, ticks_type duration)
+    {
+        read_count_.fetch_add(1, std::memory_order_relaxed);
+        read_bytes_.fetch_add(size, std::memory_order_relaxed);
+        read_time_.fetch_add(duration, std::memory_order_relaxed);
+    }
+
+    //! counts a finished operation of size bytes which took duration ticks
+    void write_finished(size_t size, ticks_type duration)
+    {
+        write_count_.fetch_add(1, std::memory_order_relaxed);
+        write_bytes_.fetch_add(size, std::memory_order_relaxed);
+        write_time_.fetch_add(duration, std::memory_order_relaxed);
+    }
+
+    //! adds the ticks a thread waited for an operation
+    void wait_read_finished(ticks_type duration)
+    {
+        wait_read_time_.fetch_add(duration, std::memory_order_relaxed);
+    }
+
+    //! adds the ticks a thread waited for an operation
+    void wait_write_finished(ticks_type duration)
+    {
+        wait_write_time_.fetch_add(duration, std::memory_order_relaxed);
+    }
+
+    unsigned get_read_count() const { return read_count_.load(std::memory_order_relaxed); }
+    unsigned get_write_count() const { return write_count_.load(std::memory_order_relaxed); }
+    external_size_type get_read_bytes() const { return read_bytes_.load(std::memory_order_relaxed); }
+    external_size_type get_write_bytes() const { return write_bytes_.load(std::memory_order_relaxed); }
+    double get_read_time() const { return ticks_to_seconds(read_time_.load(std::memory_order_relaxed)); }
+    double get_write_time() const { return ticks_to_seconds(write_time_.load(std::memory_order_relaxed)); }
+    double get_wait_read_time() const { return ticks_to_seconds(wait_read_time_.load(std::memory_order_relaxed)); }
+    double get_wait_write_time() const { return ticks_to_seconds(wait_write_time_.load(std::memory_order_relaxed)); }
+};
+
+//! Snapshot of the tag_stats of one tag.
+class tag_stats_data
+{
+    //! the tag and its name
+    io_tag_type tag_ = 0;
+    std::string name_;
+
+    unsigned read_count_ = 0, write_count_ = 0;
+    external_size_type read_bytes_ = 0, write_bytes_ = 0;
+    double read_time_ = 0.0, write_time_ = 0.0;
+    double wait_read_time_ = 0.0, wait_write_time_ = 0.0;
+
+public:
+    tag_stats_data() = default;
+
+    //! construct by taking the current values from tag_stats
+    tag_stats_data(io_tag_type tag, const std::string& name, const tag_stats& ts)
+        : tag_(tag), name_(name),
+          read_count_(ts.get_read_count()), write_count_(ts.get_write_count()),
+          read_bytes_(ts.get_read_bytes()), write_bytes_(ts.get_write_bytes()),
+          read_time_(ts.get_read_time()), write_time_(ts.get_write_time()),
+          wait_read_time_(ts.get_wait_read_time()),
+          wait_write_time_(ts.get_wait_write_time())
+    { }
+
+    tag_stats_data operator + (const tag_stats_data& a) const;
+    tag_stats_data operator - (const tag_stats_data& a) const;
+
+    io_tag_type get_tag() const { return tag_; }
+    const std::string & get_name() const { return name_; }
+    unsigned get_read_count() const { return read_count_; }
+    unsigned get_write_count() const { return write_count_; }
+    external_size_type get_read_bytes() const { return read_bytes_; }
+    external_size_type get_write_bytes() const { return write_bytes_; }
+    double get_read_time() const { return read_time_; }
+    double get_write_time() const { return write_time_; }
+    double get_wait_read_time() const { return wait_read_time_; }
+    double get_wait_write_time() const { return wait_write_time_; }
 };
 
 //! Collects various I/O statistics.
@@ -331,31 +600,31 @@ class stats : public singleton<stats>
 
     // *** parallel times have to be counted globally ***
 
-    //! seconds spent in parallel operations
-    double p_reads_, p_writes_;
-    //! start time of parallel operation
-    double p_begin_read_, p_begin_write_;
-    // seconds spent in all parallel I/O operations (read and write)
-    double p_ios_;
-    double p_begin_io_;
-
-    // number of requests, participating in parallel operation
-    int acc_reads_, acc_writes_;
-    int acc_ios_;
+    //! seconds during which any read, any write, or any I/O was running
+    parallel_time p_reads_, p_writes_, p_ios_;
 
     // *** waits are measured globally ***
 
-    // seconds spent waiting for completion of I/O operations
-    double t_waits_, p_waits_;
-    double p_begin_wait_;
-    double t_wait_read_, p_wait_read_;
-    double p_begin_wait_read_;
-    double t_wait_write_, p_wait_write_;
-    double p_begin_wait_write_;
-    int acc_waits_;
-    int acc_wait_read_, acc_wait_write_;
+    //! ticks spent waiting for completion of I/O operations, summed over
+    //! all waiting threads
+    std::atomic<ticks_type> t_waits_ { 0 };
+    std::atomic<ticks_type> t_wait_read_ { 0 }, t_wait_write_ { 0 };
 
-    std::mutex wait_mutex_, read_mutex_, write_mutex_, io_mutex_;
+public:
+    //! maximum number of I/O tags, including the untagged zero
+    static constexpr size_t max_io_tags = 256;
+
+private:
+    // *** per-tag statistics ***
+
+    //! statistics of the tags, indexed by tag
+    std::array<tag_stats, max_io_tags> tag_stats_;
+    //! names of the tags, written once before num_io_tags_ covers the tag
+    std::array<std::string, max_io_tags> tag_names_;
+    //! number of registered tags, including the untagged zero
+    std::atomic<size_t> num_io_tags_ { 1 };
+    //! serializes registering tags
+    std::mutex tag_mutex_;
 
     //! private construction from singleton
     stats();
@@ -372,12 +641,17 @@ public:
 #ifndef FOXXLL_DO_NOT_COUNT_WAIT_TIME
         bool running_ = false;
         wait_op_type wait_op_;
+        io_tag_type tag_;
+        ticks_type start_ = 0;
 #endif
 
     public:
-        explicit scoped_wait_timer(wait_op_type wait_op, bool measure_time = true)
+        //! measure a wait, which is also counted for the tag of the awaited
+        //! request if nonzero
+        explicit scoped_wait_timer(wait_op_type wait_op, bool measure_time = true,
+                                   io_tag_type tag = 0)
 #ifndef FOXXLL_DO_NOT_COUNT_WAIT_TIME
-            : wait_op_(wait_op)
+            : wait_op_(wait_op), tag_(tag)
 #endif
         {
             if (measure_time)
@@ -394,7 +668,7 @@ public:
 #ifndef FOXXLL_DO_NOT_COUNT_WAIT_TIME
             if (!running_) {
                 running_ = true;
-                stats::get_instance()->wait_started(wait_op_);
+                start_ = stats::get_instance()->wait_started(wait_op_);
             }
 #endif
         }
@@ -403,7 +677,7 @@ public:
         {
 #ifndef FOXXLL_DO_NOT_COUNT_WAIT_TIME
             if (running_) {
-                stats::get_instance()->wait_finished(wait_op_);
+                stats::get_instance()->wait_finished(wait_op_, start_, tag_);
                 running_ = false;
             }
 #endif
@@ -423,43 +697,57 @@ public:
     //! statistics. (for internal library use.)
     file_stats * create_file_stats(unsigned device_id);
 
+    //! Returns the I/O tag of the given name, registering it on first use.
+    //! Throws bad_parameter if max_io_tags - 1 names are already registered.
+    io_tag_type get_io_tag(const std::string& name);
+
+    //! statistics of the requests carrying a registered tag
+    tag_stats * get_tag_stats(io_tag_type tag)
+    {
+        assert(tag < num_io_tags_.load(std::memory_order_relaxed));
+        return &tag_stats_[tag];
+    }
+
+    //! return snapshots of the stats of all registered tags, ordered by tag
+    std::vector<tag_stats_data> deepcopy_tag_stats_data_list() const;
+
     //! I/O wait time counter.
     //! \return number of seconds spent in I/O waiting functions \link
     //! request::wait request::wait \endlink, \c wait_any and \c wait_all
     double get_io_wait_time() const
     {
-        return t_waits_;
+        return ticks_to_seconds(t_waits_.load(std::memory_order_relaxed));
     }
 
     double get_wait_read_time() const
     {
-        return t_wait_read_;
+        return ticks_to_seconds(t_wait_read_.load(std::memory_order_relaxed));
     }
 
     double get_wait_write_time() const
     {
-        return t_wait_write_;
+        return ticks_to_seconds(t_wait_write_.load(std::memory_order_relaxed));
     }
 
     //! Period of time when at least one I/O thread was executing a read.
     //! \return seconds spent in reading
     double get_pread_time() const
     {
-        return p_reads_;
+        return p_reads_.total();
     }
 
     //! Period of time when at least one I/O thread was executing a write.
     //! \return seconds spent in writing
     double get_pwrite_time() const
     {
-        return p_writes_;
+        return p_writes_.total();
     }
 
     //! Period of time when at least one I/O thread was executing a read or a write.
     //! \return seconds spent in I/O
     double get_pio_time() const
     {
-        return p_ios_;
+        return p_ios_.total();
     }
 
     friend std::ostream& operator << (std::ostream& o, const stats& s);
@@ -468,21 +756,66 @@ public:
 
 private:
     // only called from file_stats
-    void p_write_started(double now);
-    void p_write_finished(double now);
-    void p_read_started(double now);
-    void p_read_finished(double now);
+    void p_write_started(ticks_type& now);
+    void p_write_finished(ticks_type& now);
+    void p_read_started(ticks_type& now);
+    void p_read_finished(ticks_type& now);
 
 public:
-    void wait_started(wait_op_type wait_op_);
-    void wait_finished(wait_op_type wait_op_);
+    //! returns the start time of the wait in ticks
+    ticks_type wait_started(wait_op_type wait_op_);
+    //! adds the time of a wait started at start, also to tag if nonzero
+    void wait_finished(wait_op_type wait_op_, ticks_type start, io_tag_type tag = 0);
 };
 
 #ifdef FOXXLL_DO_NOT_COUNT_WAIT_TIME
-inline void stats::wait_started(wait_op_type) { }
-inline void stats::wait_finished(wait_op_type) { }
+inline ticks_type stats::wait_started(wait_op_type) { return 0; }
+inline void stats::wait_finished(wait_op_type, ticks_type, io_tag_type) { }
 #endif
 
+/*!
+ * Attributes the I/O requests created by the calling thread in its scope to
+ * an I/O tag, e.g. to the run formation of a sorter. Scopes nest, the
+ * innermost tag applies.
+ */
+class scoped_io_tag
+{
+    //! tag of the enclosing scope
+    const io_tag_type previous_;
+
+    //! tag of the calling thread
+    static thread_local io_tag_type current_;
+
+public:
+    //! attribute requests to tag
+    explicit scoped_io_tag(io_tag_type tag)
+        : previous_(current_)
+    {
+        current_ = tag;
+    }
+
+    //! attribute requests to the tag of the given name
+    explicit scoped_io_tag(const std::string& name)
+        : scoped_io_tag(stats::get_instance()->get_io_tag(name))
+    { }
+
+    //! non-copyable: delete copy-constructor
+    scoped_io_tag(const scoped_io_tag&) = delete;
+    //! non-copyable: delete assignment operator
+    scoped_io_tag& operator = (const scoped_io_tag&) = delete;
+
+    ~scoped_io_tag()
+    {
+        current_ = previous_;
+    }
+
+    //! tag of the requests the calling thread creates now
+    static io_tag_type current()
+    {
+        return current_;
+    }
+};
+
 class stats_data
 {
     //! seconds spent in parallel io
@@ -497,6 +830,9 @@ class stats_data
     //! list of individual file statistics.
     std::vector<file_stats_data> file_stats_data_list_;
 
+    //! list of the statistics of the I/O tags, ordered by tag
+    std::vector<tag_stats_data> tag_stats_data_list_;
+
     //! aggregator
     template <typename T, typename Functor>
     T fetch_sum(const Functor& get_value) const;
@@ -531,7 +867,8 @@ public:
           t_wait_read_(s.get_wait_read_time()),
           t_wait_write_(s.get_wait_write_time()),
           elapsed_(timestamp() - s.get_creation_time()),
-          file_stats_data_list_(s.deepcopy_file_stats_data_list())
+          file_stats_data_list_(s.deepcopy_file_stats_data_list()),
+          tag_stats_data_list_(s.deepcopy_tag_stats_data_list())
     { }
 
     stats_data operator + (const stats_data& a) const;
@@ -540,6 +877,21 @@ public:
     //! Returns the number of file_stats_data objects
     size_t num_files() const;
 
+    //! Returns the statistics of the individual files, ordered by device id
+    const std::vector<file_stats_data> & get_file_stats_data_list() const
+    {
+        return file_stats_data_list_;
+    }
+
+    //! Returns the statistics of the I/O tags, ordered by tag
+    const std::vector<tag_stats_data> & get_tag_stats_data_list() const
+    {
+        return tag_stats_data_list_;
+    }
+
+    //! Returns the statistics of an I/O tag, empty if it was not registered
+    tag_stats_data get_tag_stats_data(io_tag_type tag) const;
+
     //! Returns the sum of all read_count_.
     //! \return the sum of all read_count_
     unsigned get_read_count() const;
@@ -612,6 +964,37 @@ public:
 
     stats_data::summary<double> get_pio_speed_summary() const;
 
+    //! Returns sum, min, max, average and median of the time the devices
+    //! were busy, i.e. executing at least one operation.
+    stats_data::summary<double> get_busy_time_summary() const;
+
+    //! Returns sum, min, max, average and median of the utilization of the
+    //! devices: the fraction of the elapsed time they were busy.
+    stats_data::summary<double> get_utilization_summary() const;
+
+    //! Detects saturated devices, which limit the throughput while other
+    //! devices idle, e.g. due to imbalanced striping. Returns the ids of the
+    //! devices with a utilization of at least saturated, if any other device
+    //! had a utilization below idle, otherwise an empty vector.
+    std::vector<unsigned> get_saturated_devices(
+        double saturated = 0.95, double idle = 0.5) const;
+
+    //! Distribution of the latencies of reads on all files.
+    //! \return histogram to query percentiles from
+    latency_histogram_data get_read_latency() const;
+
+    //! Distribution of the latencies of writes on all files.
+    //! \return histogram to query percentiles from
+    latency_histogram_data get_write_latency() const;
+
+    //! Returns sum, min, max, average and median of the q-th read latency
+    //! percentile of the files, e.g. q = 0.99.
+    stats_data::summary<double> get_read_latency_summary(double q) const;
+
+    //! Returns sum, min, max, average and median of the q-th write latency
+    //! percentile of the files, e.g. q = 0.99.
+    stats_data::summary<double> get_write_latency_summary(double q) const;
+
     //! Retruns elapsed_ time
     //! \remark If stats_data is not the difference between two other stats_data
     //! objects, then this value is measures the time since the first file object
@@ -0,0 +1,89 @@
+/***************************************************************************
+ *  foxxll/io/latency_histogram.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include <foxxll/io/latency_histogram.hpp>
+
+namespace foxxll {
+
+constexpr size_t latency_histogram::num_buckets;
+
+latency_histogram_data::latency_histogram_data(const latency_histogram& h)
+{
+    for (size_t b = 0; b < latency_histogram::num_buckets; ++b)
+    {
+        const uint64_t c = h.count(b);
+        if (c == 0)
+            continue;
+        if (counts_.empty())
+            counts_.resize(latency_histogram::num_buckets, 0);
+        counts_[b] = c;
+        total_ += c;
+    }
+}
+
+latency_histogram_data
+latency_histogram_data::operator + (const latency_histogram_data& a) const
+{
+    if (a.counts_.empty())
+        return *this;
+    if (counts_.empty())
+        return a;
+
+    latency_histogram_data h = *this;
+    for (size_t b = 0; b < counts_.size(); ++b)
+        h.counts_[b] += a.counts_[b];
+    h.total_ += a.total_;
+    return h;
+}
+
+latency_histogram_data
+latency_histogram_data::operator - (const latency_histogram_data& a) const
+{
+    if (a.counts_.empty() || counts_.empty())
+        return *this;
+
+    // counters only grow, so a is an earlier snapshot of the same histogram
+    latency_histogram_data h = *this;
+    for (size_t b = 0; b < counts_.size(); ++b)
+        h.counts_[b] -= a.counts_[b];
+    h.total_ -= a.total_;
+    if (h.total_ == 0)
+        h.counts_.clear();
+    return h;
+}
+
+double latency_histogram_data::percentile(double q) const
+{
+    if (total_ == 0)
+        return 0.0;
+
+    // rank of the operation, counted from one
+    const uint64_t rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(std::min(q, 1.0) * total_)));
+
+    uint64_t seen = 0;
+    for (size_t b = 0; b < counts_.size(); ++b)
+    {
+        seen += counts_[b];
+        if (seen >= rank)
+            return static_cast<double>(latency_histogram::bucket_end(b)) * 1e-9;
+    }
+    return static_cast<double>(
+        latency_histogram::bucket_end(counts_.size() - 1)) * 1e-9;
+}
+
+} // namespace foxxll
+
+/**************************************************************************/
@@ -0,0 +1,136 @@
+/***************************************************************************
+ *  foxxll/io/latency_histogram.hpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef FOXXLL_IO_LATENCY_HISTOGRAM_HEADER
+#define FOXXLL_IO_LATENCY_HISTOGRAM_HEADER
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <tlx/math/clz.hpp>
+
+namespace foxxll {
+
+//! \addtogroup foxxll_iolayer
+//! \{
+
+/*!
+ * Log-linear histogram of operation latencies, updated concurrently.
+ *
+ * Latencies are counted in nanoseconds. Each power of two is split into
+ * 2^sub_bits linear buckets, hence every bucket is at most 1/16 = 6.25% wide
+ * relative to its values, from 1 ns up to 2^max_exponent ns (about 18
+ * minutes). Larger latencies are counted in the last bucket. Adding a value
+ * costs a count-leading-zeros and one relaxed atomic increment.
+ */
+class latency_histogram
+{
+public:
+    //! linear buckets per power of two: 2^sub_bits
+    static constexpr unsigned sub_bits = 4;
+    //! largest latency distinguished: 2^max_exponent nanoseconds
+    static constexpr unsigned max_exponent = 40;
+    //! number of buckets
+    static constexpr size_t num_buckets =
+        size_t(max_exponent - sub_bits + 1) << sub_bits;
+
+    //! bucket of a latency in nanoseconds
+    static size_t bucket(uint64_t ns)
+    {
+        if (ns >= (uint64_t(1) << max_exponent))
+            return num_buckets - 1;
+        if (ns < (uint64_t(1) << sub_bits))
+            return static_cast<size_t>(ns);
+
+        const unsigned exponent = 63 - tlx::clz(ns);
+        const unsigned shift = exponent - sub_bits;
+        return (size_t(shift + 1) << sub_bits)
+               | static_cast<size_t>((ns >> shift) & ((1u << sub_bits) - 1));
+    }
+
+    //! smallest latency in nanoseconds counted in a bucket
+    static uint64_t bucket_begin(size_t b)
+    {
+        const size_t group = b >> sub_bits;
+        const uint64_t sub = b & ((size_t(1) << sub_bits) - 1);
+        if (group == 0)
+            return sub;
+        return (sub | (uint64_t(1) << sub_bits)) << (group - 1);
+    }
+
+    //! first latency in nanoseconds beyond a bucket
+    static uint64_t bucket_end(size_t b)
+    {
+        const size_t group = b >> sub_bits;
+        return bucket_begin(b) + (group == 0 ? 1 : uint64_t(1) << (group - 1));
+    }
+
+    //! counts an operation which took the given seconds
+    void add(double seconds)
+    {
+        const uint64_t ns =
+            seconds > 0.0 ? static_cast<uint64_t>(seconds * 1e9) : 0;
+        counts_[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //! current count of a bucket
+    uint64_t count(size_t b) const
+    {
+        return counts_[b].load(std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, num_buckets> counts_ { };
+};
+
+/*!
+ * Snapshot of a latency_histogram, which may be added, subtracted and
+ * queried for percentiles.
+ */
+class latency_histogram_data
+{
+    //! counts per bucket, empty if no operation was counted
+    std::vector<uint64_t> counts_;
+    //! total number of operations
+    uint64_t total_ = 0;
+
+public:
+    latency_histogram_data() = default;
+
+    //! take the current counts of a latency_histogram
+    explicit latency_histogram_data(const latency_histogram& h);
+
+    latency_histogram_data operator + (const latency_histogram_data& a) const;
+    latency_histogram_data operator - (const latency_histogram_data& a) const;
+
+    //! number of operations counted
+    uint64_t get_count() const
+    {
+        return total_;
+    }
+
+    //! Latency in seconds below which the fraction q of the operations
+    //! finished, e.g. q = 0.99 for the 99th percentile. Returns the upper end
+    //! of the bucket of that operation, or zero if none was counted.
+    double percentile(double q) const;
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !FOXXLL_IO_LATENCY_HISTOGRAM_HEADER
+
+/**************************************************************************/
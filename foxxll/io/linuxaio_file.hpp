@@ -63,6 +63,9 @@ public:
     void serve(void* buffer, offset_type offset, size_type bytes,
                request::read_or_write op) final;
 
+    using file::aread;
+    using file::awrite;
+
     request_ptr aread(
         void* buffer, offset_type pos, size_type bytes,
         const completion_handler& on_cmpl = completion_handler()) final;
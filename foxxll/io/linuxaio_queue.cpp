@@ -27,6 +27,7 @@
 
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/io/linuxaio_request.hpp>
+#include <foxxll/io/request_tracer.hpp>
 #include <foxxll/mng/block_manager.hpp>
 
 namespace foxxll {
@@ -84,6 +85,7 @@ void linuxaio_queue::add_request(request_ptr& req)
 
     std::unique_lock<std::mutex> lock(waiting_mtx_);
     waiting_requests_.push_back(req);
+    stats_.enqueued(req.get());
     lock.unlock();
 
     num_waiting_requests_.signal();
@@ -110,6 +112,7 @@ bool linuxaio_queue::cancel_request(request_ptr& req)
         if (pos != waiting_requests_.end())
         {
             waiting_requests_.erase(pos);
+            stats_.canceled();
             lock.unlock();
 
             // request is canceled, but was not yet posted.
@@ -170,6 +173,7 @@ void linuxaio_queue::post_requests()
 
         request_ptr req = waiting_requests_.front();
         waiting_requests_.pop_front();
+        stats_.dequeued(req.get());
         reqs.emplace_back(std::move(req));
 
         // collect additional requests
@@ -184,6 +188,7 @@ void linuxaio_queue::post_requests()
 
             request_ptr req = waiting_requests_.front();
             waiting_requests_.pop_front();
+            stats_.dequeued(req.get());
             reqs.emplace_back(std::move(req));
         }
 
@@ -254,6 +259,8 @@ void linuxaio_queue::handle_events(io_event* events, long num_events, bool cance
     {
         request* r = reinterpret_cast<request*>(
                 static_cast<uintptr_t>(events[e].data));
+        request_tracer::trace(r, request_tracer::COMPLETE);
+        stats_.completed();
         r->completed(canceled);
         // release counting_ptr reference, this may delete the request object
         r->dec_reference();
@@ -309,6 +316,7 @@ void linuxaio_queue::wait_requests()
 
 void* linuxaio_queue::post_async(void* arg)
 {
+    request_tracer::name_thread("foxxll linuxaio post");
     (static_cast<linuxaio_queue*>(arg))->post_requests();
 
     self_type* pthis = static_cast<self_type*>(arg);
@@ -325,6 +333,7 @@ void* linuxaio_queue::post_async(void* arg)
 
 void* linuxaio_queue::wait_async(void* arg)
 {
+    request_tracer::name_thread("foxxll linuxaio wait");
     (static_cast<linuxaio_queue*>(arg))->wait_requests();
 
     self_type* pthis = static_cast<self_type*>(arg);
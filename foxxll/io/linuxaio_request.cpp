@@ -20,6 +20,7 @@
 
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/io/disk_queues.hpp>
+#include <foxxll/io/request_tracer.hpp>
 
 namespace foxxll {
 
@@ -29,8 +30,9 @@ void linuxaio_request::completed(bool posted, bool canceled)
         posted << "," << canceled << ")";
 
     auto* stats = file_->get_file_stats();
-    const double duration = timestamp() - time_posted_;
+    const ticks_type duration = timestamp_ticks() - time_posted_;
 
+    // canceled requests were never counted
     if (!canceled)
     {
         if (op_ == READ) {
@@ -39,14 +41,20 @@ void linuxaio_request::completed(bool posted, bool canceled)
         else {
             stats->write_op_finished(bytes_, duration);
         }
+
+        if (io_tag_)
+        {
+            tag_stats* ts = stats::get_instance()->get_tag_stats(io_tag_);
+            if (op_ == READ)
+                ts->read_finished(bytes_, duration);
+            else
+                ts->write_finished(bytes_, duration);
+        }
     }
-    else if (posted)
-    {
-        if (op_ == READ)
-            stats->read_canceled(bytes_);
-        else
-            stats->write_canceled(bytes_);
-    }
+
+    // posted requests kept the device busy, even if canceled by the kernel
+    if (posted)
+        stats->op_completed();
 
     request_with_state::completed(canceled);
 }
@@ -69,7 +77,9 @@ iocb* linuxaio_request::fill_control_block()
 
     // io_submit might considerable time, so we have to remember the current
     // time before the call.
-    time_posted_ = timestamp();
+    time_posted_ = timestamp_ticks();
+    file_->get_file_stats()->op_posted(time_posted_);
+    request_tracer::trace(this, request_tracer::POST);
 
     return &cb_;
 }
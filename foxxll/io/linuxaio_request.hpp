@@ -42,7 +42,7 @@ class linuxaio_request : public request_with_state
 
     //! control block of async request
     iocb cb_;
-    double time_posted_;
+    ticks_type time_posted_;
 
 public:
     linuxaio_request(
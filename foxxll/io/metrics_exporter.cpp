@@ -0,0 +1,535 @@
+/***************************************************************************
+ *  foxxll/io/metrics_exporter.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/io/metrics_exporter.hpp>
+
+#include <foxxll/config.hpp>
+
+#if !FOXXLL_WINDOWS
+ #include <sys/socket.h>
+ #include <sys/time.h>
+ #include <sys/un.h>
+ #include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include <tlx/logger/core.hpp>
+
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/common/exceptions.hpp>
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io/disk_queues.hpp>
+
+namespace foxxll {
+
+/******************************************************************************/
+// metrics_sample
+
+void metrics_sample::add(
+    const std::string& name, metric_type type, const std::string& help,
+    double value, const labels_type& labels)
+{
+    metrics_.push_back(metric { name, type, help, labels, value });
+}
+
+//! write a value, Prometheus accepts NaN and infinities, JSON only null
+static void write_value(std::ostream& os, double value, bool json)
+{
+    if (std::isfinite(value))
+        os << value;
+    else if (json)
+        os << "null";
+    else if (std::isnan(value))
+        os << "NaN";
+    else
+        os << (value > 0 ? "+Inf" : "-Inf");
+}
+
+//! write a string as JSON string, or as Prometheus label value
+static void write_quoted(std::ostream& os, const std::string& str)
+{
+    os << '"';
+    for (const char& c : str)
+    {
+        if (c == '"' || c == '\\')
+            os << '\\' << c;
+        else if (c == '\n')
+            os << "\\n";
+        else
+            os << c;
+    }
+    os << '"';
+}
+
+void metrics_sample::write_prometheus(std::ostream& os) const
+{
+    const std::ios::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision(15);
+
+    // metrics of the same name must be consecutive, keep the order of their
+    // first occurrence
+    std::vector<std::string> names;
+    std::map<std::string, std::vector<const metric*> > families;
+    for (const metric& m : metrics_)
+    {
+        std::vector<const metric*>& family = families[m.name];
+        if (family.empty())
+            names.push_back(m.name);
+        family.push_back(&m);
+    }
+
+    for (const std::string& name : names)
+    {
+        const std::vector<const metric*>& family = families[name];
+
+        os << "# HELP " << name << ' ' << family.front()->help << '\n'
+           << "# TYPE " << name << ' '
+           << (family.front()->type == COUNTER ? "counter" : "gauge") << '\n';
+
+        for (const metric* m : family)
+        {
+            os << name;
+            if (!m->labels.empty()) {
+                os << '{';
+                for (size_t i = 0; i < m->labels.size(); ++i) {
+                    if (i != 0) os << ',';
+                    os << m->labels[i].first << '=';
+                    write_quoted(os, m->labels[i].second);
+                }
+                os << '}';
+            }
+            os << ' ';
+            write_value(os, m->value, false);
+            os << '\n';
+        }
+    }
+
+    os.precision(precision);
+    os.flags(flags);
+}
+
+void metrics_sample::write_json(std::ostream& os, double time) const
+{
+    const std::ios::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision(15);
+
+    os << "{\"time\":" << std::fixed << std::setprecision(6) << time
+       << std::defaultfloat << std::setprecision(15) << ",\"metrics\":[";
+
+    for (size_t i = 0; i < metrics_.size(); ++i)
+    {
+        const metric& m = metrics_[i];
+        if (i != 0) os << ',';
+        os << "{\"name\":\"" << m.name << '"';
+        for (const auto& label : m.labels) {
+            os << ",\"" << label.first << "\":";
+            write_quoted(os, label.second);
+        }
+        os << ",\"value\":";
+        write_value(os, m.value, true);
+        os << '}';
+    }
+    os << "]}\n";
+
+    os.precision(precision);
+    os.flags(flags);
+}
+
+/******************************************************************************/
+// metrics_exporter
+
+metrics_exporter::metrics_exporter(
+    const std::string& target, format_type format, double interval)
+    : target_(target), format_(format), interval_(interval),
+      prev_stats_(*stats::get_instance()),
+      prev_time_(timestamp())
+{
+    if (target_.empty())
+        FOXXLL_THROW(bad_parameter, "metrics_exporter: empty target");
+    if (!(interval_ > 0.0))
+        FOXXLL_THROW(bad_parameter, "metrics_exporter: interval must be positive");
+#if FOXXLL_WINDOWS
+    if (target_.compare(0, 5, "unix:") == 0)
+        FOXXLL_THROW(bad_parameter, "metrics_exporter: UNIX sockets are not supported");
+#endif
+
+    for (const auto& q : disk_queues::get_instance()->get_queue_stats())
+        prev_queues_[q.first] = q.second;
+}
+
+metrics_exporter::~metrics_exporter()
+{
+    stop();
+}
+
+metrics_exporter::format_type
+metrics_exporter::parse_format(const std::string& name)
+{
+    if (name == "prometheus")
+        return PROMETHEUS;
+    if (name == "json")
+        return JSON;
+    FOXXLL_THROW(bad_parameter,
+                 "Unknown metrics format '" << name << "', "
+                 "expected 'prometheus' or 'json'.");
+}
+
+void metrics_exporter::add_source(const source_type& source)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    sources_.push_back(source);
+}
+
+void metrics_exporter::start()
+{
+    std::unique_lock<std::mutex> lock(thread_mutex_);
+    if (running_)
+        return;
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+}
+
+void metrics_exporter::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(thread_mutex_);
+        if (!running_)
+            return;
+        running_ = false;
+    }
+    cv_.notify_one();
+    thread_.join();
+
+    export_now();
+}
+
+void metrics_exporter::run()
+{
+    std::unique_lock<std::mutex> lock(thread_mutex_);
+    while (running_)
+    {
+        cv_.wait_for(lock, std::chrono::duration<double>(interval_));
+        if (!running_)
+            break;
+
+        lock.unlock();
+        export_now();
+        lock.lock();
+    }
+}
+
+void metrics_exporter::export_now()
+{
+    std::ostringstream oss;
+    {
+        metrics_sample sample = collect();
+        if (format_ == PROMETHEUS)
+            sample.write_prometheus(oss);
+        else
+            sample.write_json(oss, timestamp());
+    }
+
+    try {
+        write(oss.str());
+        error_logged_ = false;
+    }
+    catch (std::exception& e) {
+        if (!error_logged_)
+            TLX_LOG1 << "metrics_exporter: dropping samples, " << e.what();
+        error_logged_ = true;
+    }
+}
+
+metrics_sample metrics_exporter::collect()
+{
+    using labels_type = metrics_sample::labels_type;
+    const metrics_sample::metric_type counter = metrics_sample::COUNTER;
+    const metrics_sample::metric_type gauge = metrics_sample::GAUGE;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    metrics_sample s;
+
+    const double now = timestamp();
+    const stats_data cur(*stats::get_instance());
+    const stats_data delta = cur - prev_stats_;
+    const double interval = now - prev_time_;
+
+    static const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+    //! add percentiles of a latency histogram of the interval
+    auto add_quantiles = [&s](
+        const std::string& name, const std::string& help,
+        const latency_histogram_data& h, const labels_type& labels) {
+                             if (h.get_count() == 0) return;
+                             for (const double& q : quantiles) {
+                                 std::ostringstream qs;
+                                 qs << q;
+                                 labels_type l = labels;
+                                 l.emplace_back("quantile", qs.str());
+                                 s.add(name, gauge, help, h.percentile(q), l);
+                             }
+                         };
+
+    s.add("foxxll_uptime_seconds", gauge,
+          "Seconds since the I/O statistics were initialized.",
+          cur.get_elapsed_time());
+    s.add("foxxll_interval_seconds", gauge,
+          "Seconds covered by the interval metrics of this sample.", interval);
+
+    s.add("foxxll_parallel_read_seconds_total", counter,
+          "Seconds during which any read was running.", cur.get_pread_time());
+    s.add("foxxll_parallel_write_seconds_total", counter,
+          "Seconds during which any write was running.", cur.get_pwrite_time());
+    s.add("foxxll_parallel_io_seconds_total", counter,
+          "Seconds during which any I/O was running.", cur.get_pio_time());
+    s.add("foxxll_io_busy_ratio", gauge,
+          "Fraction of the interval during which any I/O was running.",
+          delta.get_pio_time() / interval);
+
+    s.add("foxxll_wait_seconds_total", counter,
+          "Seconds threads waited for I/O completion.",
+          cur.get_io_wait_time(), labels_type { { "op", "any" } });
+    s.add("foxxll_wait_seconds_total", counter,
+          "Seconds threads waited for I/O completion.",
+          cur.get_wait_read_time(), labels_type { { "op", "read" } });
+    s.add("foxxll_wait_seconds_total", counter,
+          "Seconds threads waited for I/O completion.",
+          cur.get_wait_write_time(), labels_type { { "op", "write" } });
+
+    // per file: totals, deltas of the interval and rates
+    const std::vector<file_stats_data>& files = cur.get_file_stats_data_list();
+    const std::vector<file_stats_data>& deltas = delta.get_file_stats_data_list();
+
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        const file_stats_data& f = files[i];
+        file_stats_data d;
+        for (const file_stats_data& fd : deltas) {
+            if (fd.get_device_id() == f.get_device_id())
+                d = fd;
+        }
+
+        const labels_type labels { { "device", std::to_string(f.get_device_id()) } };
+
+        s.add("foxxll_read_ops_total", counter, "Number of reads.",
+              f.get_read_count(), labels);
+        s.add("foxxll_read_bytes_total", counter, "Bytes read.",
+              static_cast<double>(f.get_read_bytes()), labels);
+        s.add("foxxll_read_seconds_total", counter, "Seconds spent in reads.",
+              f.get_read_time(), labels);
+        s.add("foxxll_write_ops_total", counter, "Number of writes.",
+              f.get_write_count(), labels);
+        s.add("foxxll_write_bytes_total", counter, "Bytes written.",
+              static_cast<double>(f.get_write_bytes()), labels);
+        s.add("foxxll_write_seconds_total", counter, "Seconds spent in writes.",
+              f.get_write_time(), labels);
+        s.add("foxxll_device_busy_seconds_total", counter,
+              "Seconds during which any I/O on the device was running.",
+              f.get_busy_time(), labels);
+        s.add("foxxll_device_utilization_ratio", gauge,
+              "Fraction of the interval during which the device was busy.",
+              d.get_busy_time() / interval, labels);
+
+        s.add("foxxll_read_ops_interval", gauge,
+              "Number of reads in the interval.", d.get_read_count(), labels);
+        s.add("foxxll_read_bytes_interval", gauge,
+              "Bytes read in the interval.",
+              static_cast<double>(d.get_read_bytes()), labels);
+        s.add("foxxll_write_ops_interval", gauge,
+              "Number of writes in the interval.", d.get_write_count(), labels);
+        s.add("foxxll_write_bytes_interval", gauge,
+              "Bytes written in the interval.",
+              static_cast<double>(d.get_write_bytes()), labels);
+
+        s.add("foxxll_read_ops_per_second", gauge,
+              "Reads per second in the interval.",
+              d.get_read_count() / interval, labels);
+        s.add("foxxll_read_bytes_per_second", gauge,
+              "Bytes read per second in the interval.",
+              static_cast<double>(d.get_read_bytes()) / interval, labels);
+        s.add("foxxll_write_ops_per_second", gauge,
+              "Writes per second in the interval.",
+              d.get_write_count() / interval, labels);
+        s.add("foxxll_write_bytes_per_second", gauge,
+              "Bytes written per second in the interval.",
+              static_cast<double>(d.get_write_bytes()) / interval, labels);
+
+        add_quantiles("foxxll_read_latency_seconds",
+                      "Latency percentiles of reads in the interval.",
+                      d.get_read_latency(), labels);
+        add_quantiles("foxxll_write_latency_seconds",
+                      "Latency percentiles of writes in the interval.",
+                      d.get_write_latency(), labels);
+    }
+
+    // per I/O tag: totals
+    for (const tag_stats_data& t : cur.get_tag_stats_data_list())
+    {
+        const labels_type labels { { "tag", t.get_name() } };
+
+        s.add("foxxll_tag_read_ops_total", counter,
+              "Number of reads of the tagged requests.",
+              t.get_read_count(), labels);
+        s.add("foxxll_tag_read_bytes_total", counter,
+              "Bytes read by the tagged requests.",
+              static_cast<double>(t.get_read_bytes()), labels);
+        s.add("foxxll_tag_write_ops_total", counter,
+              "Number of writes of the tagged requests.",
+              t.get_write_count(), labels);
+        s.add("foxxll_tag_write_bytes_total", counter,
+              "Bytes written by the tagged requests.",
+              static_cast<double>(t.get_write_bytes()), labels);
+        s.add("foxxll_tag_io_seconds_total", counter,
+              "Seconds spent serving the tagged requests.",
+              t.get_read_time() + t.get_write_time(), labels);
+        s.add("foxxll_tag_wait_seconds_total", counter,
+              "Seconds threads waited for the tagged requests.",
+              t.get_wait_read_time() + t.get_wait_write_time(), labels);
+    }
+
+    // per disk queue: gauges and waiting times of the interval
+    std::map<int64_t, request_queue_stats_data> queues;
+    for (const auto& q : disk_queues::get_instance()->get_queue_stats())
+        queues[q.first] = q.second;
+
+    for (const auto& q : queues)
+    {
+        const request_queue_stats_data& c = q.second;
+        const request_queue_stats_data d = c - prev_queues_[q.first];
+        const labels_type labels { { "queue", std::to_string(q.first) } };
+
+        s.add("foxxll_queue_depth", gauge,
+              "Requests waiting in the disk queue.", c.get_depth(), labels);
+        s.add("foxxll_queue_max_depth", gauge,
+              "Maximum number of requests waiting in the disk queue.",
+              c.get_max_depth(), labels);
+        s.add("foxxll_queue_in_flight", gauge,
+              "Requests taken from the disk queue and not completed.",
+              c.get_in_flight(), labels);
+        s.add("foxxll_queue_enqueued_total", counter,
+              "Requests added to the disk queue.", c.get_enqueued(), labels);
+        s.add("foxxll_queue_dequeued_total", counter,
+              "Requests taken from the disk queue.", c.get_dequeued(), labels);
+        s.add("foxxll_queue_canceled_total", counter,
+              "Requests canceled in the disk queue.", c.get_canceled(), labels);
+        s.add("foxxll_queue_wait_seconds_total", counter,
+              "Seconds requests waited in the disk queue.",
+              c.get_wait_time(), labels);
+        s.add("foxxll_queue_mean_depth", gauge,
+              "Mean number of requests waiting in the interval.",
+              d.get_mean_depth(interval), labels);
+        add_quantiles("foxxll_queue_wait_seconds",
+                      "Percentiles of the time requests waited in the "
+                      "interval.", d.get_wait_latency(), labels);
+    }
+
+    for (const source_type& source : sources_)
+        source(s);
+
+    prev_stats_ = cur;
+    prev_queues_ = std::move(queues);
+    prev_time_ = now;
+
+    return s;
+}
+
+void metrics_exporter::write(const std::string& text)
+{
+    if (target_.compare(0, 5, "unix:") == 0)
+    {
+#if !FOXXLL_WINDOWS
+        const std::string path = target_.substr(5);
+
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+            FOXXLL_THROW(io_error, "socket path '" << path << "' too long");
+        memcpy(addr.sun_path, path.c_str(), path.size());
+
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            FOXXLL_THROW_ERRNO(io_error, "creating socket");
+
+        // never let a stalled agent stall the exporter for long
+        timeval timeout { 1, 0 };
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            const int err = errno;
+            ::close(fd);
+            FOXXLL_THROW_ERRNO2(io_error, "connecting to '" << path << "'", err);
+        }
+
+        size_t done = 0;
+        while (done < text.size())
+        {
+#ifdef MSG_NOSIGNAL
+            const int flags = MSG_NOSIGNAL;
+#else
+            const int flags = 0;
+#endif
+            const ssize_t rc = ::send(fd, text.data() + done, text.size() - done, flags);
+            if (rc < 0) {
+                if (errno == EINTR) continue;
+                const int err = errno;
+                ::close(fd);
+                FOXXLL_THROW_ERRNO2(io_error, "writing to '" << path << "'", err);
+            }
+            done += static_cast<size_t>(rc);
+        }
+        ::close(fd);
+#endif
+        return;
+    }
+
+    if (format_ == PROMETHEUS)
+    {
+        // replace the file atomically, such that scrapers never see a
+        // partial sample
+        const std::string tmp_path = target_ + ".tmp";
+        {
+            std::ofstream out(tmp_path, std::ios::trunc);
+            out << text;
+            out.flush();
+            if (!out.good())
+                FOXXLL_THROW_ERRNO(io_error, "writing '" << tmp_path << "'");
+        }
+        if (std::rename(tmp_path.c_str(), target_.c_str()) != 0) {
+            FOXXLL_THROW_ERRNO(io_error, "renaming '" << tmp_path << "' to '"
+                               << target_ << "'");
+        }
+    }
+    else
+    {
+        std::ofstream out(target_, std::ios::app);
+        out << text;
+        out.flush();
+        if (!out.good())
+            FOXXLL_THROW_ERRNO(io_error, "appending to '" << target_ << "'");
+    }
+}
+
+} // namespace foxxll
+
+/**************************************************************************/
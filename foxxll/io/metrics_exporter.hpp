@@ -0,0 +1,162 @@
+/***************************************************************************
+ *  foxxll/io/metrics_exporter.hpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef FOXXLL_IO_METRICS_EXPORTER_HEADER
+#define FOXXLL_IO_METRICS_EXPORTER_HEADER
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <foxxll/io/iostats.hpp>
+#include <foxxll/io/request_queue_stats.hpp>
+
+namespace foxxll {
+
+//! \addtogroup foxxll_iolayer
+//! \{
+
+//! A set of named metric values taken at one point in time.
+class metrics_sample
+{
+public:
+    enum metric_type { COUNTER, GAUGE };
+
+    using labels_type = std::vector<std::pair<std::string, std::string> >;
+
+    struct metric
+    {
+        std::string name;
+        metric_type type;
+        std::string help;
+        labels_type labels;
+        double value;
+    };
+
+    //! add a value of the metric name, help is the description of the metric
+    void add(const std::string& name, metric_type type, const std::string& help,
+             double value, const labels_type& labels = labels_type());
+
+    const std::vector<metric> & metrics() const
+    {
+        return metrics_;
+    }
+
+    //! write as Prometheus text exposition format
+    void write_prometheus(std::ostream& os) const;
+
+    //! write as a single line of JSON, with the time of the sample
+    void write_json(std::ostream& os, double time) const;
+
+private:
+    std::vector<metric> metrics_;
+};
+
+/*!
+ * Periodically exports the I/O statistics for monitoring agents.
+ *
+ * A thread of the exporter takes snapshots of \c stats, of the \c file_stats
+ * of each file and of the disk queue gauges, and writes them either in the
+ * Prometheus text format or as newline-delimited JSON. Besides the totals, it
+ * exports the deltas of the last interval and the derived rates, computed by
+ * subtracting the previous \c stats_data snapshot, and latency percentiles
+ * of the interval. Sources added by add_source() contribute further metrics,
+ * e.g. block_manager::add_metrics_source() those of the disk allocations.
+ *
+ * The target is a file path, or "unix:<path>" for a UNIX stream socket which
+ * a local agent listens on. Prometheus samples replace the file atomically
+ * (as read by the node_exporter textfile collector), JSON samples are
+ * appended to it. Taking the snapshots reads atomic counters only, and all
+ * writing happens in the exporter thread, hence I/O threads never wait for
+ * the exporter. Failures to write are logged and the sample is dropped.
+ */
+class metrics_exporter
+{
+    static constexpr bool debug = false;
+
+public:
+    enum format_type { PROMETHEUS, JSON };
+
+    //! callback adding further metrics to each sample
+    using source_type = std::function<void(metrics_sample&)>;
+
+    //! Construct exporter writing to target every interval seconds. The
+    //! thread is started by start().
+    metrics_exporter(const std::string& target, format_type format,
+                     double interval = 10.0);
+
+    //! non-copyable: delete copy-constructor
+    metrics_exporter(const metrics_exporter&) = delete;
+    //! non-copyable: delete assignment operator
+    metrics_exporter& operator = (const metrics_exporter&) = delete;
+
+    //! stops the thread
+    ~metrics_exporter();
+
+    //! add a callback contributing metrics, e.g. of other layers
+    void add_source(const source_type& source);
+
+    //! start the exporting thread
+    void start();
+
+    //! stop the exporting thread, after writing a final sample
+    void stop();
+
+    //! take a sample now and write it to the target
+    void export_now();
+
+    //! take a sample, advancing the interval used for deltas and rates
+    metrics_sample collect();
+
+    //! parse "prometheus" or "json"
+    static format_type parse_format(const std::string& name);
+
+private:
+    const std::string target_;
+    const format_type format_;
+    const double interval_;
+
+    std::vector<source_type> sources_;
+
+    //! snapshots at the end of the previous interval
+    stats_data prev_stats_;
+    std::map<int64_t, request_queue_stats_data> prev_queues_;
+    double prev_time_;
+
+    //! serializes collect() and writing
+    std::mutex mutex_;
+
+    std::thread thread_;
+    std::mutex thread_mutex_;
+    std::condition_variable cv_;
+    bool running_ = false;
+    //! whether an error was logged, to log each kind once
+    bool error_logged_ = false;
+
+    void run();
+
+    void write(const std::string& text);
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !FOXXLL_IO_METRICS_EXPORTER_HEADER
+
+/**************************************************************************/
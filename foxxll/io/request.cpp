@@ -26,7 +26,7 @@ request::request(
     read_or_write op)
     : on_complete_(on_complete),
       file_(file), buffer_(buffer), offset_(offset), bytes_(bytes),
-      op_(op)
+      op_(op), io_tag_(scoped_io_tag::current())
 {
     TLX_LOG << "request_with_state[" << static_cast<void*>(this) << "]::request(...), ref_cnt=" << reference_count();
     file_->add_request_ref();
@@ -24,6 +24,7 @@
 #include <tlx/delegate.hpp>
 
 #include <foxxll/common/exceptions.hpp>
+#include <foxxll/io/iostats.hpp>
 #include <foxxll/io/request_interface.hpp>
 
 namespace foxxll {
@@ -50,6 +51,8 @@ class request : virtual public request_interface, public tlx::reference_counter
 {
     constexpr static bool debug = false;
     friend class linuxaio_queue;
+    friend class request_tracer;
+    friend class request_queue_stats;
 
 protected:
     completion_handler on_complete_;
@@ -72,6 +75,15 @@ protected:
 
     //! \}
 
+    //! I/O tag the request is attributed to, zero if untagged
+    io_tag_type io_tag_;
+
+private:
+    //! id in the request_tracer, zero if the request is not traced
+    uint64_t trace_id_ = 0;
+    //! time the request was added to its queue, in ticks
+    ticks_type time_queued_ = 0;
+
 public:
     request(const completion_handler& on_complete,
             file* file, void* buffer, offset_type offset, size_type bytes,
@@ -97,6 +109,7 @@ public:
     offset_type offset() const { return offset_; }
     size_type bytes() const { return bytes_; }
     read_or_write op() const { return op_; }
+    io_tag_type io_tag() const { return io_tag_; }
 
     void check_alignment() const;
 
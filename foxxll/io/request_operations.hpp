@@ -18,6 +18,7 @@
 #include <foxxll/common/onoff_switch.hpp>
 #include <foxxll/io/iostats.hpp>
 #include <foxxll/io/request.hpp>
+#include <foxxll/io/request_tracer.hpp>
 
 namespace foxxll {
 
@@ -124,6 +125,8 @@ RequestIterator wait_any(RequestIterator reqs_begin, RequestIterator reqs_end)
                 (request_ptr(*cur))->delete_waiter(&sw);
             }
 
+            request_tracer::trace(
+                request_ptr(*result).get(), request_tracer::WAKEUP);
             (request_ptr(*result))->check_errors();
 
             return result;
@@ -139,6 +142,9 @@ RequestIterator wait_any(RequestIterator reqs_begin, RequestIterator reqs_end)
             result = cur;
     }
 
+    if (result != reqs_end)
+        request_tracer::trace(request_ptr(*result).get(), request_tracer::WAKEUP);
+
     return result;
 }
 
@@ -17,6 +17,7 @@
 #include <tlx/unused.hpp>
 
 #include <foxxll/io/request.hpp>
+#include <foxxll/io/request_queue_stats.hpp>
 
 namespace foxxll {
 
@@ -29,6 +30,10 @@ class request_queue
 public:
     enum priority_op { READ, WRITE, NONE };
 
+protected:
+    //! gauges of waiting and in-flight requests
+    request_queue_stats stats_;
+
 public:
     request_queue() = default;
 
@@ -46,6 +51,9 @@ public:
     virtual bool cancel_request(request_ptr& req) = 0;
     virtual ~request_queue() { }
     virtual void set_priority_op(const priority_op& p) { tlx::unused(p); }
+
+    //! gauges of waiting and in-flight requests
+    const request_queue_stats & get_stats() const { return stats_; }
 };
 
 //! \}
@@ -21,6 +21,7 @@
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/config.hpp>
 #include <foxxll/io/request_queue_impl_1q.hpp>
+#include <foxxll/io/request_tracer.hpp>
 #include <foxxll/io/serving_request.hpp>
 
 #if FOXXLL_MSVC >= 1700 && FOXXLL_MSVC <= 1800
@@ -83,6 +84,7 @@ void request_queue_impl_1q::add_request(request_ptr& req)
 #endif
     std::unique_lock<std::mutex> lock(queue_mutex_);
     queue_.push_back(req);
+    stats_.enqueued(req.get());
 
     sem_.signal();
 }
@@ -105,6 +107,7 @@ bool request_queue_impl_1q::cancel_request(request_ptr& req)
         if (pos != queue_.end())
         {
             queue_.erase(pos);
+            stats_.canceled();
             was_still_in_queue = true;
             lock.unlock();
             sem_.wait();
@@ -122,6 +125,7 @@ request_queue_impl_1q::~request_queue_impl_1q()
 void* request_queue_impl_1q::worker(void* arg)
 {
     self* pthis = static_cast<self*>(arg);
+    request_tracer::name_thread("foxxll queue worker");
 
     for ( ; ; )
     {
@@ -133,11 +137,14 @@ void* request_queue_impl_1q::worker(void* arg)
             {
                 request_ptr req = pthis->queue_.front();
                 pthis->queue_.pop_front();
+                pthis->stats_.dequeued(req.get());
 
                 lock.unlock();
 
+                request_tracer::trace(req.get(), request_tracer::DEQUEUE);
                 //assert(req->nref() > 1);
                 dynamic_cast<serving_request*>(req.get())->serve();
+                pthis->stats_.completed();
             }
             else
             {
@@ -20,6 +20,7 @@
 
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/io/request_queue_impl_qwqr.hpp>
+#include <foxxll/io/request_tracer.hpp>
 #include <foxxll/io/serving_request.hpp>
 
 #if FOXXLL_MSVC >= 1700 && FOXXLL_MSVC <= 1800
@@ -84,6 +85,7 @@ void request_queue_impl_qwqr::add_request(request_ptr& req)
 #endif
         std::unique_lock<std::mutex> lock(read_mutex_);
         read_queue_.push_back(req);
+        stats_.enqueued(req.get());
     }
     else
     {
@@ -102,6 +104,7 @@ void request_queue_impl_qwqr::add_request(request_ptr& req)
 #endif
         std::unique_lock<std::mutex> lock(write_mutex_);
         write_queue_.push_back(req);
+        stats_.enqueued(req.get());
     }
 
     sem_.signal();
@@ -125,6 +128,7 @@ bool request_queue_impl_qwqr::cancel_request(request_ptr& req)
         if (pos != read_queue_.end())
         {
             read_queue_.erase(pos);
+            stats_.canceled();
             was_still_in_queue = true;
             lock.unlock();
             sem_.wait();
@@ -138,6 +142,7 @@ bool request_queue_impl_qwqr::cancel_request(request_ptr& req)
         if (pos != write_queue_.end())
         {
             write_queue_.erase(pos);
+            stats_.canceled();
             was_still_in_queue = true;
             lock.unlock();
             sem_.wait();
@@ -155,6 +160,7 @@ request_queue_impl_qwqr::~request_queue_impl_qwqr()
 void* request_queue_impl_qwqr::worker(void* arg)
 {
     self* pthis = static_cast<self*>(arg);
+    request_tracer::name_thread("foxxll queue worker");
 
     bool write_phase = true;
     for ( ; ; )
@@ -168,11 +174,14 @@ void* request_queue_impl_qwqr::worker(void* arg)
             {
                 request_ptr req = pthis->write_queue_.front();
                 pthis->write_queue_.pop_front();
+                pthis->stats_.dequeued(req.get());
 
                 write_lock.unlock();
 
+                request_tracer::trace(req.get(), request_tracer::DEQUEUE);
                 //assert(req->get_reference_count()) > 1);
                 dynamic_cast<serving_request*>(req.get())->serve();
+                pthis->stats_.completed();
             }
             else
             {
@@ -195,13 +204,16 @@ void* request_queue_impl_qwqr::worker(void* arg)
             {
                 request_ptr req = pthis->read_queue_.front();
                 pthis->read_queue_.pop_front();
+                pthis->stats_.dequeued(req.get());
 
                 read_lock.unlock();
 
+                request_tracer::trace(req.get(), request_tracer::DEQUEUE);
                 TLX_LOG << "queue: before serve request has "
                         << req->reference_count() << " references ";
                 //assert(req->get_reference_count() > 1);
                 dynamic_cast<serving_request*>(req.get())->serve();
+                pthis->stats_.completed();
                 TLX_LOG << "queue: after serve request has "
                         << req->reference_count() << " references ";
             }
@@ -0,0 +1,177 @@
+/***************************************************************************
+ *  foxxll/io/request_queue_stats.hpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef FOXXLL_IO_REQUEST_QUEUE_STATS_HEADER
+#define FOXXLL_IO_REQUEST_QUEUE_STATS_HEADER
+
+#include <atomic>
+#include <cstdint>
+
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io/iostats.hpp>
+#include <foxxll/io/latency_histogram.hpp>
+#include <foxxll/io/request.hpp>
+
+namespace foxxll {
+
+//! \addtogroup foxxll_reqlayer
+//! \{
+
+/*!
+ * Gauges of a request_queue: the requests waiting in the queue, the requests
+ * taken from it and not yet completed (in flight), and the distribution of
+ * the time requests waited in the queue.
+ *
+ * A queue whose requests wait long while few are in flight is device-bound.
+ * A queue which is mostly empty starves, i.e. the program submits too few
+ * requests. The queues update the gauges under their own locks, which costs
+ * a few relaxed atomic operations and a timestamp_ticks() per request.
+ */
+class request_queue_stats
+{
+    //! requests waiting in the queue, and the maximum seen
+    std::atomic<uint64_t> depth_ { 0 }, max_depth_ { 0 };
+    //! requests taken from the queue and not yet completed
+    std::atomic<uint64_t> in_flight_ { 0 };
+    //! requests added, taken from, and canceled in the queue
+    std::atomic<uint64_t> enqueued_ { 0 }, dequeued_ { 0 }, canceled_ { 0 };
+    //! ticks requests waited in the queue, summed, and their distribution
+    std::atomic<ticks_type> wait_time_ { 0 };
+    latency_histogram wait_latency_;
+
+public:
+    request_queue_stats() = default;
+
+    //! non-copyable: delete copy-constructor
+    request_queue_stats(const request_queue_stats&) = delete;
+    //! non-copyable: delete assignment operator
+    request_queue_stats& operator = (const request_queue_stats&) = delete;
+
+    //! a request was added to the queue
+    void enqueued(request* req)
+    {
+        req->time_queued_ = timestamp_ticks();
+        enqueued_.fetch_add(1, std::memory_order_relaxed);
+        const uint64_t depth = depth_.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint64_t max = max_depth_.load(std::memory_order_relaxed);
+        while (depth > max && !max_depth_.compare_exchange_weak(
+                   max, depth, std::memory_order_relaxed)) { }
+    }
+
+    //! a request was taken from the queue to be served or posted
+    void dequeued(request* req)
+    {
+        const ticks_type wait = timestamp_ticks() - req->time_queued_;
+        depth_.fetch_sub(1, std::memory_order_relaxed);
+        in_flight_.fetch_add(1, std::memory_order_relaxed);
+        dequeued_.fetch_add(1, std::memory_order_relaxed);
+        wait_time_.fetch_add(wait, std::memory_order_relaxed);
+        wait_latency_.add(ticks_to_seconds(wait));
+    }
+
+    //! a request was removed from the queue without being served
+    void canceled()
+    {
+        depth_.fetch_sub(1, std::memory_order_relaxed);
+        canceled_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //! a request taken from the queue completed
+    void completed()
+    {
+        in_flight_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    uint64_t get_depth() const { return depth_.load(std::memory_order_relaxed); }
+    uint64_t get_max_depth() const { return max_depth_.load(std::memory_order_relaxed); }
+    uint64_t get_in_flight() const { return in_flight_.load(std::memory_order_relaxed); }
+    uint64_t get_enqueued() const { return enqueued_.load(std::memory_order_relaxed); }
+    uint64_t get_dequeued() const { return dequeued_.load(std::memory_order_relaxed); }
+    uint64_t get_canceled() const { return canceled_.load(std::memory_order_relaxed); }
+    double get_wait_time() const { return ticks_to_seconds(wait_time_.load(std::memory_order_relaxed)); }
+    const latency_histogram & get_wait_latency() const { return wait_latency_; }
+};
+
+//! Snapshot of a request_queue_stats. Subtracting an earlier snapshot yields
+//! the counters of the interval and keeps the current gauges.
+class request_queue_stats_data
+{
+    uint64_t depth_ = 0, max_depth_ = 0, in_flight_ = 0;
+    uint64_t enqueued_ = 0, dequeued_ = 0, canceled_ = 0;
+    double wait_time_ = 0.0;
+    latency_histogram_data wait_latency_;
+
+public:
+    request_queue_stats_data() = default;
+
+    //! construct by taking the current values from request_queue_stats
+    explicit request_queue_stats_data(const request_queue_stats& s)
+        : depth_(s.get_depth()), max_depth_(s.get_max_depth()),
+          in_flight_(s.get_in_flight()),
+          enqueued_(s.get_enqueued()), dequeued_(s.get_dequeued()),
+          canceled_(s.get_canceled()),
+          wait_time_(s.get_wait_time()),
+          wait_latency_(s.get_wait_latency())
+    { }
+
+    request_queue_stats_data operator - (const request_queue_stats_data& a) const
+    {
+        request_queue_stats_data d = *this;
+        d.enqueued_ -= a.enqueued_;
+        d.dequeued_ -= a.dequeued_;
+        d.canceled_ -= a.canceled_;
+        d.wait_time_ -= a.wait_time_;
+        d.wait_latency_ = wait_latency_ - a.wait_latency_;
+        return d;
+    }
+
+    //! requests waiting in the queue
+    uint64_t get_depth() const { return depth_; }
+    //! maximum number of requests waiting in the queue since its creation
+    uint64_t get_max_depth() const { return max_depth_; }
+    //! requests taken from the queue and not yet completed
+    uint64_t get_in_flight() const { return in_flight_; }
+    //! number of requests added to the queue
+    uint64_t get_enqueued() const { return enqueued_; }
+    //! number of requests taken from the queue to be served
+    uint64_t get_dequeued() const { return dequeued_; }
+    //! number of requests canceled while waiting in the queue
+    uint64_t get_canceled() const { return canceled_; }
+    //! seconds the dequeued requests waited, summed
+    double get_wait_time() const { return wait_time_; }
+
+    //! mean seconds a dequeued request waited
+    double get_mean_wait_time() const
+    {
+        return dequeued_ ? wait_time_ / static_cast<double>(dequeued_) : 0.0;
+    }
+
+    //! mean number of waiting requests during elapsed seconds (Little's law)
+    double get_mean_depth(double elapsed) const
+    {
+        return elapsed > 0.0 ? wait_time_ / elapsed : 0.0;
+    }
+
+    //! distribution of the time the dequeued requests waited
+    const latency_histogram_data & get_wait_latency() const
+    {
+        return wait_latency_;
+    }
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !FOXXLL_IO_REQUEST_QUEUE_STATS_HEADER
+
+/**************************************************************************/
@@ -0,0 +1,300 @@
+/***************************************************************************
+ *  foxxll/io/request_tracer.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <utility>
+
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/common/exceptions.hpp>
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io/file.hpp>
+#include <foxxll/io/request_tracer.hpp>
+
+namespace foxxll {
+
+std::atomic<bool> request_tracer::enabled_ { false };
+
+constexpr size_t request_tracer::default_capacity;
+
+struct request_tracer::thread_registration
+{
+    //! list holding the buffer, kept alive until the thread exits
+    std::shared_ptr<buffer_list> list;
+    thread_buffer* buffer = nullptr;
+    const char* name = nullptr;
+
+    //! the buffer is kept for the trace and reused by a later thread
+    ~thread_registration()
+    {
+        if (!buffer)
+            return;
+
+        std::unique_lock<std::mutex> lock(list->mutex);
+        std::unique_lock<std::mutex> tb_lock(buffer->mutex);
+        buffer->retired = true;
+    }
+};
+
+static const char* event_name(request_tracer::event_type type)
+{
+    switch (type)
+    {
+    case request_tracer::SUBMIT: return "submit";
+    case request_tracer::DEQUEUE: return "dequeue";
+    case request_tracer::POST: return "post";
+    case request_tracer::COMPLETE: return "complete";
+    case request_tracer::HANDLER_BEGIN: return "handler_begin";
+    case request_tracer::HANDLER_END: return "handler_end";
+    case request_tracer::WAKEUP: return "wakeup";
+    }
+    return "unknown";
+}
+
+request_tracer::~request_tracer()
+{
+    enabled_.store(false);
+}
+
+void request_tracer::enable(size_t events_per_thread)
+{
+    std::unique_lock<std::mutex> lock(buffers_->mutex);
+
+    capacity_ = std::max<size_t>(events_per_thread, 1);
+    for (thread_buffer& tb : buffers_->buffers)
+    {
+        std::unique_lock<std::mutex> tb_lock(tb.mutex);
+        if (tb.events.size() != capacity_) {
+            tb.events.clear();
+            tb.events.resize(capacity_);
+            tb.next = 0;
+            tb.full = false;
+        }
+    }
+
+    enabled_.store(true);
+}
+
+void request_tracer::disable()
+{
+    enabled_.store(false);
+}
+
+void request_tracer::clear()
+{
+    std::unique_lock<std::mutex> lock(buffers_->mutex);
+
+    // buffers of exited threads are released
+    buffers_->buffers.remove_if(
+        [](const thread_buffer& tb) { return tb.retired; });
+
+    for (thread_buffer& tb : buffers_->buffers)
+    {
+        std::unique_lock<std::mutex> tb_lock(tb.mutex);
+        tb.next = 0;
+        tb.full = false;
+    }
+}
+
+size_t request_tracer::size() const
+{
+    std::unique_lock<std::mutex> lock(buffers_->mutex);
+    size_t total = 0;
+    for (const thread_buffer& tb : buffers_->buffers)
+    {
+        std::unique_lock<std::mutex> tb_lock(tb.mutex);
+        total += tb.full ? tb.events.size() : tb.next;
+    }
+    return total;
+}
+
+void request_tracer::name_thread(const char* name)
+{
+    thread_registration& reg = registration();
+    reg.name = name;
+    if (reg.buffer) {
+        std::unique_lock<std::mutex> tb_lock(reg.buffer->mutex);
+        reg.buffer->name = name;
+    }
+}
+
+request_tracer::thread_registration& request_tracer::registration()
+{
+    static thread_local thread_registration reg;
+    return reg;
+}
+
+request_tracer::thread_buffer& request_tracer::local_buffer()
+{
+    thread_registration& reg = registration();
+    if (TLX_LIKELY(reg.buffer != nullptr))
+        return *reg.buffer;
+
+    std::unique_lock<std::mutex> lock(buffers_->mutex);
+
+    // reuse the buffer of an exited thread, dropping its events
+    auto it = std::find_if(
+        buffers_->buffers.begin(), buffers_->buffers.end(),
+        [](const thread_buffer& tb) { return tb.retired; });
+    if (it == buffers_->buffers.end())
+        it = buffers_->buffers.emplace(buffers_->buffers.end());
+
+    thread_buffer& tb = *it;
+    std::unique_lock<std::mutex> tb_lock(tb.mutex);
+    tb.events.resize(capacity_);
+    tb.next = 0;
+    tb.full = false;
+    tb.tid = ++buffers_->last_tid;
+    tb.name = reg.name;
+    tb.retired = false;
+
+    reg.list = buffers_;
+    reg.buffer = &tb;
+    return tb;
+}
+
+void request_tracer::record(request* req, event_type type)
+{
+    event e;
+
+    if (type == SUBMIT)
+        req->trace_id_ = next_id_.fetch_add(1, std::memory_order_relaxed) + 1;
+    else if (req->trace_id_ == 0)
+        return;
+
+    e.time = timestamp();
+    e.id = req->trace_id_;
+    e.offset = req->offset();
+    e.bytes = req->bytes();
+    e.device_id = req->get_file() ? req->get_file()->get_device_id()
+                  : std::numeric_limits<unsigned>::max();
+    e.type = type;
+    e.op = req->op();
+
+    thread_buffer& tb = local_buffer();
+    std::unique_lock<std::mutex> lock(tb.mutex);
+    tb.events[tb.next] = e;
+    if (++tb.next == tb.events.size()) {
+        tb.next = 0;
+        tb.full = true;
+    }
+}
+
+void request_tracer::write_chrome_trace(std::ostream& os) const
+{
+    //! events of each request: thread number and event
+    std::map<uint64_t, std::vector<std::pair<size_t, event> > > requests;
+    //! names of the threads
+    std::vector<std::pair<size_t, const char*> > threads;
+    double begin = std::numeric_limits<double>::max();
+
+    {
+        std::unique_lock<std::mutex> lock(buffers_->mutex);
+        for (const thread_buffer& tb : buffers_->buffers)
+        {
+            std::unique_lock<std::mutex> tb_lock(tb.mutex);
+            const size_t n = tb.full ? tb.events.size() : tb.next;
+            for (size_t i = 0; i < n; ++i) {
+                const event& e = tb.events[i];
+                requests[e.id].emplace_back(tb.tid, e);
+                begin = std::min(begin, e.time);
+            }
+            threads.emplace_back(tb.tid, tb.name);
+        }
+    }
+
+    const std::ios::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(3);
+
+    // microseconds since the first event
+    auto ts = [begin](const event& e) { return (e.time - begin) * 1e6; };
+
+    os << "{\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&os, &first]() {
+        if (!first) os << ",\n";
+        first = false;
+    };
+
+    for (const auto& t : threads)
+    {
+        if (!t.second) continue;
+        separator();
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+           << t.first << ",\"args\":{\"name\":\"" << t.second << "\"}}";
+    }
+
+    for (auto& r : requests)
+    {
+        auto& events = r.second;
+        std::stable_sort(
+            events.begin(), events.end(),
+            [](const std::pair<size_t, event>& a,
+               const std::pair<size_t, event>& b) {
+                return a.second.time < b.second.time;
+            });
+
+        const event& e0 = events.front().second;
+        const char* op = (e0.op == request::READ) ? "read" : "write";
+
+        // the request as async slice from its first to its last event
+        separator();
+        os << "{\"name\":\"" << op << "\",\"cat\":\"request\",\"ph\":\"b\""
+           << ",\"id\":" << r.first << ",\"pid\":0,\"tid\":" << events.front().first
+           << ",\"ts\":" << ts(e0) << ",\"args\":{\"device\":" << e0.device_id
+           << ",\"offset\":" << e0.offset << ",\"bytes\":" << e0.bytes << "}}";
+
+        for (const auto& te : events)
+        {
+            const event& e = te.second;
+            // step within the request
+            separator();
+            os << "{\"name\":\"" << event_name(e.type) << "\",\"cat\":\"request\""
+               << ",\"ph\":\"n\",\"id\":" << r.first << ",\"pid\":0,\"tid\":"
+               << te.first << ",\"ts\":" << ts(e) << "}";
+            // the same step on the timeline of the thread
+            separator();
+            os << "{\"name\":\"" << op << ' ' << event_name(e.type)
+               << "\",\"cat\":\"thread\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0"
+               << ",\"tid\":" << te.first << ",\"ts\":" << ts(e)
+               << ",\"args\":{\"id\":" << r.first << ",\"offset\":" << e0.offset
+               << "}}";
+        }
+
+        separator();
+        os << "{\"name\":\"" << op << "\",\"cat\":\"request\",\"ph\":\"e\""
+           << ",\"id\":" << r.first << ",\"pid\":0,\"tid\":" << events.back().first
+           << ",\"ts\":" << ts(events.back().second) << "}";
+    }
+
+    os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    os.flags(flags);
+}
+
+void request_tracer::write_chrome_trace(const std::string& path) const
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.good())
+        FOXXLL_THROW_ERRNO(io_error, "opening trace file '" << path << "'");
+
+    write_chrome_trace(out);
+
+    if (!out.good())
+        FOXXLL_THROW_ERRNO(io_error, "writing trace file '" << path << "'");
+}
+
+} // namespace foxxll
+
+/**************************************************************************/
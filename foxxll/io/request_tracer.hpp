@@ -0,0 +1,177 @@
+/***************************************************************************
+ *  foxxll/io/request_tracer.hpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef FOXXLL_IO_REQUEST_TRACER_HEADER
+#define FOXXLL_IO_REQUEST_TRACER_HEADER
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <tlx/define/likely.hpp>
+
+#include <foxxll/io/request.hpp>
+#include <foxxll/singleton.hpp>
+
+namespace foxxll {
+
+//! \addtogroup foxxll_reqlayer
+//! \{
+
+/*!
+ * Opt-in tracer of the lifecycle of I/O requests.
+ *
+ * While enabled, each request submitted to the disk_queues gets a trace id,
+ * and the library records when it is submitted, taken from a queue by a
+ * worker, posted to the kernel (linuxaio), completed by the device, when its
+ * completion handler runs and when a waiter wakes up. Each event stores the
+ * time, the calling thread, and the file, offset and size of the request.
+ *
+ * Events go to a ring buffer of the recording thread, which keeps the latest
+ * events only. The buffer of an exited thread is kept for the trace until a
+ * new recording thread reuses it or clear() is called, hence the memory is
+ * bounded by the number of concurrently recording threads. The buffers can
+ * be written as Chrome trace JSON, to be viewed
+ * with chrome://tracing or https://ui.perfetto.dev. While disabled, each
+ * tracing point costs one relaxed atomic load.
+ */
+class request_tracer : public singleton<request_tracer>
+{
+    friend class singleton<request_tracer>;
+
+public:
+    //! steps in the lifecycle of a request
+    enum event_type {
+        SUBMIT,
+        DEQUEUE,
+        POST,
+        COMPLETE,
+        HANDLER_BEGIN,
+        HANDLER_END,
+        WAKEUP
+    };
+
+    //! default number of events kept per thread
+    static constexpr size_t default_capacity = 65536;
+
+    //! start recording, keeping the latest events_per_thread of each thread
+    void enable(size_t events_per_thread = default_capacity);
+
+    //! stop recording, the recorded events are kept
+    void disable();
+
+    //! whether requests are currently traced
+    static bool enabled()
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    //! discard all recorded events
+    void clear();
+
+    //! number of events currently recorded
+    size_t size() const;
+
+    //! write the recorded events as Chrome trace JSON
+    void write_chrome_trace(std::ostream& os) const;
+
+    //! write the recorded events as Chrome trace JSON to a file
+    void write_chrome_trace(const std::string& path) const;
+
+    //! name the calling thread in the trace, e.g. for I/O worker threads.
+    //! The name must be a string literal or otherwise outlive the tracer.
+    static void name_thread(const char* name);
+
+    //! record a step of a request, if tracing is enabled
+    static void trace(request* req, event_type type)
+    {
+        if (TLX_UNLIKELY(enabled()))
+            get_instance()->record(req, type);
+    }
+
+private:
+    //! a recorded step
+    struct event
+    {
+        double time;
+        uint64_t id;
+        request::offset_type offset;
+        request::size_type bytes;
+        unsigned device_id;
+        event_type type;
+        request::read_or_write op;
+    };
+
+    //! events recorded by one thread
+    struct thread_buffer
+    {
+        mutable std::mutex mutex;
+        std::vector<event> events;
+        //! position of the next event, the oldest one if full
+        size_t next = 0;
+        //! whether the buffer was filled once
+        bool full = false;
+        //! thread number in the trace
+        size_t tid;
+        const char* name;
+        //! the thread exited, the buffer may be reused
+        bool retired = false;
+    };
+
+    //! buffers of all threads which recorded events, shared with the threads
+    //! which retire their buffer on exit, possibly after the tracer is gone
+    struct buffer_list
+    {
+        std::mutex mutex;
+        std::list<thread_buffer> buffers;
+        //! last thread number assigned
+        size_t last_tid = 0;
+    };
+
+    //! buffer and name of a thread, defined in request_tracer.cpp
+    struct thread_registration;
+
+    static std::atomic<bool> enabled_;
+
+    //! source of trace ids, zero means untraced
+    std::atomic<uint64_t> next_id_ { 0 };
+
+    //! capacity of the thread buffers
+    size_t capacity_ = default_capacity;
+
+    std::shared_ptr<buffer_list> buffers_ = std::make_shared<buffer_list>();
+
+    request_tracer() = default;
+
+    ~request_tracer();
+
+    void record(request* req, event_type type);
+
+    //! registration of the calling thread
+    static thread_registration& registration();
+
+    //! buffer of the calling thread, registered or reused on first use
+    thread_buffer& local_buffer();
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !FOXXLL_IO_REQUEST_TRACER_HEADER
+
+/**************************************************************************/
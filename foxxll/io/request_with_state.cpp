@@ -19,6 +19,7 @@
 #include <foxxll/io/file.hpp>
 #include <foxxll/io/iostats.hpp>
 #include <foxxll/io/request.hpp>
+#include <foxxll/io/request_tracer.hpp>
 #include <foxxll/io/request_with_state.hpp>
 #include <foxxll/singleton.hpp>
 
@@ -36,10 +37,13 @@ void request_with_state::wait(bool measure_time)
     TLX_LOG << "request_with_state[" << static_cast<void*>(this) << "]::wait()";
 
     stats::scoped_wait_timer wait_timer(
-        op_ == READ ? stats::WAIT_OP_READ : stats::WAIT_OP_WRITE, measure_time);
+        op_ == READ ? stats::WAIT_OP_READ : stats::WAIT_OP_WRITE, measure_time,
+        io_tag_);
 
     state_.wait_for(READY2DIE);
 
+    request_tracer::trace(this, request_tracer::WAKEUP);
+
     check_errors();
 }
 
@@ -81,8 +85,11 @@ void request_with_state::completed(bool canceled)
     // change state
     state_.set_to(DONE);
     // user callback
-    if (on_complete_)
+    if (on_complete_) {
+        request_tracer::trace(this, request_tracer::HANDLER_BEGIN);
         on_complete_(this, !canceled);
+        request_tracer::trace(this, request_tracer::HANDLER_END);
+    }
     notify_waiters();
     // delete request reference in file
     release_file_reference();
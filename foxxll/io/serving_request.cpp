@@ -16,7 +16,9 @@
 #include <foxxll/common/exceptions.hpp>
 #include <foxxll/common/shared_state.hpp>
 #include <foxxll/io/file.hpp>
+#include <foxxll/io/iostats.hpp>
 #include <foxxll/io/request_interface.hpp>
+#include <foxxll/io/request_tracer.hpp>
 #include <foxxll/io/request_with_state.hpp>
 #include <foxxll/io/serving_request.hpp>
 
@@ -48,6 +50,9 @@ void serving_request::serve()
         << offset_ << "/0x" << bytes_
         << (op_ == request::READ ? " READ" : " WRITE");
 
+    // only tagged requests are timed for their tag
+    const ticks_type start = io_tag_ ? timestamp_ticks() : 0;
+
     try
     {
         file_->serve(buffer_, offset_, bytes_, op_);
@@ -57,6 +62,17 @@ void serving_request::serve()
         error_occured(ex.what());
     }
 
+    if (io_tag_)
+    {
+        tag_stats* ts = stats::get_instance()->get_tag_stats(io_tag_);
+        if (op_ == READ)
+            ts->read_finished(bytes_, timestamp_ticks() - start);
+        else
+            ts->write_finished(bytes_, timestamp_ticks() - start);
+    }
+
+    request_tracer::trace(this, request_tracer::COMPLETE);
+
     check_nref(true);
 
     completed(false);
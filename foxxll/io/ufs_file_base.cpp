@@ -15,6 +15,7 @@
  **************************************************************************/
 
 #include <tlx/logger/core.hpp>
+#include <tlx/unused.hpp>
 
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/common/exceptions.hpp>
@@ -31,7 +32,7 @@ const char* ufs_file_base::io_type() const
 }
 
 ufs_file_base::ufs_file_base(const std::string& filename, int mode)
-    : file_des_(-1), mode_(mode), filename_(filename)
+    : file_des_(-1), mode_(mode), filename_(filename), punch_holes_(true)
 {
     int flags = 0;
 
@@ -208,6 +209,18 @@ void ufs_file_base::lock()
 #endif
 }
 
+void ufs_file_base::sync()
+{
+    std::unique_lock<std::mutex> fd_lock(fd_mutex_);
+#if FOXXLL_WINDOWS || defined(__MINGW32__)
+    if (::_commit(file_des_) != 0)
+        FOXXLL_THROW_ERRNO(io_error, "_commit() path=" << filename_ << " fd=" << file_des_);
+#else
+    if (::fsync(file_des_) != 0)
+        FOXXLL_THROW_ERRNO(io_error, "fsync() path=" << filename_ << " fd=" << file_des_);
+#endif
+}
+
 file::offset_type ufs_file_base::_size()
 {
     // We use lseek SEEK_END to find the file size. This works for raw devices
@@ -234,6 +247,51 @@ void ufs_file_base::set_size(offset_type newsize)
     return _set_size(newsize);
 }
 
+void ufs_file_base::preallocate(offset_type newsize)
+{
+    std::unique_lock<std::mutex> fd_lock(fd_mutex_);
+
+    offset_type cur_size = _size();
+
+    if ((mode_ & RDONLY) || is_device_ || newsize <= cur_size)
+        return _set_size(newsize);
+
+#if FOXXLL_WINDOWS || defined(__MINGW32__)
+    _set_size(newsize);
+#else
+    const off_t len = static_cast<off_t>(newsize - cur_size);
+
+#if defined(__linux__)
+    // fallocate() reserves extents without writing, but is not supported by
+    // all file systems.
+    if (::fallocate(file_des_, 0, static_cast<off_t>(cur_size), len) == 0)
+        return;
+
+    if (errno != EOPNOTSUPP && errno != ENOSYS)
+        FOXXLL_THROW_ERRNO(
+            io_error, "fallocate() path=" << filename_ << " fd=" << file_des_ <<
+                " oldsize=" << cur_size << " newsize=" << newsize
+        );
+#endif
+
+    // posix_fallocate() may emulate the allocation by writing to each block
+    int error = ::posix_fallocate(file_des_, static_cast<off_t>(cur_size), len);
+    if (error == 0)
+        return;
+
+    if (error != EINVAL && error != EOPNOTSUPP) {
+        FOXXLL_THROW_ERRNO2(
+            io_error, "posix_fallocate() path=" << filename_ << " fd=" << file_des_ <<
+                " oldsize=" << cur_size << " newsize=" << newsize, error
+        );
+    }
+
+    TLX_LOG1 << "preallocation not supported on path=" << filename_
+             << ", extending with ftruncate() instead";
+    _set_size(newsize);
+#endif
+}
+
 void ufs_file_base::_set_size(offset_type newsize)
 {
     offset_type cur_size = _size();
@@ -280,6 +338,39 @@ void ufs_file_base::_set_size(offset_type newsize)
 #endif
 }
 
+void ufs_file_base::discard(offset_type offset, offset_type size)
+{
+#if defined(FALLOC_FL_PUNCH_HOLE) && defined(FALLOC_FL_KEEP_SIZE) && \
+    !defined(FOXXLL_UFS_NO_PUNCH_HOLE)
+    if (!punch_holes_.load(std::memory_order_relaxed) ||
+        (mode_ & RDONLY) || size == 0)
+        return;
+
+    std::unique_lock<std::mutex> fd_lock(fd_mutex_);
+
+    if (::fallocate(file_des_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                    static_cast<off_t>(offset), static_cast<off_t>(size)) != 0)
+    {
+        if (errno == EOPNOTSUPP || errno == ENOSYS || errno == ENODEV)
+        {
+            // file system or device does not support it: stop trying.
+            TLX_LOG1 << "fallocate(PUNCH_HOLE) not supported on path="
+                     << filename_ << ", discard() disabled";
+            punch_holes_.store(false, std::memory_order_relaxed);
+        }
+        else
+        {
+            TLX_LOG1 << "fallocate(PUNCH_HOLE) error on path=" << filename_
+                     << " offset=" << offset << " size=" << size
+                     << " error=" << strerror(errno);
+        }
+    }
+#else
+    tlx::unused(offset);
+    tlx::unused(size);
+#endif
+}
+
 void ufs_file_base::close_remove()
 {
     close();
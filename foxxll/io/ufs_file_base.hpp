@@ -18,6 +18,7 @@
 #ifndef FOXXLL_IO_UFS_FILE_BASE_HEADER
 #define FOXXLL_IO_UFS_FILE_BASE_HEADER
 
+#include <atomic>
 #include <mutex>
 #include <string>
 
@@ -37,6 +38,8 @@ protected:
     int mode_;            // open mode
     const std::string filename_;
     bool is_device_;      //!< is special device node
+    //! discard() punches holes, cleared if unsupported. Read without fd_mutex_.
+    std::atomic<bool> punch_holes_;
     ufs_file_base(const std::string& filename, int mode);
     void _after_open();
     offset_type _size();
@@ -47,9 +50,15 @@ public:
     ~ufs_file_base();
     offset_type size() final;
     void set_size(offset_type newsize) final;
+    void preallocate(offset_type newsize) final;
     void lock() final;
+    //! fsync() the file
+    void sync() final;
     const char * io_type() const override;
     void close_remove() final;
+    //! Deallocate the disk space of a region by punching a hole into the
+    //! file, if supported by the platform and file system.
+    void discard(offset_type offset, offset_type size) final;
     //! unlink file without closing it.
     void unlink();
     //! return true if file is special device node
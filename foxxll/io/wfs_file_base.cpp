@@ -180,6 +180,13 @@ void wfs_file_base::lock()
     locked_ = true;
 }
 
+void wfs_file_base::sync()
+{
+    std::unique_lock<std::mutex> fd_lock(fd_mutex_);
+    if (!FlushFileBuffers(file_des_))
+        FOXXLL_THROW_WIN_LASTERROR(io_error, "FlushFileBuffers() fd=" << file_des_);
+}
+
 file::offset_type wfs_file_base::_size()
 {
     LARGE_INTEGER result;
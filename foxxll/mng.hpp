@@ -15,6 +15,7 @@
 
 #include <foxxll/common/new_alloc.hpp>
 #include <foxxll/mng/block_manager.hpp>
+#include <foxxll/mng/io_profiler.hpp>
 #include <foxxll/mng/typed_block.hpp>
 
 //! \c FOXXLL library namespace
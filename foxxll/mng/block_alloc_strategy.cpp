@@ -0,0 +1,191 @@
+/***************************************************************************
+ *  foxxll/mng/block_alloc_strategy.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/io/iostats.hpp>
+#include <foxxll/mng/block_alloc_strategy.hpp>
+#include <foxxll/mng/block_alloc_strategy_dynamic.hpp>
+#include <foxxll/mng/block_manager.hpp>
+#include <foxxll/mng/config.hpp>
+
+namespace foxxll {
+
+std::vector<double> load_aware::disk_weights(size_t begin, size_t end)
+{
+    block_manager* bm = block_manager::get_instance();
+    config* cfg = config::get_instance();
+
+    std::vector<double> space(end - begin, 0.0), speed(end - begin, 0.0);
+    double speed_sum = 0;
+    size_t speed_num = 0;
+
+    // disks which are not configured get no blocks
+    const size_t last = std::max(begin, std::min<size_t>(end, cfg->disks_number()));
+
+    for (size_t d = begin; d < last; ++d)
+    {
+        uint64_t free = bm->free_bytes(d);
+        if (cfg->disk(d).autogrow)
+            free = std::max(free, bm->total_bytes(d));
+        space[d - begin] = static_cast<double>(free);
+
+        const file_stats* fs = bm->disk_file_stats(d);
+        const double bytes = static_cast<double>(
+            fs->get_read_bytes() + fs->get_write_bytes());
+        const double time = fs->get_read_time() + fs->get_write_time();
+        if (bytes > 0 && time > 0) {
+            speed[d - begin] = bytes / time;
+            speed_sum += speed[d - begin];
+            ++speed_num;
+        }
+    }
+
+    std::vector<double> weights(end - begin);
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        if (speed[i] == 0.0)
+            speed[i] = (speed_num != 0) ? speed_sum / speed_num : 1.0;
+        weights[i] = space[i] * speed[i];
+    }
+
+    return weights;
+}
+
+void load_aware::init()
+{
+    std::vector<double> weights = disk_weights(begin_, begin_ + diff_);
+
+    double total = 0;
+    for (const double& w : weights)
+        total += w;
+
+    if (total <= 0) {
+        // nothing known: plain striping
+        std::fill(weights.begin(), weights.end(), 1.0);
+        total = static_cast<double>(diff_);
+    }
+
+    // smooth weighted round-robin: every step, each disk gains its weight
+    // and the disk with the largest credit is chosen and pays the total.
+    // This spreads the blocks of each disk evenly over the sequence.
+    const size_t slots_per_disk = 64;
+    std::vector<double> credit(diff_, 0.0);
+    sequence_.resize(diff_ * slots_per_disk);
+
+    for (size_t& slot : sequence_)
+    {
+        for (size_t d = 0; d < diff_; ++d)
+            credit[d] += weights[d];
+
+        const size_t best = static_cast<size_t>(
+            std::max_element(credit.begin(), credit.end()) - credit.begin());
+        credit[best] -= total;
+        slot = best;
+    }
+}
+
+/******************************************************************************/
+// alloc_strategy_registry
+
+alloc_strategy_registry::alloc_strategy_registry()
+{
+    add<striping>("striping");
+    add<fully_random>("fully_random");
+    add<simple_random>("simple_random");
+    add<random_cyclic>("random_cyclic");
+    add<random_cyclic_disk>("random_cyclic_disk");
+    add<random_cyclic_flash>("random_cyclic_flash");
+    add<single_disk>("single_disk");
+    add<load_aware>("load_aware");
+}
+
+void alloc_strategy_registry::add(
+    const std::string& name, const factory_type& factory)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    factories_[name] = factory;
+}
+
+alloc_strategy_base* alloc_strategy_registry::create(
+    const std::string& name, size_t begin, size_t end) const
+{
+    factory_type factory;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = factories_.find(name);
+        if (it != factories_.end())
+            factory = it->second;
+    }
+
+    if (!factory) {
+        std::ostringstream known;
+        for (const std::string& n : names())
+            known << ' ' << n;
+        FOXXLL_THROW(
+            std::runtime_error,
+            "Unknown allocation strategy '" << name << "', known:" << known.str()
+        );
+    }
+
+    return factory(begin, end);
+}
+
+bool alloc_strategy_registry::contains(const std::string& name) const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return factories_.count(name) != 0;
+}
+
+std::vector<std::string> alloc_strategy_registry::names() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<std::string> result;
+    for (const auto& f : factories_)
+        result.push_back(f.first);
+    return result;
+}
+
+/******************************************************************************/
+// dynamic_alloc_strategy
+
+std::string dynamic_alloc_strategy::configured_name()
+{
+    const std::string& name = config::get_instance()->alloc_strategy();
+    return name.empty() ? "random_cyclic" : name;
+}
+
+dynamic_alloc_strategy::dynamic_alloc_strategy()
+    : dynamic_alloc_strategy(
+          configured_name(), 0, config::get_instance()->disks_number())
+{ }
+
+dynamic_alloc_strategy::dynamic_alloc_strategy(size_t begin, size_t end)
+    : dynamic_alloc_strategy(configured_name(), begin, end)
+{ }
+
+dynamic_alloc_strategy::dynamic_alloc_strategy(const std::string& name)
+    : dynamic_alloc_strategy(name, 0, config::get_instance()->disks_number())
+{ }
+
+dynamic_alloc_strategy::dynamic_alloc_strategy(
+    const std::string& name, size_t begin, size_t end)
+    : impl_(alloc_strategy_registry::get_instance()->create(name, begin, end))
+{ }
+
+} // namespace foxxll
+
+/**************************************************************************/
@@ -191,6 +191,48 @@ struct random_cyclic_flash : public random_cyclic
     }
 };
 
+//! Load-aware parallel disk block allocation scheme functor.
+//!
+//! Assigns blocks to disks in a weighted round-robin sequence, in which each
+//! disk's share is proportional to its free space times its throughput
+//! measured by its file_stats. Both are sampled when the functor is
+//! constructed, hence long-lived objects do not adapt to later changes.
+//! \remarks model of \b allocation_strategy concept
+struct load_aware : public striping
+{
+    //! weighted round-robin sequence of disks relative to begin_
+    std::vector<size_t> sequence_;
+
+    load_aware(size_t begin, size_t end) : striping(begin, end)
+    {
+        init();
+    }
+
+    load_aware() : striping()
+    {
+        init();
+    }
+
+    size_t operator () (size_t i) const
+    {
+        return begin_ + sequence_[i % sequence_.size()];
+    }
+
+    static const char * name()
+    {
+        return "load-aware striping";
+    }
+
+    //! Returns the weight of each disk in [begin, end): the free bytes (the
+    //! total bytes for autogrowing disks if larger) times the bytes per
+    //! second of past I/O. Disks without I/O are assumed to be as fast as
+    //! the average disk.
+    static std::vector<double> disk_weights(size_t begin, size_t end);
+
+private:
+    void init();
+};
+
 //! 'Single disk' parallel disk block allocation scheme functor.
 //! \remarks model of \b allocation_strategy concept
 struct single_disk
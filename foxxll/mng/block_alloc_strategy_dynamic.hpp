@@ -0,0 +1,198 @@
+/***************************************************************************
+ *  foxxll/mng/block_alloc_strategy_dynamic.hpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef FOXXLL_MNG_BLOCK_ALLOC_STRATEGY_DYNAMIC_HEADER
+#define FOXXLL_MNG_BLOCK_ALLOC_STRATEGY_DYNAMIC_HEADER
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <foxxll/mng/block_alloc_strategy.hpp>
+#include <foxxll/mng/block_alloc_strategy_interleaved.hpp>
+#include <foxxll/singleton.hpp>
+
+namespace foxxll {
+
+//! \addtogroup foxxll_alloc
+//! \{
+
+//! Interface of allocation strategies selected at runtime.
+class alloc_strategy_base
+{
+public:
+    virtual ~alloc_strategy_base() = default;
+
+    //! Returns the disk of the i-th block.
+    virtual size_t operator () (size_t i) const = 0;
+
+    //! Returns a copy of the strategy.
+    virtual alloc_strategy_base * clone() const = 0;
+
+    virtual const char * name() const = 0;
+};
+
+//! Wraps an allocation strategy functor as alloc_strategy_base.
+template <typename Strategy>
+class alloc_strategy_adapter final : public alloc_strategy_base
+{
+public:
+    explicit alloc_strategy_adapter(const Strategy& strategy)
+        : strategy_(strategy) { }
+
+    size_t operator () (size_t i) const final
+    {
+        return strategy_(i);
+    }
+
+    alloc_strategy_base * clone() const final
+    {
+        return new alloc_strategy_adapter(*this);
+    }
+
+    const char * name() const final
+    {
+        return strategy_.name();
+    }
+
+private:
+    Strategy strategy_;
+};
+
+/*!
+ * Registry of allocation strategies by name. The strategies of
+ * block_alloc_strategy.hpp are registered as striping, fully_random,
+ * simple_random, random_cyclic, random_cyclic_disk, random_cyclic_flash,
+ * single_disk and load_aware.
+ */
+class alloc_strategy_registry : public singleton<alloc_strategy_registry>
+{
+    friend class singleton<alloc_strategy_registry>;
+
+public:
+    //! creates a strategy for the disks [begin, end)
+    using factory_type =
+        std::function<alloc_strategy_base* (size_t begin, size_t end)>;
+
+    //! Registers a strategy, replacing one of the same name.
+    void add(const std::string& name, const factory_type& factory);
+
+    //! Registers an allocation strategy functor constructible from (begin,
+    //! end).
+    template <typename Strategy>
+    void add(const std::string& name)
+    {
+        add(name, [](size_t begin, size_t end) -> alloc_strategy_base* {
+                return new alloc_strategy_adapter<Strategy>(Strategy(begin, end));
+            });
+    }
+
+    //! Creates the strategy with the given name for the disks [begin, end).
+    //! Throws std::runtime_error if the name is unknown.
+    alloc_strategy_base * create(
+        const std::string& name, size_t begin, size_t end) const;
+
+    //! Returns whether a strategy of the given name is registered.
+    bool contains(const std::string& name) const;
+
+    //! Returns the names of all registered strategies.
+    std::vector<std::string> names() const;
+
+private:
+    //! registers the built-in strategies
+    alloc_strategy_registry();
+
+    mutable std::mutex mutex_;
+    std::map<std::string, factory_type> factories_;
+};
+
+//! Allocation strategy functor selected at runtime by name, which costs one
+//! virtual call per block. By default, the strategy named by
+//! config::alloc_strategy() is used, or random_cyclic if none is configured.
+//! \remarks model of \b allocation_strategy concept
+class dynamic_alloc_strategy
+{
+public:
+    //! configured strategy on all disks
+    dynamic_alloc_strategy();
+
+    //! configured strategy on disks [begin, end)
+    dynamic_alloc_strategy(size_t begin, size_t end);
+
+    //! named strategy on all disks
+    explicit dynamic_alloc_strategy(const std::string& name);
+
+    //! named strategy on disks [begin, end)
+    dynamic_alloc_strategy(const std::string& name, size_t begin, size_t end);
+
+    dynamic_alloc_strategy(const dynamic_alloc_strategy& other)
+        : impl_(other.impl_->clone()) { }
+
+    dynamic_alloc_strategy& operator = (const dynamic_alloc_strategy& other)
+    {
+        impl_.reset(other.impl_->clone());
+        return *this;
+    }
+
+    dynamic_alloc_strategy(dynamic_alloc_strategy&&) = default;
+    dynamic_alloc_strategy& operator = (dynamic_alloc_strategy&&) = default;
+
+    size_t operator () (size_t i) const
+    {
+        return (*impl_)(i);
+    }
+
+    const char * name() const
+    {
+        return impl_->name();
+    }
+
+    //! Returns the name of the configured strategy.
+    static std::string configured_name();
+
+private:
+    std::unique_ptr<alloc_strategy_base> impl_;
+};
+
+//! Interleaving of a dynamic_alloc_strategy: the j-th blocks of all runs are
+//! placed on the disk of the j-th block of the strategy.
+struct interleaved_dynamic
+{
+    int nruns_;
+    dynamic_alloc_strategy strategy_;
+
+    interleaved_dynamic(int nruns, const dynamic_alloc_strategy& strategy)
+        : nruns_(nruns), strategy_(strategy)
+    { }
+
+    size_t operator () (size_t i) const
+    {
+        return strategy_(i / nruns_);
+    }
+};
+
+template <>
+struct interleaved_alloc_traits<dynamic_alloc_strategy>
+{
+    using strategy = interleaved_dynamic;
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !FOXXLL_MNG_BLOCK_ALLOC_STRATEGY_DYNAMIC_HEADER
+
+/**************************************************************************/
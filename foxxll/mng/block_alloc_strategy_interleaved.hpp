@@ -102,6 +102,21 @@ struct interleaved_random_cyclic : public interleaved_striping
     }
 };
 
+struct interleaved_load_aware : public interleaved_striping
+{
+    std::vector<size_t> sequence_;
+
+    interleaved_load_aware(int nruns, const load_aware& strategy)
+        : interleaved_striping(nruns, strategy.begin_, strategy.diff_),
+          sequence_(strategy.sequence_)
+    { }
+
+    size_t operator () (size_t i) const
+    {
+        return begin_disk_ + sequence_[(i / nruns_) % sequence_.size()];
+    }
+};
+
 struct first_disk_only : public interleaved_striping
 {
     first_disk_only(int nruns, const single_disk& strategy)
@@ -156,6 +171,12 @@ struct interleaved_alloc_traits<random_cyclic_flash>
     using strategy = interleaved_random_cyclic;
 };
 
+template <>
+struct interleaved_alloc_traits<load_aware>
+{
+    using strategy = interleaved_load_aware;
+};
+
 template <>
 struct interleaved_alloc_traits<single_disk>
 {
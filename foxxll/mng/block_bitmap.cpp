@@ -0,0 +1,310 @@
+/***************************************************************************
+ *  foxxll/mng/block_bitmap.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+
+#include <tlx/math/clz.hpp>
+#include <tlx/math/ctz.hpp>
+#include <tlx/math/popcount.hpp>
+
+#include <foxxll/common/utils.hpp>
+#include <foxxll/mng/block_bitmap.hpp>
+
+namespace foxxll {
+
+//! mask of bits [begin, end) within a word, end <= 64
+static inline uint64_t bit_range_mask(size_t begin, size_t end)
+{
+    const uint64_t upper = (end == 64) ? ~uint64_t(0) : ((uint64_t(1) << end) - 1);
+    return upper & (~uint64_t(0) << begin);
+}
+
+void block_bitmap::grow(size_t new_size)
+{
+    if (new_size <= size_)
+        return;
+
+    if (levels_.empty())
+        levels_.emplace_back();
+
+    std::vector<word_type>& bits = levels_[0];
+    bits.resize(div_ceil(new_size, word_bits), 0);
+
+    for (size_t pos = size_; pos < new_size; )
+    {
+        const size_t word = pos / word_bits;
+        const size_t end = std::min(new_size, (word + 1) * word_bits);
+        bits[word] |= bit_range_mask(pos % word_bits, end - word * word_bits);
+        pos = end;
+    }
+
+    free_ += new_size - size_;
+    size_ = new_size;
+
+    rebuild_summary();
+}
+
+void block_bitmap::rebuild_summary()
+{
+    levels_.resize(1);
+
+    while (levels_.back().size() > 1)
+    {
+        const std::vector<word_type>& lower = levels_.back();
+        std::vector<word_type> upper(div_ceil(lower.size(), word_bits), 0);
+
+        for (size_t i = 0; i < lower.size(); ++i)
+        {
+            if (lower[i] != 0)
+                upper[i / word_bits] |= word_type(1) << (i % word_bits);
+        }
+
+        levels_.emplace_back(std::move(upper));
+    }
+}
+
+void block_bitmap::update_summary(size_t word)
+{
+    for (size_t level = 0; level + 1 < levels_.size(); ++level)
+    {
+        const bool nonzero = (levels_[level][word] != 0);
+        word_type& parent = levels_[level + 1][word / word_bits];
+        const word_type bit = word_type(1) << (word % word_bits);
+
+        // stop as soon as the parent bit does not change
+        if (((parent & bit) != 0) == nonzero)
+            return;
+
+        if (nonzero)
+            parent |= bit;
+        else
+            parent &= ~bit;
+
+        word /= word_bits;
+    }
+}
+
+size_t block_bitmap::find_next_set(size_t level, size_t pos) const
+{
+    const std::vector<word_type>& bits = levels_[level];
+
+    size_t word = pos / word_bits;
+    if (word >= bits.size())
+        return npos;
+
+    const word_type w = bits[word] & (~word_type(0) << (pos % word_bits));
+    if (w != 0)
+        return word * word_bits + tlx::ctz(w);
+
+    // use the summary level to skip over empty words
+    size_t next;
+    if (level + 1 < levels_.size())
+    {
+        next = find_next_set(level + 1, word + 1);
+        if (next == npos)
+            return npos;
+    }
+    else
+    {
+        next = word + 1;
+        while (next < bits.size() && bits[next] == 0)
+            ++next;
+        if (next >= bits.size())
+            return npos;
+    }
+
+    assert(bits[next] != 0);
+    return next * word_bits + tlx::ctz(bits[next]);
+}
+
+size_t block_bitmap::find_next_clear(size_t pos, size_t limit) const
+{
+    const std::vector<word_type>& bits = levels_[0];
+
+    while (pos < limit)
+    {
+        const size_t word = pos / word_bits;
+        const word_type w = ~bits[word] & (~word_type(0) << (pos % word_bits));
+        if (w != 0)
+            return std::min(limit, word * word_bits + tlx::ctz(w));
+        pos = (word + 1) * word_bits;
+    }
+
+    return limit;
+}
+
+size_t block_bitmap::find_prev(size_t pos, bool value) const
+{
+    const std::vector<word_type>& bits = levels_[0];
+
+    while (pos > 0)
+    {
+        const size_t word = (pos - 1) / word_bits;
+        const word_type w = (value ? bits[word] : ~bits[word]) &
+                            bit_range_mask(0, pos - word * word_bits);
+        if (w != 0)
+            return word * word_bits + (word_bits - 1) - tlx::clz(w);
+        pos = word * word_bits;
+    }
+
+    return npos;
+}
+
+size_t block_bitmap::allocate(size_t n)
+{
+    if (n == 0 || n > free_)
+        return npos;
+
+    size_t pos = find_next_set(0, 0);
+    while (pos != npos && pos + n <= size_)
+    {
+        const size_t end = find_next_clear(pos, pos + n);
+        if (end == pos + n) {
+            set_allocated(pos, n);
+            return pos;
+        }
+        pos = find_next_set(0, end);
+    }
+
+    return npos;
+}
+
+void block_bitmap::set_allocated(size_t pos, size_t n)
+{
+    assert(pos + n <= size_);
+    std::vector<word_type>& bits = levels_[0];
+
+    for (size_t end = pos + n; pos < end; )
+    {
+        const size_t word = pos / word_bits;
+        const size_t word_end = std::min(end, (word + 1) * word_bits);
+        const word_type mask =
+            bit_range_mask(pos % word_bits, word_end - word * word_bits);
+
+        assert((bits[word] & mask) == mask);
+        bits[word] &= ~mask;
+        update_summary(word);
+
+        pos = word_end;
+    }
+
+    free_ -= n;
+}
+
+bool block_bitmap::set_free(size_t pos, size_t n)
+{
+    if (pos + n > size_ || pos + n < pos)
+        return false;
+
+    std::vector<word_type>& bits = levels_[0];
+
+    // check all blocks first, such that a double free changes nothing
+    for (size_t p = pos, end = pos + n; p < end; )
+    {
+        const size_t word = p / word_bits;
+        const size_t word_end = std::min(end, (word + 1) * word_bits);
+        if (bits[word] & bit_range_mask(p % word_bits, word_end - word * word_bits))
+            return false;
+        p = word_end;
+    }
+
+    for (size_t p = pos, end = pos + n; p < end; )
+    {
+        const size_t word = p / word_bits;
+        const size_t word_end = std::min(end, (word + 1) * word_bits);
+        bits[word] |= bit_range_mask(p % word_bits, word_end - word * word_bits);
+        update_summary(word);
+        p = word_end;
+    }
+
+    free_ += n;
+    return true;
+}
+
+bool block_bitmap::is_free(size_t pos) const
+{
+    assert(pos < size_);
+    return (levels_[0][pos / word_bits] >> (pos % word_bits)) & 1;
+}
+
+size_t block_bitmap::free_run_count() const
+{
+    if (levels_.empty())
+        return 0;
+
+    // count the first bits of runs: set bits whose predecessor is clear
+    size_t runs = 0;
+    word_type carry = 0;
+    for (const word_type& w : levels_[0])
+    {
+        runs += tlx::popcount(w & ~((w << 1) | carry));
+        carry = w >> (word_bits - 1);
+    }
+    return runs;
+}
+
+size_t block_bitmap::longest_free_run() const
+{
+    if (levels_.empty())
+        return 0;
+
+    size_t longest = 0;
+    size_t pos = find_next_set(0, 0);
+    while (pos != npos)
+    {
+        const size_t end = find_next_clear(pos, size_);
+        longest = std::max(longest, end - pos);
+        pos = find_next_set(0, end);
+    }
+    return longest;
+}
+
+size_t block_bitmap::free_tail() const
+{
+    if (size_ == 0)
+        return 0;
+
+    const size_t last = find_prev(size_, false);
+    return (last == npos) ? size_ : size_ - last - 1;
+}
+
+size_t block_bitmap::prev_free(size_t pos) const
+{
+    if (size_ == 0)
+        return npos;
+    return find_prev(std::min(pos, size_), true);
+}
+
+void block_bitmap::shrink(size_t new_size)
+{
+    if (new_size >= size_)
+        return;
+
+    assert(free_tail() >= size_ - new_size);
+
+    std::vector<word_type>& bits = levels_[0];
+    bits.resize(div_ceil(new_size, word_bits));
+
+    // keep the bits beyond the end zero
+    if (new_size % word_bits != 0)
+        bits.back() &= bit_range_mask(0, new_size % word_bits);
+
+    free_ -= size_ - new_size;
+    size_ = new_size;
+
+    rebuild_summary();
+}
+
+} // namespace foxxll
+
+/**************************************************************************/
@@ -0,0 +1,112 @@
+/***************************************************************************
+ *  foxxll/mng/block_bitmap.hpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef FOXXLL_MNG_BLOCK_BITMAP_HEADER
+#define FOXXLL_MNG_BLOCK_BITMAP_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace foxxll {
+
+//! \ingroup foxxll_mnglayer
+//! \{
+
+/*!
+ * Hierarchical bitmap of free blocks of equal size, used by
+ * disk_block_allocator for disks configured with a fixed block size.
+ *
+ * Level 0 holds one bit per block, which is set if the block is free. Each
+ * higher level holds one bit per word of the level below, which is set if
+ * that word has any bit set. The top level is a single word, so finding the
+ * next free block takes O(log_64 n) word operations with count trailing zeros.
+ */
+class block_bitmap
+{
+public:
+    //! returned if no suitable run of blocks is found
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    //! number of blocks managed
+    size_t size() const { return size_; }
+
+    //! number of free blocks
+    size_t free_count() const { return free_; }
+
+    //! Appends free blocks up to new_size blocks.
+    void grow(size_t new_size);
+
+    //! Finds a run of n contiguous free blocks with the lowest position,
+    //! marks it as allocated and returns its position, or npos.
+    size_t allocate(size_t n);
+
+    //! Marks a run of n blocks at pos as allocated, they must be free.
+    void set_allocated(size_t pos, size_t n);
+
+    //! Marks a run of n blocks at pos as free. Returns false without
+    //! changing anything if any of them is already free (double free) or
+    //! the run exceeds the bitmap.
+    bool set_free(size_t pos, size_t n);
+
+    //! Returns whether the block at pos is free.
+    bool is_free(size_t pos) const;
+
+    //! Returns the number of maximal runs of free blocks, O(n / 64).
+    size_t free_run_count() const;
+
+    //! Returns the length of the longest run of free blocks.
+    size_t longest_free_run() const;
+
+    //! Returns the number of free blocks at the end.
+    size_t free_tail() const;
+
+    //! Returns the position of the last free block before pos, or npos.
+    size_t prev_free(size_t pos) const;
+
+    //! Removes all blocks from new_size on, which must be free.
+    void shrink(size_t new_size);
+
+private:
+    using word_type = uint64_t;
+    static constexpr size_t word_bits = 64;
+
+    //! levels_[0] has one bit per block, levels_[i + 1] one bit per word
+    //! of levels_[i]. Bits beyond the end are always zero.
+    std::vector<std::vector<word_type> > levels_;
+
+    size_t size_ = 0;
+    size_t free_ = 0;
+
+    //! first set bit at or after pos on the given level, or npos
+    size_t find_next_set(size_t level, size_t pos) const;
+
+    //! first clear bit on level 0 in [pos, limit), or limit
+    size_t find_next_clear(size_t pos, size_t limit) const;
+
+    //! last bit on level 0 before pos which equals value, or npos
+    size_t find_prev(size_t pos, bool value) const;
+
+    //! propagate a changed word of level 0 to the upper levels
+    void update_summary(size_t word);
+
+    //! rebuild all upper levels from level 0
+    void rebuild_summary();
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !FOXXLL_MNG_BLOCK_BITMAP_HEADER
+
+/**************************************************************************/
@@ -0,0 +1,116 @@
+/***************************************************************************
+ *  foxxll/mng/block_extent_allocator.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+
+#include <tlx/logger.hpp>
+
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/common/exceptions.hpp>
+#include <foxxll/mng/block_extent_allocator.hpp>
+
+namespace foxxll {
+
+block_extent_allocator::block_extent_allocator(
+    uint64_t extent_size, block_manager* bm)
+    : bm_(bm),
+      extent_size_(extent_size),
+      extents_(bm->ndisks_)
+{ }
+
+block_extent_allocator::~block_extent_allocator()
+{
+    release();
+}
+
+file* block_extent_allocator::carve(size_t disk, uint64_t size, uint64_t& offset)
+{
+    assert(disk < extents_.size());
+    disk_block_allocator* alloc = bm_->block_allocators_[disk];
+
+    if (alloc->block_size() != 0 && size != alloc->block_size()) {
+        FOXXLL_THROW(
+            bad_ext_alloc,
+            "Block of " << size << " bytes requested on a disk "
+            "configured for block_size=" << alloc->block_size()
+        );
+    }
+
+    extent& ext = extents_[disk];
+
+    if (ext.size < size)
+    {
+        release(disk);
+
+        // halve the extent until a contiguous free region is found
+        uint64_t bytes = std::max(extent_size_, size);
+        uint64_t pos;
+        while (!alloc->reserve_extent(bytes, pos))
+        {
+            if (bytes <= size) {
+                FOXXLL_THROW(
+                    bad_ext_alloc,
+                    "Out of external memory error: no contiguous region of "
+                        << size << " bytes free on disk " << disk << ". "
+                        "Maybe enable autogrow_ flags?"
+                );
+            }
+            bytes = std::max(bytes / 2, size);
+        }
+
+        TLX_LOG << "block_extent_allocator: reserved " << bytes
+                << " bytes at " << pos << " on disk " << disk;
+
+        ext.begin = ext.offset = pos;
+        ext.size = bytes;
+        ext.reserved = true;
+    }
+
+    offset = ext.offset;
+    ext.offset += size;
+    ext.size -= size;
+
+    alloc->count_carved_block();
+    bm_->add_allocation(size);
+
+    return bm_->disk_files_[disk].get();
+}
+
+void block_extent_allocator::release(size_t disk)
+{
+    extent& ext = extents_[disk];
+    if (!ext.reserved)
+        return;
+
+    bm_->block_allocators_[disk]->release_extent(ext.begin, ext.offset, ext.size);
+
+    ext = extent();
+}
+
+void block_extent_allocator::release()
+{
+    for (size_t d = 0; d < extents_.size(); ++d)
+        release(d);
+}
+
+uint64_t block_extent_allocator::reserved_bytes() const
+{
+    uint64_t bytes = 0;
+    for (const extent& ext : extents_)
+        bytes += ext.size;
+    return bytes;
+}
+
+} // namespace foxxll
+
+/**************************************************************************/
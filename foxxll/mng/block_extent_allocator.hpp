@@ -0,0 +1,137 @@
+/***************************************************************************
+ *  foxxll/mng/block_extent_allocator.hpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef FOXXLL_MNG_BLOCK_EXTENT_ALLOCATOR_HEADER
+#define FOXXLL_MNG_BLOCK_EXTENT_ALLOCATOR_HEADER
+
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include <foxxll/mng/bid.hpp>
+#include <foxxll/mng/block_manager.hpp>
+
+namespace foxxll {
+
+//! \addtogroup foxxll_mnglayer
+//! \{
+
+/*!
+ * Allocates the blocks of a sequential stream from contiguous extents.
+ *
+ * block_manager::new_blocks takes every batch of blocks from the free space
+ * of the disks anew, hence the blocks a stream writes to one disk over time
+ * are scattered. This allocator instead reserves a contiguous extent of
+ * extent_size bytes per disk on first use, and carves the blocks assigned
+ * to that disk from it in order. Each disk's share of the stream is thus
+ * physically sequential, which makes readahead and request merging effective.
+ *
+ * The blocks are ordinary managed blocks and are freed individually with
+ * block_manager::delete_blocks. The unused tails of the extents are returned
+ * by release() or on destruction. If a disk has no free region of
+ * extent_size bytes, smaller extents are tried, down to a single block.
+ *
+ * An instance is meant for one writer and is not thread-safe.
+ */
+class block_extent_allocator
+{
+    static constexpr bool debug = false;
+
+public:
+    //! default size of the extents reserved per disk
+    static constexpr uint64_t default_extent_size = 64 * 1024 * 1024;
+
+    explicit block_extent_allocator(
+        uint64_t extent_size = default_extent_size,
+        block_manager* bm = block_manager::get_instance());
+
+    //! non-copyable: delete copy-constructor
+    block_extent_allocator(const block_extent_allocator&) = delete;
+    //! non-copyable: delete assignment operator
+    block_extent_allocator& operator = (const block_extent_allocator&) = delete;
+
+    //! returns the unused tails of the extents
+    ~block_extent_allocator();
+
+    /*!
+     * Allocates new blocks like block_manager::new_blocks, carving them from
+     * the extents of the disks chosen by \b functor.
+     *
+     * \param functor object of model of \b allocation_strategy concept
+     * \param bid_begin forward BID iterator object
+     * \param bid_end forward BID iterator object
+     * \param alloc_offset advance for \b functor to line up partial allocations
+     */
+    template <typename DiskAssignFunctor, typename BIDIterator>
+    void new_blocks(
+        const DiskAssignFunctor& functor,
+        BIDIterator bid_begin, BIDIterator bid_end,
+        size_t alloc_offset = 0)
+    {
+        for (size_t i = 0; bid_begin != bid_end; ++bid_begin, ++i)
+        {
+            const size_t disk = functor(alloc_offset + i);
+            bid_begin->storage = carve(disk, bid_begin->size, bid_begin->offset);
+        }
+    }
+
+    //! Allocates a new block, see new_blocks().
+    template <typename DiskAssignFunctor, size_t BlockSize>
+    void new_block(const DiskAssignFunctor& functor,
+                   BID<BlockSize>& bid, size_t alloc_offset = 0)
+    {
+        new_blocks(functor, &bid, std::next(&bid, 1), alloc_offset);
+    }
+
+    //! Returns the unused tails of all extents to the disks. Later
+    //! allocations reserve new extents.
+    void release();
+
+    //! size of the extents reserved per disk
+    uint64_t extent_size() const { return extent_size_; }
+
+    //! number of reserved bytes not yet carved into blocks
+    uint64_t reserved_bytes() const;
+
+private:
+    //! unused remainder of the extent reserved on a disk
+    struct extent
+    {
+        //! start of the extent, valid if reserved
+        uint64_t begin = 0;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        bool reserved = false;
+    };
+
+    block_manager* bm_;
+
+    uint64_t extent_size_;
+
+    //! one extent per disk
+    std::vector<extent> extents_;
+
+    //! take size bytes from the disk's extent, reserving a new one if needed.
+    //! Stores the offset and returns the disk's file.
+    file* carve(size_t disk, uint64_t size, uint64_t& offset);
+
+    //! return the unused tail of the disk's extent
+    void release(size_t disk);
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !FOXXLL_MNG_BLOCK_EXTENT_ALLOCATOR_HEADER
+
+/**************************************************************************/
@@ -12,17 +12,29 @@
  *  http://www.boost.org/LICENSE_1_0.txt)
  **************************************************************************/
 
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cerrno>
 #include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <tlx/logger/core.hpp>
 
 #include <foxxll/mng/block_manager.hpp>
 
+#include <foxxll/common/timer.hpp>
 #include <foxxll/common/types.hpp>
 #include <foxxll/io/create_file.hpp>
 #include <foxxll/io/disk_queues.hpp>
 #include <foxxll/io/file.hpp>
+#include <foxxll/io/metrics_exporter.hpp>
+#include <foxxll/io/ufs_platform.hpp>
 #include <foxxll/mng/config.hpp>
 #include <foxxll/mng/disk_block_allocator.hpp>
 
@@ -41,6 +53,7 @@ block_manager::block_manager()
     ndisks_ = config->disks_number();
     block_allocators_.resize(ndisks_);
     disk_files_.resize(ndisks_);
+    metadata_.resize(ndisks_);
 
     uint64_t total_size = 0;
 
@@ -74,8 +87,11 @@ block_manager::block_manager()
         disk_queues::get_instance()->make_queue(disk_files_[i].get());
 
         block_allocators_[i] = new disk_block_allocator(disk_files_[i].get(), cfg);
+        metadata_[i] = cfg.metadata;
     }
 
+    restore_metadata();
+
     if (ndisks_ > 1)
     {
         TLX_LOG1 << "In total " << ndisks_ << " disks are allocated, space: "
@@ -86,6 +102,14 @@ block_manager::block_manager()
 block_manager::~block_manager()
 {
     TLX_LOG << "Block manager destructor";
+
+    try {
+        checkpoint();
+    }
+    catch (std::exception& e) {
+        TLX_LOG1 << "Error saving block metadata: " << e.what();
+    }
+
     for (size_t i = ndisks_; i > 0; )
     {
         --i;
@@ -94,10 +118,347 @@ block_manager::~block_manager()
     }
 }
 
-uint64_t block_manager::total_bytes() const
+/******************************************************************************/
+// Persistent Blocks
+
+//! A metadata file lists the blocks stored by name on one disk:
+//!
+//!   foxxll_metadata 1
+//!   disk_bytes <file size>
+//!   blocks <name> <total number of blocks> <number on this disk>
+//!   <index> <offset> <size>
+//!   ...
+//!   end
+static const char* metadata_magic = "foxxll_metadata";
+static const int metadata_version = 1;
+
+//! blocks of one name read from the metadata files: total number and
+//! (index, block) pairs
+using saved_blocks_type =
+    std::map<std::string, std::pair<size_t, std::vector<std::pair<size_t, BID<0> > > > >;
+
+#if !FOXXLL_WINDOWS
+//! flush a file or directory to stable storage, throws io_error on failure
+static void fsync_path(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        FOXXLL_THROW_ERRNO(io_error, "open() path=" << path);
+
+    if (::fsync(fd) != 0) {
+        const int err = errno;
+        ::close(fd);
+        errno = err;
+        FOXXLL_THROW_ERRNO(io_error, "fsync() path=" << path);
+    }
+    ::close(fd);
+}
+#endif
+
+static void read_metadata(
+    const std::string& path, file* storage,
+    uint64_t& disk_bytes, saved_blocks_type& saved)
+{
+    std::ifstream in(path);
+    if (!in.good()) {
+        TLX_LOG1 << "Metadata file '" << path << "' not found, disk starts empty.";
+        return;
+    }
+
+    std::string token;
+    int version = 0;
+    in >> token >> version;
+    if (token != metadata_magic || version != metadata_version) {
+        FOXXLL_THROW2(io_error, "block_manager::restore_metadata",
+                      "'" << path << "' is not a foxxll metadata file");
+    }
+
+    in >> token >> disk_bytes;
+    if (token != "disk_bytes") in.setstate(std::ios::failbit);
+
+    while (in >> token && token == "blocks")
+    {
+        std::string name;
+        size_t count, local;
+        in >> name >> count >> local;
+
+        auto& entry = saved[name];
+        entry.first = count;
+
+        for (size_t i = 0; i < local && in; ++i)
+        {
+            size_t index, size;
+            uint64_t offset;
+            in >> index >> offset >> size;
+            entry.second.emplace_back(index, BID<0>(storage, offset, size));
+        }
+    }
+
+    if (!in || token != "end") {
+        FOXXLL_THROW2(io_error, "block_manager::restore_metadata",
+                      "metadata file '" << path << "' is corrupt");
+    }
+}
+
+void block_manager::restore_metadata()
+{
+    saved_blocks_type saved;
+    std::vector<uint64_t> disk_bytes(ndisks_, 0);
+
+    for (size_t d = 0; d < ndisks_; ++d)
+    {
+        if (!metadata_[d].empty())
+            read_metadata(metadata_[d], disk_files_[d].get(), disk_bytes[d], saved);
+    }
+
+    // reattach names of which all blocks were found
+    std::vector<std::vector<disk_block_allocator::place> > allocated(ndisks_);
+    uint64_t restored_bytes = 0;
+
+    for (auto& name : saved)
+    {
+        auto& blocks = name.second.second;
+        std::sort(blocks.begin(), blocks.end(),
+                  [](const std::pair<size_t, BID<0> >& a,
+                     const std::pair<size_t, BID<0> >& b) {
+                      return a.first < b.first;
+                  });
+
+        bool complete = (blocks.size() == name.second.first);
+        for (size_t i = 0; complete && i < blocks.size(); ++i)
+            complete = (blocks[i].first == i);
+
+        if (!complete) {
+            TLX_LOG1 << "Blocks '" << name.first << "' are incomplete in the "
+                "metadata files, they are dropped.";
+            continue;
+        }
+
+        std::vector<BID<0> >& bids = named_blocks_[name.first];
+        for (const auto& block : blocks)
+        {
+            const BID<0>& bid = block.second;
+            const size_t disk = static_cast<size_t>(bid.storage->get_allocator_id());
+            allocated[disk].emplace_back(
+                bid.offset, static_cast<uint64_t>(bid.size));
+            named_index_[std::make_pair(disk, bid.offset)] = name.first;
+            restored_bytes += bid.size;
+            bids.push_back(bid);
+        }
+    }
+    has_named_ = !named_blocks_.empty();
+
+    for (size_t d = 0; d < ndisks_; ++d)
+    {
+        if (!metadata_[d].empty())
+            block_allocators_[d]->restore(disk_bytes[d], allocated[d]);
+    }
+
+    if (!named_blocks_.empty()) {
+        TLX_LOG1 << "Reattached " << named_blocks_.size() << " stored block "
+            "sets, " << restored_bytes << " bytes.";
+    }
+
+    add_allocation(restored_bytes);
+}
+
+void block_manager::checkpoint()
+{
+    std::unique_lock<std::mutex> lock(named_mutex_);
+
+    for (size_t d = 0; d < ndisks_; ++d)
+    {
+        if (metadata_[d].empty())
+            continue;
+
+        // the blocks must be durable before the checkpoint refers to them
+        disk_files_[d]->sync();
+
+        // write a new file and atomically replace the previous checkpoint
+        const std::string tmp_path = metadata_[d] + ".tmp";
+        {
+            std::ofstream out(tmp_path, std::ios::trunc);
+
+            out << metadata_magic << ' ' << metadata_version << '\n'
+                << "disk_bytes " << block_allocators_[d]->total_bytes() << '\n';
+
+            std::vector<size_t> local;
+            for (const auto& name : named_blocks_)
+            {
+                const std::vector<BID<0> >& bids = name.second;
+
+                local.clear();
+                for (size_t i = 0; i < bids.size(); ++i) {
+                    if (bids[i].storage == disk_files_[d].get())
+                        local.push_back(i);
+                }
+                if (local.empty())
+                    continue;
+
+                out << "blocks " << name.first << ' ' << bids.size() << ' '
+                    << local.size() << '\n';
+                for (const size_t& i : local)
+                    out << i << ' ' << bids[i].offset << ' ' << bids[i].size << '\n';
+            }
+
+            out << "end\n";
+            out.flush();
+
+            if (!out.good()) {
+                FOXXLL_THROW2(io_error, "block_manager::checkpoint",
+                              "writing '" << tmp_path << "' failed");
+            }
+        }
+
+#if !FOXXLL_WINDOWS
+        // make the new checkpoint durable before it replaces the old one
+        fsync_path(tmp_path);
+#else
+        std::remove(metadata_[d].c_str());
+#endif
+
+        if (std::rename(tmp_path.c_str(), metadata_[d].c_str()) != 0) {
+            FOXXLL_THROW_ERRNO(io_error, "renaming '" << tmp_path << "' to '"
+                               << metadata_[d] << "'");
+        }
+
+#if !FOXXLL_WINDOWS
+        // and the rename durable in the directory
+        const std::string::size_type slash = metadata_[d].rfind('/');
+        fsync_path(slash == std::string::npos ? std::string(".")
+                   : slash == 0 ? std::string("/")
+                   : metadata_[d].substr(0, slash));
+#endif
+    }
+}
+
+void block_manager::set_named_blocks(
+    const std::string& name, std::vector<BID<0> >&& bids)
+{
+    if (name.empty() ||
+        std::any_of(name.begin(), name.end(),
+                    [](char c) { return std::isspace(static_cast<unsigned char>(c)); }))
+    {
+        FOXXLL_THROW(bad_parameter,
+                     "Invalid name '" << name << "' for stored blocks.");
+    }
+
+    // blocks on disks without metadata would be dropped at the restart
+    std::vector<std::pair<size_t, uint64_t> > keys;
+    keys.reserve(bids.size());
+    for (const BID<0>& bid : bids)
+    {
+        const int disk = bid.storage ? bid.storage->get_allocator_id() : -1;
+        if (disk < 0 || static_cast<size_t>(disk) >= ndisks_ ||
+            metadata_[static_cast<size_t>(disk)].empty())
+        {
+            FOXXLL_THROW(bad_parameter,
+                         "Blocks '" << name << "' are not on a disk with a "
+                         "metadata file, they could not be saved.");
+        }
+        keys.emplace_back(static_cast<size_t>(disk), bid.offset);
+    }
+
+    // blocks stored twice would fail the restore of the allocator
+    std::sort(keys.begin(), keys.end());
+    if (std::adjacent_find(keys.begin(), keys.end()) != keys.end()) {
+        FOXXLL_THROW(bad_parameter,
+                     "Blocks '" << name << "' contain a block twice.");
+    }
+
+    std::unique_lock<std::mutex> lock(named_mutex_);
+
+    for (const std::pair<size_t, uint64_t>& key : keys)
+    {
+        auto it = named_index_.find(key);
+        if (it != named_index_.end() && it->second != name) {
+            FOXXLL_THROW(bad_parameter,
+                         "A block of '" << name << "' at " << key.second <<
+                         " is stored under '" << it->second << "' already.");
+        }
+    }
+
+    auto it = named_blocks_.find(name);
+    if (it != named_blocks_.end())
+        erase_named_blocks(it);
+
+    for (const std::pair<size_t, uint64_t>& key : keys)
+        named_index_[key] = name;
+    named_blocks_[name] = std::move(bids);
+    has_named_ = true;
+}
+
+void block_manager::erase_named_blocks(
+    std::map<std::string, std::vector<BID<0> > >::iterator it)
 {
-    std::unique_lock<std::mutex> lock(mutex_);
+    for (const BID<0>& bid : it->second) {
+        named_index_.erase(std::make_pair(
+                               static_cast<size_t>(bid.storage->get_allocator_id()),
+                               bid.offset));
+    }
+    named_blocks_.erase(it);
+    has_named_ = !named_blocks_.empty();
+}
 
+void block_manager::forget_named_blocks(
+    size_t disk, const std::vector<disk_block_allocator::place>& regions)
+{
+    std::unique_lock<std::mutex> lock(named_mutex_);
+
+    for (const disk_block_allocator::place& region : regions)
+    {
+        // stored blocks within the freed region
+        auto it = named_index_.lower_bound(std::make_pair(disk, region.first));
+        while (it != named_index_.end() && it->first.first == disk &&
+               it->first.second < region.first + region.second)
+        {
+            const std::string name = it->second;
+            TLX_LOG1 << "A block of '" << name << "' was freed, the name of "
+                "the stored blocks is dropped.";
+
+            erase_named_blocks(named_blocks_.find(name));
+            it = named_index_.lower_bound(std::make_pair(disk, region.first));
+        }
+    }
+}
+
+bool block_manager::get_named_blocks(
+    const std::string& name, std::vector<BID<0> >& bids) const
+{
+    std::unique_lock<std::mutex> lock(named_mutex_);
+
+    auto it = named_blocks_.find(name);
+    if (it == named_blocks_.end())
+        return false;
+
+    bids = it->second;
+    return true;
+}
+
+void block_manager::erase_blocks(const std::string& name)
+{
+    std::unique_lock<std::mutex> lock(named_mutex_);
+
+    auto it = named_blocks_.find(name);
+    if (it != named_blocks_.end())
+        erase_named_blocks(it);
+}
+
+std::vector<std::string> block_manager::stored_names() const
+{
+    std::unique_lock<std::mutex> lock(named_mutex_);
+
+    std::vector<std::string> names;
+    for (const auto& name : named_blocks_)
+        names.push_back(name.first);
+    return names;
+}
+
+/******************************************************************************/
+// Statistics
+
+uint64_t block_manager::total_bytes() const
+{
     uint64_t total = 0;
 
     for (size_t i = 0; i < ndisks_; ++i)
@@ -108,8 +469,6 @@ uint64_t block_manager::total_bytes() const
 
 uint64_t block_manager::free_bytes() const
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-
     uint64_t total = 0;
 
     for (size_t i = 0; i < ndisks_; ++i)
@@ -118,22 +477,162 @@ uint64_t block_manager::free_bytes() const
     return total;
 }
 
+uint64_t block_manager::total_bytes(size_t disk) const
+{
+    assert(disk < ndisks_);
+    return block_allocators_[disk]->total_bytes();
+}
+
+uint64_t block_manager::free_bytes(size_t disk) const
+{
+    assert(disk < ndisks_);
+    return block_allocators_[disk]->free_bytes();
+}
+
+uint64_t block_manager::compact(
+    size_t disk, uint64_t max_bytes,
+    const disk_block_allocator::relocate_function& relocate)
+{
+    assert(disk < ndisks_);
+    return block_allocators_[disk]->compact(max_bytes, relocate);
+}
+
+file_stats* block_manager::disk_file_stats(size_t disk) const
+{
+    assert(disk < ndisks_);
+    return disk_files_[disk]->get_file_stats();
+}
+
 uint64_t block_manager::total_allocation() const
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-    return total_allocation_;
+    return total_allocation_.load(std::memory_order_relaxed);
 }
 
 uint64_t block_manager::current_allocation() const
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-    return current_allocation_;
+    return current_allocation_.load(std::memory_order_relaxed);
 }
 
 uint64_t block_manager::maximum_allocation() const
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-    return maximum_allocation_;
+    return maximum_allocation_.load(std::memory_order_relaxed);
+}
+
+disk_allocation_stats_data block_manager::allocation_stats(size_t disk) const
+{
+    assert(disk < ndisks_);
+    return block_allocators_[disk]->allocation_stats();
+}
+
+std::vector<disk_allocation_stats_data> block_manager::allocation_stats() const
+{
+    std::vector<disk_allocation_stats_data> list;
+    list.reserve(ndisks_);
+    for (size_t i = 0; i < ndisks_; ++i)
+        list.push_back(block_allocators_[i]->allocation_stats());
+    return list;
+}
+
+void block_manager::add_metrics_source(metrics_exporter& exporter)
+{
+    //! snapshots of the previous sample, for the rates of the interval
+    struct state_type
+    {
+        std::vector<disk_allocation_stats_data> prev;
+        double prev_time = timestamp();
+    };
+    std::shared_ptr<state_type> state = std::make_shared<state_type>();
+
+    exporter.add_source(
+        [this, state](metrics_sample& s) {
+            using labels_type = metrics_sample::labels_type;
+            const metrics_sample::metric_type counter = metrics_sample::COUNTER;
+            const metrics_sample::metric_type gauge = metrics_sample::GAUGE;
+
+            const double now = timestamp();
+            const double interval = now - state->prev_time;
+
+            s.add("foxxll_allocated_bytes", gauge,
+                  "Bytes currently allocated by the block manager.",
+                  static_cast<double>(current_allocation()));
+            s.add("foxxll_max_allocated_bytes", gauge,
+                  "Maximum number of bytes allocated by the block manager.",
+                  static_cast<double>(maximum_allocation()));
+            s.add("foxxll_requested_allocation_bytes_total", counter,
+                  "Bytes requested from the block manager.",
+                  static_cast<double>(total_allocation()));
+
+            // per disk: allocations and free space
+            std::vector<disk_allocation_stats_data> disks = allocation_stats();
+
+            for (size_t i = 0; i < disks.size(); ++i)
+            {
+                const disk_allocation_stats_data& c = disks[i];
+                const disk_allocation_stats_data d =
+                    i < state->prev.size() ? c - state->prev[i] : c;
+                const labels_type labels { { "disk", std::to_string(i) } };
+
+                s.add("foxxll_disk_total_bytes", gauge,
+                      "Size of the disk.", static_cast<double>(c.get_total_bytes()),
+                      labels);
+                s.add("foxxll_disk_free_bytes", gauge,
+                      "Free bytes of the disk.", static_cast<double>(c.get_free_bytes()),
+                      labels);
+                s.add("foxxll_disk_free_regions", gauge,
+                      "Number of free regions of the disk.", c.get_free_regions(),
+                      labels);
+                s.add("foxxll_disk_largest_free_region_bytes", gauge,
+                      "Size of the largest free region of the disk.",
+                      static_cast<double>(c.get_largest_free_region()), labels);
+                s.add("foxxll_disk_fragmentation_ratio", gauge,
+                      "Fraction of the free space outside the largest free region.",
+                      c.get_fragmentation(), labels);
+
+                s.add("foxxll_disk_alloc_blocks_total", counter,
+                      "Blocks allocated on the disk.",
+                      static_cast<double>(c.get_alloc_blocks()), labels);
+                s.add("foxxll_disk_alloc_bytes_total", counter,
+                      "Bytes allocated on the disk.",
+                      static_cast<double>(c.get_alloc_bytes()), labels);
+                s.add("foxxll_disk_freed_blocks_total", counter,
+                      "Blocks freed on the disk.",
+                      static_cast<double>(c.get_freed_blocks()), labels);
+                s.add("foxxll_disk_freed_bytes_total", counter,
+                      "Bytes freed on the disk.",
+                      static_cast<double>(c.get_freed_bytes()), labels);
+                s.add("foxxll_disk_alloc_lock_wait_seconds_total", counter,
+                      "Seconds allocations waited for the lock of the disk's allocator.",
+                      c.get_lock_wait_time(), labels);
+                s.add("foxxll_disk_alloc_lock_hold_seconds_total", counter,
+                      "Seconds allocations held the lock of the disk's allocator.",
+                      c.get_lock_hold_time(), labels);
+                s.add("foxxll_disk_grow_total", counter,
+                      "Number of times allocations grew the disk's file.",
+                      static_cast<double>(c.get_grow_count()), labels);
+                s.add("foxxll_disk_grow_bytes_total", counter,
+                      "Bytes by which allocations grew the disk's file.",
+                      static_cast<double>(c.get_grow_bytes()), labels);
+                s.add("foxxll_disk_alloc_split_total", counter,
+                      "Allocations split for lack of a contiguous free region.",
+                      static_cast<double>(c.get_split_count()), labels);
+
+                s.add("foxxll_disk_alloc_blocks_per_second", gauge,
+                      "Blocks allocated per second in the interval.",
+                      d.get_alloc_rate(interval), labels);
+                s.add("foxxll_disk_freed_blocks_per_second", gauge,
+                      "Blocks freed per second in the interval.",
+                      d.get_free_rate(interval), labels);
+                s.add("foxxll_disk_alloc_bytes_per_second", gauge,
+                      "Bytes allocated per second in the interval.",
+                      static_cast<double>(d.get_alloc_bytes()) / interval, labels);
+                s.add("foxxll_disk_freed_bytes_per_second", gauge,
+                      "Bytes freed per second in the interval.",
+                      static_cast<double>(d.get_freed_bytes()) / interval, labels);
+            }
+
+            state->prev = std::move(disks);
+            state->prev_time = now;
+        });
 }
 
 } // namespace foxxll
@@ -16,13 +16,18 @@
 #define FOXXLL_MNG_BLOCK_MANAGER_HEADER
 
 #include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <iterator>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/common/exceptions.hpp>
 #include <foxxll/common/utils.hpp>
 #include <foxxll/config.hpp>
 #include <foxxll/defines.hpp>
@@ -32,6 +37,7 @@
 #include <foxxll/mng/bid.hpp>
 #include <foxxll/mng/block_alloc_strategy.hpp>
 #include <foxxll/mng/config.hpp>
+#include <foxxll/mng/disk_allocation_stats.hpp>
 #include <foxxll/mng/disk_block_allocator.hpp>
 #include <foxxll/singleton.hpp>
 #include <tlx/simple_vector.hpp>
@@ -42,6 +48,8 @@
 
 namespace foxxll {
 
+class metrics_exporter;
+
 //! \addtogroup foxxll_mnglayer
 //! \{
 
@@ -50,6 +58,10 @@ namespace foxxll {
  *
  * Manages allocation and deallocation of blocks in multiple/single disk setting
  * \remarks is a singleton
+ *
+ * The block manager itself holds no lock: each disk_block_allocator locks
+ * independently, hence threads allocating on different disks do not
+ * contend, and the statistics counters are atomic.
  */
 class block_manager : public singleton<block_manager>
 {
@@ -96,7 +108,9 @@ public:
 
     //! Deallocates blocks.
     //!
-    //! Deallocates blocks in the range [ \b bid_begin, \b bid_end)
+    //! Deallocates blocks in the range [ \b bid_begin, \b bid_end). The
+    //! blocks are grouped by disk and each group is freed with one lock
+    //! acquisition and one discard per contiguous region.
     //! \param bid_begin iterator object of \b bid_iterator concept
     //! \param bid_end iterator object of \b bid_iterator concept
     template <typename BIDIterator>
@@ -108,6 +122,77 @@ public:
     template <size_t BlockSize>
     void delete_block(const BID<BlockSize>& bid);
 
+    //! Moves at most max_bytes of blocks from the end of an autogrown disk
+    //! file to free space in front using \b relocate, and truncates the file,
+    //! see disk_block_allocator::compact. Returns the number of bytes moved.
+    uint64_t compact(size_t disk, uint64_t max_bytes,
+                     const disk_block_allocator::relocate_function& relocate);
+
+    //! \name Persistent Blocks
+    //!
+    //! Blocks stored under a name are saved by checkpoint() to the metadata
+    //! files of disks configured with metadata=<path>, and reattached by name
+    //! when the block_manager is constructed in a later run. All other space
+    //! of these disks is free after the restart. A checkpoint is written to
+    //! a temporary file which then replaces the previous one, hence a crash
+    //! leaves the last complete checkpoint. Freeing a stored block drops the
+    //! name of all blocks stored with it.
+    //! \{
+
+    //! Stores the blocks [ \b bid_begin, \b bid_end) under name, replacing
+    //! blocks stored under the same name before. The name must not contain
+    //! white space. Throws bad_parameter if a block is not on a disk with a
+    //! metadata file, or is stored under another name.
+    template <typename BIDIterator>
+    void store_blocks(const std::string& name,
+                      BIDIterator bid_begin, BIDIterator bid_end)
+    {
+        std::vector<BID<0> > bids;
+        for ( ; bid_begin != bid_end; ++bid_begin)
+            bids.emplace_back(bid_begin->storage, bid_begin->offset,
+                              static_cast<size_t>(bid_begin->size));
+        set_named_blocks(name, std::move(bids));
+    }
+
+    //! Retrieves the blocks stored under name, possibly by a previous run.
+    //! Returns false if there are none.
+    template <size_t BlockSize>
+    bool load_blocks(const std::string& name,
+                     std::vector<BID<BlockSize> >& bids) const
+    {
+        std::vector<BID<0> > stored;
+        if (!get_named_blocks(name, stored))
+            return false;
+
+        bids.clear();
+        bids.reserve(stored.size());
+        for (const BID<0>& bid : stored)
+        {
+            if (BlockSize != 0 && bid.size != BlockSize) {
+                FOXXLL_THROW(
+                    bad_parameter,
+                    "Blocks '" << name << "' have " << bid.size << " bytes, "
+                    "not " << BlockSize
+                );
+            }
+            bids.emplace_back(bid);
+        }
+        return true;
+    }
+
+    //! Forgets the name of stored blocks, without freeing them.
+    void erase_blocks(const std::string& name);
+
+    //! Returns the names of all stored blocks.
+    std::vector<std::string> stored_names() const;
+
+    //! Saves the blocks stored by name to the metadata file of each disk
+    //! configured with one, after syncing the disk file. Throws io_error if
+    //! the checkpoint cannot be made durable. Also called on destruction.
+    void checkpoint();
+
+    //! \}
+
     //! \name Statistics
     //! \{
 
@@ -117,6 +202,15 @@ public:
     //! Return total number of free bytes
     uint64_t free_bytes() const;
 
+    //! return number of bytes available on a disk
+    uint64_t total_bytes(size_t disk) const;
+
+    //! return number of free bytes on a disk
+    uint64_t free_bytes(size_t disk) const;
+
+    //! return the I/O statistics of a disk's file
+    file_stats * disk_file_stats(size_t disk) const;
+
     //! return total requested allocation in bytes
     uint64_t total_allocation() const;
 
@@ -126,12 +220,25 @@ public:
     //! return maximum number of bytes allocated during program run.
     uint64_t maximum_allocation() const;
 
+    //! return the allocation statistics and the free space of a disk
+    disk_allocation_stats_data allocation_stats(size_t disk) const;
+
+    //! return the allocation statistics and the free space of all disks
+    std::vector<disk_allocation_stats_data> allocation_stats() const;
+
+    //! Adds the allocation totals and the allocations and free space of each
+    //! disk, with their rates since the previous sample, to the samples of
+    //! the exporter. The exporter must be stopped before the block_manager
+    //! is destroyed.
+    void add_metrics_source(metrics_exporter& exporter);
+
     //! \}
 
     ~block_manager();
 
 private:
     friend class singleton<block_manager>;
+    friend class block_extent_allocator;
 
     //! number of managed disks
     size_t ndisks_;
@@ -143,19 +250,64 @@ private:
     tlx::simple_vector<disk_block_allocator*> block_allocators_;
 
     //! total requested allocation in bytes
-    uint64_t total_allocation_ = 0;
+    std::atomic<uint64_t> total_allocation_ { 0 };
 
     //! currently allocated bytes
-    uint64_t current_allocation_ = 0;
+    std::atomic<uint64_t> current_allocation_ { 0 };
 
     //! maximum number of bytes allocated during program run.
-    uint64_t maximum_allocation_ = 0;
+    std::atomic<uint64_t> maximum_allocation_ { 0 };
+
+    //! metadata file of each disk, empty if none
+    std::vector<std::string> metadata_;
+
+    //! blocks stored by name, see store_blocks()
+    std::map<std::string, std::vector<BID<0> > > named_blocks_;
+
+    //! name of each stored block by disk and offset
+    std::map<std::pair<size_t, uint64_t>, std::string> named_index_;
+
+    //! whether any blocks are stored, read by deletions without the lock
+    std::atomic<bool> has_named_ { false };
+
+    //! protects named_blocks_, named_index_ and the metadata files
+    mutable std::mutex named_mutex_;
+
+    //! replace the blocks stored under name
+    void set_named_blocks(const std::string& name, std::vector<BID<0> >&& bids);
+
+    //! erase the blocks stored under name and their index entries. Expects
+    //! the named_mutex_ to be locked.
+    void erase_named_blocks(
+        std::map<std::string, std::vector<BID<0> > >::iterator it);
+
+    //! drop the names of stored blocks among the regions freed on disk
+    void forget_named_blocks(
+        size_t disk, const std::vector<disk_block_allocator::place>& regions);
+
+    //! copy the blocks stored under name, returns false if there are none
+    bool get_named_blocks(const std::string& name,
+                          std::vector<BID<0> >& bids) const;
+
+    //! read the metadata files, reattach the stored blocks, and initialize
+    //! the allocators of disks with metadata
+    void restore_metadata();
 
     //! private construction from singleton
     block_manager();
 
-    //! protect internal data structures
-    mutable std::mutex mutex_;
+    //! update the allocation counters after allocating bytes
+    void add_allocation(uint64_t bytes)
+    {
+        total_allocation_.fetch_add(bytes, std::memory_order_relaxed);
+        uint64_t current =
+            current_allocation_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+        uint64_t maximum = maximum_allocation_.load(std::memory_order_relaxed);
+        while (current > maximum &&
+               !maximum_allocation_.compare_exchange_weak(
+                   maximum, current, std::memory_order_relaxed)) { }
+    }
 
     //! log creation and destruction of blocks
     static constexpr bool verbose_block_life_cycle = false;
@@ -167,8 +319,6 @@ void block_manager::new_blocks(
     BIDIterator bid_begin, BIDIterator bid_end,
     size_t alloc_offset)
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-
     using BIDType = typename std::iterator_traits<BIDIterator>::value_type;
 
     // choose disks for each block, sum up bytes allocated on a disk
@@ -214,9 +364,12 @@ void block_manager::new_blocks(
         disk_out[disk_id].push_back(i);
     }
 
-    // allocate blocks on disks in sequence, then scatter blocks into output
+    // allocate blocks on disks in sequence, then scatter blocks into output.
+    // Each disk_block_allocator locks itself, the space check above is only
+    // a hint if other threads allocate concurrently.
 
     tlx::simple_vector<BIDType> bids;
+    uint64_t allocated_bytes = 0;
 
     for (size_t d = 0; d < ndisks_; ++d)
     {
@@ -239,19 +392,16 @@ void block_manager::new_blocks(
             TLX_LOGC(verbose_block_life_cycle) << "BLC:new    " << bids[i];
             bid_begin[bid_perm[i]] = bids[i];
 
-            total_allocation_ += bids[i].size;
-            current_allocation_ += bids[i].size;
+            allocated_bytes += bids[i].size;
         }
     }
 
-    maximum_allocation_ = std::max(maximum_allocation_, current_allocation_);
+    add_allocation(allocated_bytes);
 }
 
 template <size_t BlockSize>
 void block_manager::delete_block(const BID<BlockSize>& bid)
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-
     if (!bid.valid()) {
         TLX_LOG << "Warning: invalid block to be deleted.";
         return;
@@ -261,18 +411,61 @@ void block_manager::delete_block(const BID<BlockSize>& bid)
 
     TLX_LOGC(verbose_block_life_cycle) << "BLC:delete " << bid;
     assert(bid.storage->get_allocator_id() >= 0);
-    block_allocators_[bid.storage->get_allocator_id()]->delete_block(bid);
-    disk_files_[bid.storage->get_allocator_id()]->discard(bid.offset, bid.size);
+    const size_t disk = static_cast<size_t>(bid.storage->get_allocator_id());
+
+    if (has_named_.load(std::memory_order_relaxed)) {
+        forget_named_blocks(
+            disk, std::vector<disk_block_allocator::place>(
+                1, disk_block_allocator::place(
+                    bid.offset, static_cast<uint64_t>(bid.size))));
+    }
 
-    current_allocation_ -= BlockSize;
+    block_allocators_[disk]->delete_block(bid);
+
+    current_allocation_.fetch_sub(bid.size, std::memory_order_relaxed);
 }
 
 template <typename BIDIterator>
 void block_manager::delete_blocks(
     const BIDIterator& bid_begin, const BIDIterator& bid_end)
 {
+    if (bid_begin == bid_end)
+        return;
+    if (std::next(bid_begin) == bid_end) {
+        delete_block(*bid_begin);
+        return;
+    }
+
+    std::vector<std::vector<disk_block_allocator::place> > disk_regions(ndisks_);
+    uint64_t deleted_bytes = 0;
+
     for (BIDIterator it = bid_begin; it != bid_end; ++it)
-        delete_block(*it);
+    {
+        if (!it->valid()) {
+            TLX_LOG << "Warning: invalid block to be deleted.";
+            continue;
+        }
+        if (!it->is_managed())
+            continue;  // self managed disk
+
+        TLX_LOGC(verbose_block_life_cycle) << "BLC:delete " << *it;
+        assert(it->storage->get_allocator_id() >= 0);
+        disk_regions[it->storage->get_allocator_id()].emplace_back(
+            it->offset, static_cast<uint64_t>(it->size));
+        deleted_bytes += it->size;
+    }
+
+    const bool has_named = has_named_.load(std::memory_order_relaxed);
+    for (size_t d = 0; d < ndisks_; ++d)
+    {
+        if (disk_regions[d].empty())
+            continue;
+        if (has_named)
+            forget_named_blocks(d, disk_regions[d]);
+        block_allocators_[d]->delete_regions(disk_regions[d]);
+    }
+
+    current_allocation_.fetch_sub(deleted_bytes, std::memory_order_relaxed);
 }
 
 //! \}
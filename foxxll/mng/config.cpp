@@ -21,12 +21,15 @@
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/common/utils.hpp>
 #include <foxxll/config.hpp>
+#include <foxxll/io/compressed_file.hpp>
 #include <foxxll/io/file.hpp>
+#include <foxxll/mng/block_alloc_strategy_dynamic.hpp>
 #include <foxxll/mng/config.hpp>
 #include <foxxll/version.hpp>
 #include <tlx/string/expand_environment_variables.hpp>
 #include <tlx/string/parse_si_iec_units.hpp>
 #include <tlx/string/split.hpp>
+#include <tlx/string/trim.hpp>
 
 #if FOXXLL_WINDOWS
    #ifndef NOMINMAX
@@ -76,6 +79,11 @@ void config::initialize()
 
     max_device_id_ = 0;
 
+    // environment overrides the config file
+    const char* strategy = getenv("FOXXLL_ALLOC_STRATEGY");
+    if (strategy && *strategy)
+        alloc_strategy_ = strategy;
+
     is_initialized = true;
 }
 
@@ -155,6 +163,21 @@ void config::load_config_file(const std::string& config_path)
         // skip comments
         if (line.size() == 0 || line[0] == '#') continue;
 
+        // global option: allocation strategy of dynamic_alloc_strategy
+        std::vector<std::string> eqfield = tlx::split('=', line, 2, 2);
+        if (tlx::trim(eqfield[0]) == "alloc_strategy") {
+            const std::string name = tlx::trim(eqfield[1]);
+            if (!alloc_strategy_registry::get_instance()->contains(name)) {
+                FOXXLL_THROW(
+                    std::runtime_error,
+                    "Unknown allocation strategy '" << name <<
+                        "' in disk configuration file."
+                );
+            }
+            alloc_strategy_ = name;
+            continue;
+        }
+
         disk_config entry;
         entry.parse_line(line); // throws on errors
 
@@ -177,6 +200,12 @@ void config::load_config_file(const std::string& config_path)
     }
 }
 
+config& config::set_alloc_strategy(const std::string& name)
+{
+    alloc_strategy_ = name;
+    return *this;
+}
+
 config& config::add_disk(const disk_config& cfg)
 {
     disks_list.push_back(cfg);
@@ -287,7 +316,14 @@ disk_config::disk_config()
       device_id(file::DEFAULT_DEVICE_ID),
       raw_device(false),
       unlink_on_open(false),
-      queue_length(0)
+      queue_length(0),
+      prealloc(false),
+      placement(FIRST_FIT),
+      discard_batch(0),
+      block_size(0),
+      thread_cache(0),
+      shrink(0),
+      bandwidth(0)
 { }
 
 disk_config::disk_config(const std::string& _path, external_size_type _size,
@@ -303,7 +339,14 @@ disk_config::disk_config(const std::string& _path, external_size_type _size,
       device_id(file::DEFAULT_DEVICE_ID),
       raw_device(false),
       unlink_on_open(false),
-      queue_length(0)
+      queue_length(0),
+      prealloc(false),
+      placement(FIRST_FIT),
+      discard_batch(0),
+      block_size(0),
+      thread_cache(0),
+      shrink(0),
+      bandwidth(0)
 {
     parse_fileio();
 }
@@ -318,7 +361,14 @@ disk_config::disk_config(const std::string& line)
       device_id(file::DEFAULT_DEVICE_ID),
       raw_device(false),
       unlink_on_open(false),
-      queue_length(0)
+      queue_length(0),
+      prealloc(false),
+      placement(FIRST_FIT),
+      discard_batch(0),
+      block_size(0),
+      thread_cache(0),
+      shrink(0),
+      bandwidth(0)
 {
     parse_line(line);
 }
@@ -350,6 +400,14 @@ void disk_config::parse_line(const std::string& line)
     queue = file::DEFAULT_QUEUE;
     device_id = file::DEFAULT_DEVICE_ID;
     unlink_on_open = false;
+    compress.clear();
+    prealloc = false;
+    placement = FIRST_FIT;
+    discard_batch = 0;
+    block_size = 0;
+    thread_cache = 0;
+    shrink = 0;
+    metadata.clear();
 
     // *** Save Basic Options ***
 
@@ -437,10 +495,54 @@ void disk_config::parse_fileio()
                 );
             }
         }
+        else if (eq[0] == "bandwidth")
+        {
+            if (!tlx::parse_si_iec_units(eq[1], &bandwidth)) {
+                FOXXLL_THROW(
+                    std::runtime_error,
+                    "Invalid parameter '" << *p << "' in disk configuration file."
+                );
+            }
+        }
+        else if (eq[0] == "block_size")
+        {
+            if (!tlx::parse_si_iec_units(eq[1], &block_size) || block_size == 0) {
+                FOXXLL_THROW(
+                    std::runtime_error,
+                    "Invalid parameter '" << *p << "' in disk configuration file."
+                );
+            }
+        }
+        else if (eq[0] == "compress")
+        {
+            if (eq[1] == "none" || eq[1] == "off" || eq[1] == "no") {
+                compress.clear();
+            }
+            else {
+                // throws on unsupported algorithms
+                compressed_file::parse_algorithm(eq[1]);
+                compress = eq[1];
+            }
+        }
         else if (*p == "delete" || *p == "delete_on_exit")
         {
             delete_on_exit = true;
         }
+        else if (eq[0] == "discard_batch")
+        {
+            if (!(io_impl == "syscall" || io_impl == "linuxaio" ||
+                  io_impl == "mmap"))
+            {
+                FOXXLL_THROW(std::runtime_error, "Parameter '" << *p << "' invalid for fileio '" << io_impl << "' in disk configuration file.");
+            }
+
+            if (!tlx::parse_si_iec_units(eq[1], &discard_batch)) {
+                FOXXLL_THROW(
+                    std::runtime_error,
+                    "Invalid parameter '" << *p << "' in disk configuration file."
+                );
+            }
+        }
         else if (*p == "direct" || *p == "nodirect" || eq[0] == "direct")
         {
             // io_impl is not checked here, but I guess that is okay for DIRECT
@@ -461,6 +563,44 @@ void disk_config::parse_fileio()
                 );
             }
         }
+        else if (eq[0] == "metadata")
+        {
+            if (io_impl == "memory" || io_impl == "chunked_memory") {
+                FOXXLL_THROW(std::runtime_error, "Parameter '" << *p << "' invalid for fileio '" << io_impl << "' in disk configuration file.");
+            }
+
+            if (eq[1].empty()) {
+                FOXXLL_THROW(
+                    std::runtime_error,
+                    "Invalid parameter '" << *p << "' in disk configuration file."
+                );
+            }
+
+            metadata = eq[1];
+        }
+        else if (eq[0] == "placement")
+        {
+            if (eq[1] == "best_fit") placement = BEST_FIT;
+            else if (eq[1] == "first_fit") placement = FIRST_FIT;
+            else if (eq[1] == "next_fit") placement = NEXT_FIT;
+            else
+            {
+                FOXXLL_THROW(
+                    std::runtime_error,
+                    "Invalid parameter '" << *p << "' in disk configuration file."
+                );
+            }
+        }
+        else if (*p == "prealloc")
+        {
+            if (!(io_impl == "syscall" || io_impl == "linuxaio" ||
+                  io_impl == "mmap"))
+            {
+                FOXXLL_THROW(std::runtime_error, "Parameter '" << *p << "' invalid for fileio '" << io_impl << "' in disk configuration file.");
+            }
+
+            prealloc = true;
+        }
         else if (eq[0] == "queue")
         {
             if (io_impl == "linuxaio") {
@@ -514,6 +654,26 @@ void disk_config::parse_fileio()
 
             raw_device = true;
         }
+        else if (eq[0] == "shrink")
+        {
+            if (!tlx::parse_si_iec_units(eq[1], &shrink)) {
+                FOXXLL_THROW(
+                    std::runtime_error,
+                    "Invalid parameter '" << *p << "' in disk configuration file."
+                );
+            }
+        }
+        else if (eq[0] == "thread_cache")
+        {
+            char* endp;
+            thread_cache = static_cast<size_t>(strtoul(eq[1].c_str(), &endp, 10));
+            if (endp && *endp != 0) {
+                FOXXLL_THROW(
+                    std::runtime_error,
+                    "Invalid parameter '" << *p << "' in disk configuration file."
+                );
+            }
+        }
         else if (*p == "unlink" || *p == "unlink_on_open")
         {
             if (!(io_impl == "syscall" || io_impl == "linuxaio" ||
@@ -532,6 +692,17 @@ void disk_config::parse_fileio()
             );
         }
     }
+
+    // blocks kept across runs need a file which outlives the program and
+    // stores them at their logical offsets
+    if (!metadata.empty() && (!compress.empty() || delete_on_exit || unlink_on_open))
+    {
+        FOXXLL_THROW(
+            std::runtime_error,
+            "Parameter 'metadata' cannot be combined with "
+            "compress, delete_on_exit or unlink in disk configuration file."
+        );
+    }
 }
 
 std::string disk_config::fileio_string() const
@@ -543,6 +714,15 @@ std::string disk_config::fileio_string() const
     if (!autogrow)
         oss << " autogrow=no";
 
+    if (bandwidth != 0)
+        oss << " bandwidth=" << bandwidth;
+
+    if (block_size != 0)
+        oss << " block_size=" << block_size;
+
+    if (!compress.empty())
+        oss << " compress=" << compress;
+
     if (delete_on_exit)
         oss << " delete_on_exit";
 
@@ -564,6 +744,17 @@ std::string disk_config::fileio_string() const
         oss << " flash";
     }
 
+    if (placement == BEST_FIT) {
+        oss << " placement=best_fit";
+    }
+    else if (placement == NEXT_FIT) {
+        oss << " placement=next_fit";
+    }
+
+    if (prealloc) {
+        oss << " prealloc";
+    }
+
     if (queue != file::DEFAULT_QUEUE && queue != file::DEFAULT_LINUXAIO_QUEUE) {
         oss << " queue=" << queue;
     }
@@ -584,6 +775,22 @@ std::string disk_config::fileio_string() const
         oss << " queue_length=" << queue_length;
     }
 
+    if (discard_batch != 0) {
+        oss << " discard_batch=" << discard_batch;
+    }
+
+    if (thread_cache != 0) {
+        oss << " thread_cache=" << thread_cache;
+    }
+
+    if (shrink != 0) {
+        oss << " shrink=" << shrink;
+    }
+
+    if (!metadata.empty()) {
+        oss << " metadata=" << metadata;
+    }
+
     return oss.str();
 }
 
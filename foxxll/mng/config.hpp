@@ -105,6 +105,50 @@ public:
     //! desired queue length for linuxaio_file and linuxaio_queue
     int queue_length;
 
+    //! compress blocks with the given algorithm (e.g. "lz4") using a
+    //! compressed_file on top of the io implementation. Empty -> disabled.
+    std::string compress;
+
+    //! allocate disk space when creating or growing the file instead of
+    //! extending it sparsely (syscall, linuxaio and mmap only)
+    bool prealloc;
+
+    //! placement policy of disk_block_allocator among free regions:
+    //! first-fit (lowest offset, the default), best-fit (smallest fitting
+    //! region) or next-fit (first fitting region after the last allocation).
+    //! All look up indexes of the free regions instead of scanning them.
+    enum placement_type {
+        FIRST_FIT = 0, BEST_FIT = 1, NEXT_FIT = 2
+    } placement;
+
+    //! collect freed regions until they coalesce to at least this many bytes
+    //! before discarding them from the file. 0 -> discard every block.
+    external_size_type discard_batch;
+
+    //! size of all blocks allocated on this disk. If set, the
+    //! disk_block_allocator tracks free blocks in a bitmap instead of a map of
+    //! free regions and rejects blocks of other sizes. 0 -> any block size.
+    external_size_type block_size;
+
+    //! number of free blocks of each size which every thread caches for
+    //! allocation without locking the disk_block_allocator. 0 -> disabled.
+    size_t thread_cache;
+
+    //! truncate an autogrown file back (never below its configured size) as
+    //! soon as at least this many bytes at its end are free. 0 -> the file
+    //! only shrinks when the disk is closed.
+    external_size_type shrink;
+
+    //! peak bandwidth of the disk in bytes per second, e.g. as measured by
+    //! foxxll_tool benchmark_disks. Used by io_profiler to rate the achieved
+    //! bandwidth. 0 -> unknown.
+    external_size_type bandwidth;
+
+    //! file to which block_manager::checkpoint() saves the blocks stored by
+    //! name on this disk, from which they are reattached when the disk is
+    //! opened again. Empty -> the disk starts empty.
+    std::string metadata;
+
     //! \}
 };
 
@@ -127,6 +171,9 @@ class config : public singleton<config>
     //! Finished initializing config
     bool is_initialized;
 
+    //! name of the allocation strategy used by dynamic_alloc_strategy
+    std::string alloc_strategy_;
+
     //! Constructor: this must be inlined to print the header version
     //! string.
     config();
@@ -240,6 +287,18 @@ public:
     //! Returns the total size over all disks
     external_size_type total_size() const;
 
+    //! Returns the name of the allocation strategy selected by the
+    //! environment variable FOXXLL_ALLOC_STRATEGY or an alloc_strategy=<name>
+    //! line of the config file, or an empty string if none is selected.
+    const std::string & alloc_strategy()
+    {
+        check_initialized();
+        return alloc_strategy_;
+    }
+
+    //! Select the allocation strategy used by dynamic_alloc_strategy by name.
+    config & set_alloc_strategy(const std::string& name);
+
     //! \}
 };
 
@@ -0,0 +1,212 @@
+/***************************************************************************
+ *  foxxll/mng/disk_allocation_stats.hpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef FOXXLL_MNG_DISK_ALLOCATION_STATS_HEADER
+#define FOXXLL_MNG_DISK_ALLOCATION_STATS_HEADER
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <foxxll/common/timer.hpp>
+
+namespace foxxll {
+
+//! \addtogroup foxxll_mnglayer
+//! \{
+
+/*!
+ * Counters of the allocations of a disk_block_allocator: the blocks taken
+ * from and returned to its free space, the time allocations waited for and
+ * held its lock, the growth of the file by allocations, and the allocations
+ * which found no contiguous region and were split.
+ *
+ * Blocks are counted when handed out to and returned by their users, blocks
+ * kept in thread caches count as neither. An extent reserved for carving
+ * counts its bytes, each block carved from it counts as one block, and its
+ * unused tail counts as freed bytes. Updating the counters costs a few
+ * relaxed atomic operations and two timestamp_ticks() per lock acquisition.
+ */
+class disk_allocation_stats
+{
+    //! blocks and bytes taken from the free space
+    std::atomic<uint64_t> alloc_blocks_ { 0 }, alloc_bytes_ { 0 };
+    //! blocks and bytes returned to the free space
+    std::atomic<uint64_t> freed_blocks_ { 0 }, freed_bytes_ { 0 };
+    //! ticks allocations waited for and held the lock of the allocator
+    std::atomic<ticks_type> lock_wait_time_ { 0 }, lock_hold_time_ { 0 };
+    //! number of times and bytes by which allocations grew the file
+    std::atomic<uint64_t> grow_count_ { 0 }, grow_bytes_ { 0 };
+    //! allocations split for lack of a contiguous region
+    std::atomic<uint64_t> split_count_ { 0 };
+
+public:
+    disk_allocation_stats() = default;
+
+    //! non-copyable: delete copy-constructor
+    disk_allocation_stats(const disk_allocation_stats&) = delete;
+    //! non-copyable: delete assignment operator
+    disk_allocation_stats& operator = (const disk_allocation_stats&) = delete;
+
+    //! blocks of bytes in total were taken from the free space
+    void allocated(uint64_t blocks, uint64_t bytes)
+    {
+        alloc_blocks_.fetch_add(blocks, std::memory_order_relaxed);
+        alloc_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    //! blocks of bytes in total were returned to the free space
+    void freed(uint64_t blocks, uint64_t bytes)
+    {
+        freed_blocks_.fetch_add(blocks, std::memory_order_relaxed);
+        freed_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    //! an allocation waited wait ticks for the lock and held it hold ticks
+    void locked(ticks_type wait, ticks_type hold)
+    {
+        lock_wait_time_.fetch_add(wait, std::memory_order_relaxed);
+        lock_hold_time_.fetch_add(hold, std::memory_order_relaxed);
+    }
+
+    //! an allocation grew the file by bytes
+    void grown(uint64_t bytes)
+    {
+        grow_count_.fetch_add(1, std::memory_order_relaxed);
+        grow_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    //! an allocation found no contiguous region and was split
+    void split()
+    {
+        split_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t get_alloc_blocks() const { return alloc_blocks_.load(std::memory_order_relaxed); }
+    uint64_t get_alloc_bytes() const { return alloc_bytes_.load(std::memory_order_relaxed); }
+    uint64_t get_freed_blocks() const { return freed_blocks_.load(std::memory_order_relaxed); }
+    uint64_t get_freed_bytes() const { return freed_bytes_.load(std::memory_order_relaxed); }
+    double get_lock_wait_time() const { return ticks_to_seconds(lock_wait_time_.load(std::memory_order_relaxed)); }
+    double get_lock_hold_time() const { return ticks_to_seconds(lock_hold_time_.load(std::memory_order_relaxed)); }
+    uint64_t get_grow_count() const { return grow_count_.load(std::memory_order_relaxed); }
+    uint64_t get_grow_bytes() const { return grow_bytes_.load(std::memory_order_relaxed); }
+    uint64_t get_split_count() const { return split_count_.load(std::memory_order_relaxed); }
+};
+
+//! Snapshot of the allocation statistics and the free space of a disk.
+//! Subtracting an earlier snapshot yields the counters of the interval and
+//! keeps the current free space.
+class disk_allocation_stats_data
+{
+    uint64_t alloc_blocks_ = 0, alloc_bytes_ = 0;
+    uint64_t freed_blocks_ = 0, freed_bytes_ = 0;
+    double lock_wait_time_ = 0.0, lock_hold_time_ = 0.0;
+    uint64_t grow_count_ = 0, grow_bytes_ = 0;
+    uint64_t split_count_ = 0;
+
+    uint64_t total_bytes_ = 0, free_bytes_ = 0;
+    size_t free_regions_ = 0;
+    uint64_t largest_free_region_ = 0;
+
+public:
+    disk_allocation_stats_data() = default;
+
+    //! construct by taking the current counters from disk_allocation_stats
+    //! and the given state of the free space
+    disk_allocation_stats_data(
+        const disk_allocation_stats& s,
+        uint64_t total_bytes, uint64_t free_bytes,
+        size_t free_regions, uint64_t largest_free_region)
+        : alloc_blocks_(s.get_alloc_blocks()), alloc_bytes_(s.get_alloc_bytes()),
+          freed_blocks_(s.get_freed_blocks()), freed_bytes_(s.get_freed_bytes()),
+          lock_wait_time_(s.get_lock_wait_time()),
+          lock_hold_time_(s.get_lock_hold_time()),
+          grow_count_(s.get_grow_count()), grow_bytes_(s.get_grow_bytes()),
+          split_count_(s.get_split_count()),
+          total_bytes_(total_bytes), free_bytes_(free_bytes),
+          free_regions_(free_regions),
+          largest_free_region_(largest_free_region)
+    { }
+
+    disk_allocation_stats_data operator - (const disk_allocation_stats_data& a) const
+    {
+        disk_allocation_stats_data d = *this;
+        d.alloc_blocks_ -= a.alloc_blocks_;
+        d.alloc_bytes_ -= a.alloc_bytes_;
+        d.freed_blocks_ -= a.freed_blocks_;
+        d.freed_bytes_ -= a.freed_bytes_;
+        d.lock_wait_time_ -= a.lock_wait_time_;
+        d.lock_hold_time_ -= a.lock_hold_time_;
+        d.grow_count_ -= a.grow_count_;
+        d.grow_bytes_ -= a.grow_bytes_;
+        d.split_count_ -= a.split_count_;
+        return d;
+    }
+
+    //! number of blocks taken from the free space
+    uint64_t get_alloc_blocks() const { return alloc_blocks_; }
+    //! number of bytes taken from the free space
+    uint64_t get_alloc_bytes() const { return alloc_bytes_; }
+    //! number of blocks returned to the free space
+    uint64_t get_freed_blocks() const { return freed_blocks_; }
+    //! number of bytes returned to the free space
+    uint64_t get_freed_bytes() const { return freed_bytes_; }
+    //! seconds allocations waited for the lock of the allocator
+    double get_lock_wait_time() const { return lock_wait_time_; }
+    //! seconds allocations held the lock of the allocator
+    double get_lock_hold_time() const { return lock_hold_time_; }
+    //! number of times allocations grew the file
+    uint64_t get_grow_count() const { return grow_count_; }
+    //! number of bytes by which allocations grew the file
+    uint64_t get_grow_bytes() const { return grow_bytes_; }
+    //! number of allocations split for lack of a contiguous region
+    uint64_t get_split_count() const { return split_count_; }
+
+    //! size of the disk
+    uint64_t get_total_bytes() const { return total_bytes_; }
+    //! free bytes of the disk
+    uint64_t get_free_bytes() const { return free_bytes_; }
+    //! number of free regions
+    size_t get_free_regions() const { return free_regions_; }
+    //! size of the largest free region
+    uint64_t get_largest_free_region() const { return largest_free_region_; }
+
+    //! Fraction of the free space outside of the largest free region: zero
+    //! if the free space is contiguous, close to one if it is scattered in
+    //! many small regions.
+    double get_fragmentation() const
+    {
+        return free_bytes_ == 0 ? 0.0
+               : 1.0 - static_cast<double>(largest_free_region_)
+               / static_cast<double>(free_bytes_);
+    }
+
+    //! blocks allocated per second during elapsed seconds
+    double get_alloc_rate(double elapsed) const
+    {
+        return elapsed > 0.0 ? static_cast<double>(alloc_blocks_) / elapsed : 0.0;
+    }
+
+    //! blocks freed per second during elapsed seconds
+    double get_free_rate(double elapsed) const
+    {
+        return elapsed > 0.0 ? static_cast<double>(freed_blocks_) / elapsed : 0.0;
+    }
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !FOXXLL_MNG_DISK_ALLOCATION_STATS_HEADER
+
+/**************************************************************************/
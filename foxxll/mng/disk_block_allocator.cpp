@@ -11,20 +11,104 @@
  *  http://www.boost.org/LICENSE_1_0.txt)
  **************************************************************************/
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <map>
+#include <mutex>
 #include <ostream>
+#include <set>
 #include <utility>
+#include <vector>
+
+#include <tlx/math/clz.hpp>
+#include <tlx/math/ctz.hpp>
 
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/common/exceptions.hpp>
 #include <foxxll/common/types.hpp>
+#include <foxxll/common/utils.hpp>
 #include <foxxll/mng/disk_block_allocator.hpp>
 
 namespace foxxll {
 
+/*!
+ * Cache of free blocks of the calling thread, one list of offsets per
+ * allocator and block size. When the thread exits, the cached blocks are
+ * returned to their allocators, unless these were destroyed already.
+ */
+class disk_block_allocator::thread_cache_type
+{
+public:
+    struct entry
+    {
+        disk_block_allocator* alloc;
+        uint64_t serial;
+        uint64_t block_size;
+        std::vector<uint64_t> offsets;
+    };
+
+    //! the calling thread's cache
+    static thread_cache_type & get()
+    {
+        static thread_local thread_cache_type cache;
+        return cache;
+    }
+
+    //! find or create the entry of the allocator and block size
+    entry & find(disk_block_allocator* alloc, uint64_t block_size)
+    {
+        // few disks and block sizes: a linear scan is fastest
+        for (entry& e : entries_)
+        {
+            if (e.alloc != alloc || e.block_size != block_size)
+                continue;
+            // an allocator at the same address as a destroyed one
+            if (e.serial != alloc->serial_) {
+                e.serial = alloc->serial_;
+                e.offsets.clear();
+            }
+            return e;
+        }
+        entries_.push_back(entry { alloc, alloc->serial_, block_size, { } });
+        return entries_.back();
+    }
+
+    ~thread_cache_type()
+    {
+        std::unique_lock<std::mutex> lock(registry_mutex_);
+        for (entry& e : entries_)
+        {
+            if (!e.offsets.empty() && live_serials_.count(e.serial))
+                e.alloc->release_cached_blocks(e.offsets, e.offsets.size(), e.block_size);
+        }
+    }
+
+    //! protects live_serials_
+    static std::mutex registry_mutex_;
+    //! serial numbers of allocators which are not destroyed
+    static std::set<uint64_t> live_serials_;
+    //! last serial number handed out
+    static uint64_t last_serial_;
+
+private:
+    std::vector<entry> entries_;
+};
+
+std::mutex disk_block_allocator::thread_cache_type::registry_mutex_;
+std::set<uint64_t> disk_block_allocator::thread_cache_type::live_serials_;
+uint64_t disk_block_allocator::thread_cache_type::last_serial_ = 0;
+
 void disk_block_allocator::dump() const
 {
+    if (block_size_ != 0) {
+        TLX_LOG1 << "Free blocks: " << bitmap_.free_count()
+                 << " of " << bitmap_.size()
+                 << " in " << bitmap_.free_run_count() << " runs"
+                 << ", block size: " << block_size_;
+        return;
+    }
+
     uint64_t total = 0;
     space_map_type::const_iterator cur = free_space_.begin();
     TLX_LOG1 << "Free regions dump:";
@@ -65,6 +149,23 @@ void disk_block_allocator::deallocation_error(
 void disk_block_allocator::add_free_region(uint64_t block_pos, uint64_t block_size)
 {
     TLX_LOG << "Deallocating a block with size: " << block_size << " position: " << block_pos;
+
+    if (block_size_ != 0)
+    {
+        if (block_pos % block_size_ != 0 || block_size % block_size_ != 0 ||
+            !bitmap_.set_free(block_pos / block_size_, block_size / block_size_))
+        {
+            FOXXLL_THROW2(
+                bad_ext_alloc, "disk_block_allocator::check_corruption",
+                "Error: double deallocation of external memory, trying to deallocate "
+                "region " << block_pos << " + " << block_size << " which is free "
+                "or not aligned to block_size=" << block_size_
+            );
+        }
+        free_bytes_ += block_size;
+        return;
+    }
+
     uint64_t region_pos = block_pos;
     uint64_t region_size = block_size;
 
@@ -109,7 +210,7 @@ void disk_block_allocator::add_free_region(uint64_t block_pos, uint64_t block_si
                 // coalesce with predecessor
                 region_size += (*pred).second;
                 region_pos = (*pred).first;
-                free_space_.erase(pred);
+                erase_free_region(pred);
             }
         }
         else {
@@ -120,7 +221,7 @@ void disk_block_allocator::add_free_region(uint64_t block_pos, uint64_t block_si
                 if ((*succ).first == region_pos + region_size) {
                     // coalesce with successor
                     region_size += (*succ).second;
-                    free_space_.erase(succ);
+                    erase_free_region(succ);
                     if (succ_is_not_the_first)
                         succ = pred;
                 }
@@ -134,7 +235,7 @@ void disk_block_allocator::add_free_region(uint64_t block_pos, uint64_t block_si
                         // coalesce with predecessor
                         region_size += (*pred).second;
                         region_pos = (*pred).first;
-                        free_space_.erase(pred);
+                        erase_free_region(pred);
                     }
                 }
             }
@@ -142,16 +243,772 @@ void disk_block_allocator::add_free_region(uint64_t block_pos, uint64_t block_si
                 if ((*succ).first == region_pos + region_size) {
                     // coalesce with successor
                     region_size += (*succ).second;
-                    free_space_.erase(succ);
+                    erase_free_region(succ);
                 }
             }
         }
     }
 
-    free_space_[region_pos] = region_size;
+    insert_free_region(region_pos, region_size);
     free_bytes_ += block_size;
 }
 
+//! index of the size class of a free region of size > 0 bytes
+static inline size_t size_class(uint64_t size)
+{
+    return 63 - tlx::clz(size);
+}
+
+void disk_block_allocator::insert_free_region(uint64_t pos, uint64_t size)
+{
+    free_space_[pos] = size;
+    size_index_.emplace(size, pos);
+
+    const size_t c = size_class(size);
+    size_classes_[c][pos] = size;
+    size_class_mask_ |= uint64_t(1) << c;
+}
+
+void disk_block_allocator::erase_free_region(space_map_type::iterator it)
+{
+    const size_t c = size_class(it->second);
+    size_classes_[c].erase(it->first);
+    if (size_classes_[c].empty())
+        size_class_mask_ &= ~(uint64_t(1) << c);
+
+    size_index_.erase(place(it->second, it->first));
+    free_space_.erase(it);
+}
+
+disk_block_allocator::space_map_type::iterator
+disk_block_allocator::find_first_fit(uint64_t size, uint64_t start)
+{
+    const size_t c = size_class(size);
+
+    bool found = false;
+    uint64_t best = 0;
+
+    // every region of a larger class fits, the first one at start counts
+    for (uint64_t mask = size_class_mask_ & ~((uint64_t(2) << c) - 1);
+         mask != 0; mask &= mask - 1)
+    {
+        const space_map_type& regions = size_classes_[tlx::ctz(mask)];
+        auto it = regions.lower_bound(start);
+        if (it != regions.end() && (!found || it->first < best)) {
+            best = it->first;
+            found = true;
+        }
+    }
+
+    // regions of the same class fit only if large enough
+    const space_map_type& regions = size_classes_[c];
+    for (auto it = regions.lower_bound(start);
+         it != regions.end() && (!found || it->first < best); ++it)
+    {
+        if (it->second >= size) {
+            best = it->first;
+            found = true;
+            break;
+        }
+    }
+
+    return found ? free_space_.find(best) : free_space_.end();
+}
+
+disk_block_allocator::space_map_type::iterator
+disk_block_allocator::find_free_region(uint64_t size)
+{
+    // no region is large enough
+    if (size_index_.empty() || size_index_.rbegin()->first < size)
+        return free_space_.end();
+
+    switch (placement_)
+    {
+    case disk_config::BEST_FIT: {
+        // smallest region that fits, lowest offset among equally sized ones
+        auto it = size_index_.lower_bound(place(size, 0));
+        return free_space_.find(it->second);
+    }
+    case disk_config::FIRST_FIT:
+        return find_first_fit(size, 0);
+    case disk_config::NEXT_FIT: {
+        // continue after the last allocation, wrap around at the end
+        auto it = find_first_fit(size, next_fit_pos_);
+        if (it == free_space_.end())
+            it = find_first_fit(size, 0);
+        return it;
+    }
+    }
+
+    return free_space_.end();
+}
+
+bool disk_block_allocator::allocate_region(uint64_t size, uint64_t& pos)
+{
+    if (block_size_ != 0)
+    {
+        const size_t block = bitmap_.allocate(size / block_size_);
+        if (block == block_bitmap::npos)
+            return false;
+
+        pos = block * block_size_;
+        return true;
+    }
+
+    space_map_type::iterator space = find_free_region(size);
+    if (space == free_space_.end())
+        return false;
+
+    const uint64_t region_pos = space->first;
+    const uint64_t region_size = space->second;
+    erase_free_region(space);
+
+    if (region_size > size)
+        insert_free_region(region_pos + size, region_size - size);
+
+    next_fit_pos_ = region_pos + size;
+
+    pos = region_pos;
+    return true;
+}
+
+bool disk_block_allocator::take_region(uint64_t pos, uint64_t size)
+{
+    if (block_size_ != 0)
+    {
+        if (pos % block_size_ != 0 || size % block_size_ != 0)
+            return false;
+
+        const size_t first = pos / block_size_, n = size / block_size_;
+        if (first + n > bitmap_.size())
+            return false;
+
+        for (size_t i = first; i < first + n; ++i) {
+            if (!bitmap_.is_free(i))
+                return false;
+        }
+
+        bitmap_.set_allocated(first, n);
+        return true;
+    }
+
+    // the free region containing pos
+    space_map_type::iterator it = free_space_.upper_bound(pos);
+    if (it == free_space_.begin())
+        return false;
+    --it;
+
+    const uint64_t region_pos = it->first;
+    const uint64_t region_end = it->first + it->second;
+    if (pos + size > region_end)
+        return false;
+
+    erase_free_region(it);
+
+    if (region_pos < pos)
+        insert_free_region(region_pos, pos - region_pos);
+    if (pos + size < region_end)
+        insert_free_region(pos + size, region_end - pos - size);
+
+    return true;
+}
+
+void disk_block_allocator::restore(
+    uint64_t disk_bytes, std::vector<place>& allocated)
+{
+    std::sort(allocated.begin(), allocated.end());
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    assert(disk_bytes_ == 0);
+
+    if (!allocated.empty() &&
+        allocated.back().first + allocated.back().second > storage_->size())
+    {
+        FOXXLL_THROW2(
+            io_error, "disk_block_allocator::restore",
+            "the file of " << storage_->size() << " bytes is shorter than "
+            "its saved blocks, it was truncated or replaced"
+        );
+    }
+
+    grow_file(std::max(disk_bytes, cfg_bytes_));
+
+    for (const place& region : allocated)
+    {
+        if (!take_region(region.first, region.second)) {
+            FOXXLL_THROW2(
+                bad_ext_alloc, "disk_block_allocator::restore",
+                "saved block at " << region.first << " of " << region.second
+                << " bytes overlaps another one or exceeds the disk"
+            );
+        }
+        free_bytes_ -= region.second;
+    }
+
+    TLX_LOG << "disk_block_allocator::restore(" << allocated.size()
+            << " regions), free:" << free_bytes_ << " total:" << disk_bytes_;
+}
+
+disk_allocation_stats_data disk_block_allocator::allocation_stats()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    const uint64_t disk_bytes = disk_bytes_, free_bytes = free_bytes_;
+
+    if (block_size_ == 0)
+    {
+        const uint64_t largest_free_region =
+            size_index_.empty() ? 0 : size_index_.rbegin()->first;
+
+        return disk_allocation_stats_data(
+            stats_, disk_bytes, free_bytes,
+            free_space_.size(), largest_free_region);
+    }
+
+    // scanning the free runs takes O(n), copy the bitmap and scan it without
+    // blocking allocations
+    const block_bitmap bitmap = bitmap_;
+    lock.unlock();
+
+    return disk_allocation_stats_data(
+        stats_, disk_bytes, free_bytes, bitmap.free_run_count(),
+        bitmap.longest_free_run() * block_size_);
+}
+
+bool disk_block_allocator::reserve_extent(uint64_t& bytes, uint64_t& pos)
+{
+    if (block_size_ != 0)
+        bytes = div_ceil(bytes, block_size_) * block_size_;
+
+    const ticks_type lock_begin = timestamp_ticks();
+    std::unique_lock<std::mutex> lock(mutex_);
+    const ticks_type locked = timestamp_ticks();
+
+    if (!allocate_region(bytes, pos))
+    {
+        if (!autogrow_)
+            return false;
+
+        // the new space is contiguous with a free region at the end of file
+        grow_for_allocation(bytes);
+
+        if (!allocate_region(bytes, pos))
+            return false;
+    }
+
+    if (!discard_space_.empty())
+        remove_discard_region(pos, bytes);
+
+    assert(free_bytes_ >= bytes);
+    free_bytes_ -= bytes;
+
+    extents_[pos] = bytes;
+
+    // the blocks are counted when they are carved
+    stats_.allocated(0, bytes);
+    stats_.locked(locked - lock_begin, timestamp_ticks() - locked);
+
+    TLX_LOG << "disk_block_allocator::reserve_extent(" << bytes << ") at " << pos
+            << ", free:" << free_bytes_ << " total:" << disk_bytes_;
+
+    return true;
+}
+
+void disk_block_allocator::release_extent(
+    uint64_t extent_pos, uint64_t pos, uint64_t size)
+{
+    if (size != 0) {
+        stats_.freed(0, size);
+        std::vector<place> regions(1, place(pos, size));
+        free_regions(regions);
+    }
+
+    // closed after freeing the tail: compact() meanwhile stops at the
+    // extent, instead of moving the tail before it is freed.
+    std::unique_lock<std::mutex> lock(mutex_);
+    extents_.erase(extent_pos);
+}
+
+bool disk_block_allocator::add_discard_region(uint64_t& pos, uint64_t& size)
+{
+    // pending regions are disjoint free regions, hence only exactly adjacent
+    // neighbors need to be merged.
+    auto succ = discard_space_.upper_bound(pos);
+
+    if (succ != discard_space_.end() && succ->first == pos + size) {
+        size += succ->second;
+        succ = discard_space_.erase(succ);
+    }
+
+    if (succ != discard_space_.begin()) {
+        auto pred = std::prev(succ);
+        if (pred->first + pred->second == pos) {
+            pos = pred->first;
+            size += pred->second;
+            discard_space_.erase(pred);
+        }
+    }
+
+    if (size >= discard_batch_)
+        return true;
+
+    discard_space_[pos] = size;
+    return false;
+}
+
+void disk_block_allocator::remove_discard_region(uint64_t pos, uint64_t size)
+{
+    const uint64_t end = pos + size;
+
+    auto it = discard_space_.upper_bound(pos);
+    if (it != discard_space_.begin())
+        --it;
+
+    while (it != discard_space_.end() && it->first < end)
+    {
+        const uint64_t it_pos = it->first;
+        const uint64_t it_end = it->first + it->second;
+
+        if (it_end <= pos) {
+            ++it;
+            continue;
+        }
+
+        it = discard_space_.erase(it);
+
+        // keep the parts outside of the allocated region
+        if (it_pos < pos)
+            discard_space_[it_pos] = pos - it_pos;
+        if (it_end > end)
+            discard_space_[end] = it_end - end;
+    }
+}
+
+void disk_block_allocator::flush_discard_regions()
+{
+    for (const auto& region : discard_space_)
+        storage_->discard(region.first, region.second);
+    discard_space_.clear();
+}
+
+void disk_block_allocator::shrink_file(uint64_t min_bytes)
+{
+    if (disk_bytes_ <= cfg_bytes_)
+        return;
+
+    // start of the free region at the end of the file
+    uint64_t tail_pos = disk_bytes_;
+    if (block_size_ != 0)
+    {
+        tail_pos = (bitmap_.size() - bitmap_.free_tail()) * block_size_;
+    }
+    else if (!free_space_.empty())
+    {
+        const auto& last = *free_space_.rbegin();
+        if (last.first + last.second == disk_bytes_)
+            tail_pos = last.first;
+    }
+
+    uint64_t new_size = std::max(tail_pos, cfg_bytes_);
+    if (block_size_ != 0)
+        new_size = div_ceil(new_size, block_size_) * block_size_;
+
+    if (new_size >= disk_bytes_ || disk_bytes_ - new_size < min_bytes)
+        return;
+
+    const uint64_t removed = disk_bytes_ - new_size;
+
+    if (block_size_ != 0)
+    {
+        bitmap_.shrink(new_size / block_size_);
+    }
+    else
+    {
+        erase_free_region(std::prev(free_space_.end()));
+        if (tail_pos < new_size)
+            insert_free_region(tail_pos, new_size - tail_pos);
+    }
+
+    if (!discard_space_.empty())
+        remove_discard_region(new_size, removed);
+
+    next_fit_pos_ = std::min(next_fit_pos_, new_size);
+
+    storage_->set_size(new_size);
+
+    free_bytes_ -= removed;
+    disk_bytes_ = new_size;
+
+    TLX_LOG << "disk_block_allocator::shrink_file() removed " << removed
+            << " bytes, free:" << free_bytes_ << " total:" << disk_bytes_;
+}
+
+bool disk_block_allocator::overlaps_extent(uint64_t pos, uint64_t size) const
+{
+    // extents are disjoint, only the last one starting before the end counts
+    auto it = extents_.lower_bound(pos + size);
+    if (it == extents_.begin())
+        return false;
+    --it;
+    return it->first + it->second > pos;
+}
+
+bool disk_block_allocator::last_allocated_region(
+    uint64_t& pos, uint64_t& size) const
+{
+    if (block_size_ != 0)
+    {
+        const size_t end = bitmap_.size() - bitmap_.free_tail();
+        if (end == 0)
+            return false;
+
+        // the last block
+        pos = (end - 1) * block_size_;
+        size = block_size_;
+        return true;
+    }
+
+    // skip the free region at the end of the file
+    auto it = free_space_.end();
+    uint64_t end = disk_bytes_;
+    if (it != free_space_.begin() &&
+        std::prev(it)->first + std::prev(it)->second == end)
+    {
+        --it;
+        end = it->first;
+    }
+
+    if (end == 0)
+        return false;
+
+    // the allocated region starts after the preceding free region
+    pos = (it == free_space_.begin())
+          ? 0 : std::prev(it)->first + std::prev(it)->second;
+    size = end - pos;
+    return true;
+}
+
+bool disk_block_allocator::allocate_region_below(
+    uint64_t size, uint64_t limit, uint64_t& pos)
+{
+    if (block_size_ != 0)
+    {
+        const size_t n = size / block_size_;
+        const size_t block = bitmap_.allocate(n);
+        if (block == block_bitmap::npos)
+            return false;
+
+        if ((block + n) * block_size_ > limit) {
+            bitmap_.set_free(block, n);
+            return false;
+        }
+
+        pos = block * block_size_;
+        return true;
+    }
+
+    auto it = find_first_fit(size, 0);
+    if (it == free_space_.end() || it->first + size > limit)
+        return false;
+
+    const uint64_t region_pos = it->first;
+    const uint64_t region_size = it->second;
+    erase_free_region(it);
+
+    if (region_size > size)
+        insert_free_region(region_pos + size, region_size - size);
+
+    pos = region_pos;
+    return true;
+}
+
+uint64_t disk_block_allocator::compact(
+    uint64_t max_bytes, const relocate_function& relocate)
+{
+    if (thread_cache_ != 0) {
+        FOXXLL_THROW(
+            bad_parameter,
+            "disk_block_allocator::compact() cannot move the blocks of "
+            "thread caches, it is not supported with thread_cache"
+        );
+    }
+
+    std::unique_lock<std::mutex> compact_lock(compact_mutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    uint64_t moved = 0;
+    uint64_t from, size, to;
+
+    while (last_allocated_region(from, size) &&
+           from + size > cfg_bytes_ && moved + size <= max_bytes &&
+           !overlaps_extent(from, size))
+    {
+        if (!allocate_region_below(size, from, to))
+            break;
+
+        if (!discard_space_.empty())
+            remove_discard_region(to, size);
+        free_bytes_ -= size;
+
+        // both regions stay allocated while the data is moved, blocks freed
+        // by their owner meanwhile are collected in relocating_frees_
+        relocating_pos_ = from;
+        relocating_size_ = size;
+
+        lock.unlock();
+        const bool relocated = relocate(from, to, size);
+        lock.lock();
+
+        relocating_size_ = 0;
+        std::vector<place> freed;
+        freed.swap(relocating_frees_);
+
+        // the deferred frees, at the new location if the data was moved
+        const uint64_t shift = relocated ? to : from;
+        for (const place& region : freed)
+        {
+            uint64_t pos = region.first - from + shift, bytes = region.second;
+            add_free_region(pos, bytes);
+            if (discard_batch_ == 0 || add_discard_region(pos, bytes))
+                storage_->discard(pos, bytes);
+        }
+
+        if (!relocated) {
+            add_free_region(to, size);
+            break;
+        }
+
+        TLX_LOG << "disk_block_allocator::compact() moved " << size
+                << " bytes from " << from << " to " << to;
+
+        add_free_region(from, size);
+        moved += size;
+    }
+
+    shrink_file(1);
+
+    return moved;
+}
+
+void disk_block_allocator::register_thread_cache()
+{
+    std::unique_lock<std::mutex> lock(thread_cache_type::registry_mutex_);
+    serial_ = ++thread_cache_type::last_serial_;
+    thread_cache_type::live_serials_.insert(serial_);
+}
+
+void disk_block_allocator::unregister_thread_cache()
+{
+    // blocks still cached by running threads are dropped, they vanish
+    // together with the allocator.
+    std::unique_lock<std::mutex> lock(thread_cache_type::registry_mutex_);
+    thread_cache_type::live_serials_.erase(serial_);
+}
+
+bool disk_block_allocator::take_cached_block(uint64_t size, uint64_t& pos)
+{
+    thread_cache_type::entry& e = thread_cache_type::get().find(this, size);
+
+    if (e.offsets.empty())
+    {
+        // refill with one batch, allocated with a single lock acquisition
+        if (!has_available_space(size * thread_cache_))
+            return false;
+
+        std::vector<BID<0> > bids(thread_cache_, BID<0>(storage_, 0, size));
+        allocate_blocks(bids.begin(), bids.end());
+
+        // hand out the lowest offsets first
+        for (auto it = bids.rbegin(); it != bids.rend(); ++it)
+            e.offsets.push_back(it->offset);
+    }
+
+    pos = e.offsets.back();
+    e.offsets.pop_back();
+
+    // blocks are counted when handed out, not when the cache is refilled
+    stats_.allocated(1, size);
+    return true;
+}
+
+void disk_block_allocator::put_cached_block(uint64_t pos, uint64_t size)
+{
+    thread_cache_type::entry& e = thread_cache_type::get().find(this, size);
+
+    // the cache holds at most 2 * thread_cache_ blocks, a block freed twice
+    // by this thread is found by a linear scan. One freed again after it
+    // was drained is reported by add_free_region() at the next drain.
+    if (std::find(e.offsets.begin(), e.offsets.end(), pos) != e.offsets.end())
+    {
+        FOXXLL_THROW2(
+            bad_ext_alloc, "disk_block_allocator::put_cached_block",
+            "Error: double deallocation of external memory, trying to deallocate "
+            "block " << pos << " + " << size << " which is in the thread cache"
+        );
+    }
+
+    stats_.freed(1, size);
+
+    // drain the oldest half back to the allocator if full
+    if (e.offsets.size() >= 2 * thread_cache_)
+        release_cached_blocks(e.offsets, thread_cache_, size);
+
+    e.offsets.push_back(pos);
+}
+
+void disk_block_allocator::release_cached_blocks(
+    std::vector<uint64_t>& offsets, size_t count, uint64_t size)
+{
+    std::vector<place> regions;
+    regions.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        regions.emplace_back(offsets[i], size);
+
+    offsets.erase(offsets.begin(), offsets.begin() + count);
+
+    free_regions(regions);
+}
+
+bool disk_block_allocator::defer_relocating_free(place& region, place& rest)
+{
+    const uint64_t end = region.first + region.second;
+    const uint64_t relocating_end = relocating_pos_ + relocating_size_;
+
+    if (relocating_size_ == 0 ||
+        end <= relocating_pos_ || region.first >= relocating_end)
+        return false;
+
+    const uint64_t begin = std::max(region.first, relocating_pos_);
+    const uint64_t stop = std::min(end, relocating_end);
+    relocating_frees_.emplace_back(begin, stop - begin);
+
+    rest = place(stop, end - stop);
+    region.second = begin - region.first;
+    return true;
+}
+
+void disk_block_allocator::delete_region(uint64_t pos, uint64_t size)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    stats_.freed(1, size);
+
+    place parts[2] = { place(pos, size), place(0, 0) };
+    defer_relocating_free(parts[0], parts[1]);
+
+    size_t discards = 0;
+    for (const place& part : parts)
+    {
+        if (part.second == 0)
+            continue;
+
+        add_free_region(part.first, part.second);
+
+        place discard = part;
+        if (discard_batch_ == 0 ||
+            add_discard_region(discard.first, discard.second))
+            parts[discards++] = discard;
+    }
+
+    if (shrink_bytes_ != 0)
+        shrink_file(shrink_bytes_);
+
+    // discard with the lock held: once unlocked, the region may be
+    // allocated again and written before the discard.
+    for (size_t i = 0; i < discards; ++i)
+    {
+        if (clip_to_file(parts[i].first, parts[i].second))
+            storage_->discard(parts[i].first, parts[i].second);
+    }
+}
+
+void disk_block_allocator::delete_regions(std::vector<place>& regions)
+{
+    if (regions.empty())
+        return;
+
+    uint64_t freed_bytes = 0;
+    for (const place& region : regions)
+        freed_bytes += region.second;
+    stats_.freed(regions.size(), freed_bytes);
+
+    free_regions(regions);
+}
+
+void disk_block_allocator::free_regions(std::vector<place>& regions)
+{
+    if (regions.empty())
+        return;
+
+    // coalesce adjacent blocks in place. Overlapping ones are left apart,
+    // such that add_free_region() reports them as double deallocation.
+    std::sort(regions.begin(), regions.end());
+
+    size_t merged = 0;
+    for (size_t i = 1; i < regions.size(); ++i)
+    {
+        if (regions[merged].first + regions[merged].second == regions[i].first)
+            regions[merged].second += regions[i].second;
+        else
+            regions[++merged] = regions[i];
+    }
+    regions.resize(merged + 1);
+
+    size_t discards = 0;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        TLX_LOG << "disk_block_allocator::delete_regions(" << regions.size()
+                << " regions), free:" << free_bytes_ << " total:" << disk_bytes_;
+
+        // parts within the region moved by compact() are freed later
+        if (relocating_size_ != 0)
+        {
+            std::vector<place> outside;
+            for (place region : regions)
+            {
+                place rest(0, 0);
+                defer_relocating_free(region, rest);
+                if (region.second != 0)
+                    outside.push_back(region);
+                if (rest.second != 0)
+                    outside.push_back(rest);
+            }
+            regions.swap(outside);
+        }
+
+        for (const place& region : regions)
+        {
+            add_free_region(region.first, region.second);
+
+            // keep the regions to discard now in the front of the vector
+            uint64_t discard_pos = region.first, discard_size = region.second;
+            if (discard_batch_ == 0 ||
+                add_discard_region(discard_pos, discard_size))
+                regions[discards++] = place(discard_pos, discard_size);
+        }
+
+        if (shrink_bytes_ != 0)
+        {
+            shrink_file(shrink_bytes_);
+
+            size_t kept = 0;
+            for (size_t i = 0; i < discards; ++i)
+            {
+                if (clip_to_file(regions[i].first, regions[i].second))
+                    regions[kept++] = regions[i];
+            }
+            discards = kept;
+        }
+
+        // discard with the lock held: once unlocked, the regions may be
+        // allocated again and written before the discard.
+        for (size_t i = 0; i < discards; ++i)
+            storage_->discard(regions[i].first, regions[i].second);
+    }
+}
+
 } // namespace foxxll
 
 /**************************************************************************/
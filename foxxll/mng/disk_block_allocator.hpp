@@ -17,20 +17,29 @@
 #define FOXXLL_MNG_DISK_BLOCK_ALLOCATOR_HEADER
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <functional>
 #include <map>
 #include <mutex>
 #include <ostream>
+#include <set>
 #include <utility>
+#include <vector>
 
 #include <tlx/logger/core.hpp>
 
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/common/exceptions.hpp>
+#include <foxxll/common/timer.hpp>
 #include <foxxll/common/types.hpp>
+#include <foxxll/common/utils.hpp>
 #include <foxxll/io/file.hpp>
 #include <foxxll/mng/bid.hpp>
+#include <foxxll/mng/block_bitmap.hpp>
 #include <foxxll/mng/config.hpp>
+#include <foxxll/mng/disk_allocation_stats.hpp>
 
 namespace foxxll {
 
@@ -41,19 +50,48 @@ namespace foxxll {
  * This class manages allocation of blocks onto a single disk. It contains a map
  * of all currently allocated blocks. The block_manager selects which of the
  * disk_block_allocator objects blocks are drawn from.
+ *
+ * If the disk is configured with a fixed block_size, free blocks are tracked
+ * in a block_bitmap instead, and runs of blocks are allocated first-fit.
+ *
+ * If thread_cache is configured, each thread keeps a cache of free blocks per
+ * disk and block size, refilled and drained in batches of thread_cache blocks.
+ * Single blocks allocated and freed by the same thread then do not lock the
+ * allocator.
  */
 class disk_block_allocator
 {
     constexpr static bool debug = false;
 
 public:
+    //! pair (offset, size) used for free space calculation
+    using place = std::pair<uint64_t, uint64_t>;
+
+    //! Compaction hook: moves the data of the allocated region [from, from +
+    //! size) to the free region at to, and updates all BIDs referring to it.
+    //! Returns false if the region cannot be moved, e.g. because it is in use.
+    using relocate_function =
+        std::function<bool(uint64_t from, uint64_t to, uint64_t size)>;
+
     disk_block_allocator(file* storage, const disk_config& cfg)
         : cfg_bytes_(cfg.size),
           storage_(storage),
-          autogrow_(cfg.autogrow)
+          autogrow_(cfg.autogrow),
+          prealloc_(cfg.prealloc),
+          placement_(cfg.placement),
+          discard_batch_(cfg.discard_batch),
+          block_size_(cfg.block_size),
+          thread_cache_(cfg.thread_cache),
+          shrink_bytes_(cfg.shrink),
+          persistent_(!cfg.metadata.empty())
     {
-        // initial growth to configured file size
-        grow_file(cfg.size);
+        // initial growth to configured file size. The file of a disk with
+        // metadata may hold blocks of a previous run, it is sized by restore().
+        if (!persistent_)
+            grow_file(cfg.size);
+
+        if (thread_cache_ != 0)
+            register_thread_cache();
     }
 
     //! non-copyable: delete copy-constructor
@@ -63,7 +101,15 @@ public:
 
     ~disk_block_allocator()
     {
-        if (disk_bytes_ > cfg_bytes_) { // reduce to original size
+        if (thread_cache_ != 0)
+            unregister_thread_cache();
+
+        flush_discard_regions();
+
+        if (persistent_) { // keep the allocated blocks
+            shrink_file(1);
+        }
+        else if (disk_bytes_ > cfg_bytes_) { // reduce to original size
             storage_->set_size(cfg_bytes_);
         }
     }
@@ -71,6 +117,12 @@ public:
     //! Returns autogrow
     bool autogrow() const { return autogrow_; }
 
+    //! Returns the number of blocks per block size cached by each thread
+    size_t thread_cache() const { return thread_cache_; }
+
+    //! Returns the fixed block size, or 0 if blocks of any size are allowed
+    uint64_t block_size() const { return block_size_; }
+
     bool has_available_space(uint64_t bytes) const
     {
         return autogrow_ || free_bytes_ >= bytes;
@@ -91,6 +143,29 @@ public:
         return disk_bytes_;
     }
 
+    //! Returns the number of free regions
+    size_t free_region_count()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (block_size_ != 0)
+            return bitmap_.free_run_count();
+        return free_space_.size();
+    }
+
+    //! Returns the size of the largest free region
+    uint64_t largest_free_region()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (block_size_ != 0)
+            return bitmap_.longest_free_run() * block_size_;
+        return size_index_.empty() ? 0 : size_index_.rbegin()->first;
+    }
+
+    //! Returns the allocation statistics and the state of the free space.
+    //! With a fixed block size, the bitmap is copied with the lock held and
+    //! its free runs are counted afterwards in O(n).
+    disk_allocation_stats_data allocation_stats();
+
     template <size_t BlockSize>
     void new_blocks(BIDArray<BlockSize>& bids)
     {
@@ -98,40 +173,147 @@ public:
     }
 
     template <typename BIDIterator>
-    void new_blocks(BIDIterator begin, BIDIterator end);
+    void new_blocks(BIDIterator begin, BIDIterator end)
+    {
+        if (thread_cache_ != 0 && begin + 1 == end &&
+            take_cached_block(begin->size, begin->offset))
+            return;
+
+        allocate_blocks(begin, end);
+
+        uint64_t bytes = 0;
+        for (BIDIterator cur = begin; cur != end; ++cur)
+            bytes += cur->size;
+        stats_.allocated(static_cast<uint64_t>(end - begin), bytes);
+    }
 
     template <size_t BlockSize>
     void delete_blocks(const BIDArray<BlockSize>& bids)
     {
+        std::vector<place> regions;
+        regions.reserve(bids.size());
         for (size_t i = 0; i < bids.size(); ++i)
-            delete_block(bids[i]);
+            regions.emplace_back(bids[i].offset, static_cast<uint64_t>(bids[i].size));
+        delete_regions(regions);
+    }
+
+    //! Initializes the free space of a disk with metadata as the complement
+    //! of the allocated regions, which were saved by a previous run in a file
+    //! of disk_bytes bytes. The file is resized to at least the configured
+    //! size. The regions are sorted.
+    void restore(uint64_t disk_bytes, std::vector<place>& allocated);
+
+    //! Allocates one contiguous extent of bytes (rounded up to the block size)
+    //! from which the caller carves blocks, see block_extent_allocator. Grows
+    //! the file if needed and allowed. Returns false if there is no such
+    //! region. The extent stays open until release_extent().
+    bool reserve_extent(uint64_t& bytes, uint64_t& pos);
+
+    //! Closes the extent reserved at extent_pos and frees its uncarved tail
+    //! [pos, pos + size), which may be empty.
+    void release_extent(uint64_t extent_pos, uint64_t pos, uint64_t size);
+
+    //! Counts a block carved from an extent as allocated. Its bytes were
+    //! counted when the extent was reserved.
+    void count_carved_block()
+    {
+        stats_.allocated(1, 0);
     }
 
+    /*!
+     * Moves allocated regions from the end of an autogrown file to free
+     * regions further in front using \b relocate, then truncates the free end
+     * of the file, never below the configured size.
+     *
+     * With a fixed block size single blocks are moved, otherwise whole
+     * allocated regions, as block boundaries are not known. Moving stops
+     * after max_bytes, if no free region in front fits, if relocate fails, or
+     * at a region overlapping an open extent, whose tail has no owner.
+     * Returns the number of bytes moved.
+     *
+     * Throws bad_parameter on disks with thread_cache, as the blocks cached
+     * by threads have no owner either.
+     *
+     * Blocks freed within a region while it is moved are freed once relocate
+     * returned, at their new location if it succeeded.
+     */
+    uint64_t compact(uint64_t max_bytes, const relocate_function& relocate);
+
+    //! Frees a batch of blocks given as (offset, size) places, bypassing the
+    //! thread cache. The places are sorted and adjacent ones coalesced, then
+    //! all are freed with one lock acquisition and one discard per merged
+    //! region, issued with the lock held. The vector is reordered.
+    void delete_regions(std::vector<place>& regions);
+
     template <size_t BlockSize>
     void delete_block(const BID<BlockSize>& bid)
     {
-        std::unique_lock<std::mutex> lock(mutex_);
+        if (thread_cache_ != 0) {
+            put_cached_block(bid.offset, bid.size);
+            return;
+        }
 
         TLX_LOG0 << "disk_block_allocator::delete_block<" << BlockSize
                  << ">(pos=" << bid.offset << ", size=" << size_t(bid.size)
                  << "), free:" << free_bytes_ << " total:" << disk_bytes_;
 
-        add_free_region(bid.offset, bid.size);
+        delete_region(bid.offset, bid.size);
     }
 
 private:
-    //! pair (offset, size) used for free space calculation
-    using place = std::pair<uint64_t, uint64_t>;
     using space_map_type = std::map<uint64_t, uint64_t>;
 
     std::mutex mutex_;
     //! map of free space as places
     space_map_type free_space_;
-    uint64_t free_bytes_ = 0;
-    uint64_t disk_bytes_ = 0;
+    //! free space ordered by (size, offset), index for free_space_
+    std::set<place> size_index_;
+    //! free space by offset, split into classes of sizes [2^i, 2^(i+1))
+    std::array<space_map_type, 64> size_classes_;
+    //! bit i is set if size_classes_[i] is not empty
+    uint64_t size_class_mask_ = 0;
+    //! free and total bytes, modified with mutex_ locked but read without it
+    std::atomic<uint64_t> free_bytes_ { 0 };
+    std::atomic<uint64_t> disk_bytes_ { 0 };
     uint64_t cfg_bytes_;
     file* storage_;
     bool autogrow_;
+    //! allocate disk space of the file when growing it
+    bool prealloc_;
+    //! placement policy choosing among the free regions
+    disk_config::placement_type placement_;
+    //! position after the last allocation, used by next-fit
+    uint64_t next_fit_pos_ = 0;
+    //! minimum size of coalesced freed regions before they are discarded
+    uint64_t discard_batch_;
+    //! freed regions not yet discarded, only used if discard_batch_ != 0
+    space_map_type discard_space_;
+    //! fixed size of all blocks, 0 if blocks of any size are allocated
+    uint64_t block_size_;
+    //! free blocks, only used if block_size_ != 0
+    block_bitmap bitmap_;
+    //! number of blocks of each size cached per thread, 0 -> no caching
+    size_t thread_cache_;
+    //! truncate the file when this many bytes at its end are free, 0 -> never
+    uint64_t shrink_bytes_;
+    //! blocks outlive the program, the disk is sized by restore()
+    bool persistent_;
+    //! unique number of this allocator, identifies it in thread caches
+    uint64_t serial_ = 0;
+    //! counters of allocations
+    disk_allocation_stats stats_;
+    //! serializes compact()
+    std::mutex compact_mutex_;
+    //! region compact() moves with mutex_ unlocked, relocating_size_ == 0 if
+    //! none. Frees within it are deferred until the move finished.
+    uint64_t relocating_pos_ = 0, relocating_size_ = 0;
+    //! regions freed within the moved region, kept in relocating_frees_
+    std::vector<place> relocating_frees_;
+    //! extents reserved and not yet released, which compact() must not move
+    space_map_type extents_;
+
+    //! per-thread cache of free blocks, defined in disk_block_allocator.cpp
+    class thread_cache_type;
 
     void dump() const;
 
@@ -143,20 +325,142 @@ private:
     // expects the mutex_ to be locked to prevent concurrent access
     void add_free_region(uint64_t block_pos, uint64_t block_size);
 
+    //! insert a free region into free_space_ and its indexes
+    void insert_free_region(uint64_t pos, uint64_t size);
+
+    //! erase a free region from free_space_ and its indexes
+    void erase_free_region(space_map_type::iterator it);
+
+    //! find a free region of at least size bytes according to the placement
+    //! policy, returns free_space_.end() if there is none.
+    space_map_type::iterator find_free_region(uint64_t size);
+
+    //! Finds the free region of at least size bytes with the lowest offset
+    //! at or after start, or returns free_space_.end(). Takes the first
+    //! region of each larger size class, all of which fit, and scans the
+    //! class of size only up to the best of these.
+    space_map_type::iterator find_first_fit(uint64_t size, uint64_t start);
+
+    //! allocate a contiguous region of size bytes from the free regions or
+    //! the bitmap. Returns false if there is none. Expects the mutex_ to be
+    //! locked.
+    bool allocate_region(uint64_t size, uint64_t& pos);
+
+    //! Adds a freed region to the regions pending discard and coalesces it
+    //! with its neighbors. Returns true and the coalesced region in pos and
+    //! size if it reached discard_batch_ bytes and must be discarded now.
+    //! Expects the mutex_ to be locked.
+    bool add_discard_region(uint64_t& pos, uint64_t& size);
+
+    //! Removes a newly allocated region from the regions pending discard.
+    //! Expects the mutex_ to be locked.
+    void remove_discard_region(uint64_t pos, uint64_t size);
+
+    //! Discards all pending regions.
+    void flush_discard_regions();
+
+    //! Frees a block: adds it to the free space and discards it now or once
+    //! it coalesced to discard_batch_ bytes.
+    void delete_region(uint64_t pos, uint64_t size);
+
+    //! If a freed region overlaps the region moved by compact(), keeps the
+    //! overlap in relocating_frees_ and returns true and the parts before
+    //! and after it in region and rest, which may be empty. Expects the
+    //! mutex_ to be locked.
+    bool defer_relocating_free(place& region, place& rest);
+
+    //! Truncates the free end of the file if it has at least min_bytes
+    //! beyond the configured size. Expects the mutex_ to be locked.
+    void shrink_file(uint64_t min_bytes);
+
+    //! Clips a region to discard to the file size, which may have shrunk.
+    //! Returns false if nothing is left. Expects the mutex_ to be locked.
+    bool clip_to_file(uint64_t pos, uint64_t& size) const
+    {
+        if (pos >= disk_bytes_)
+            return false;
+        size = std::min<uint64_t>(size, disk_bytes_ - pos);
+        return true;
+    }
+
+    //! whether [pos, pos + size) overlaps an open extent. Expects the mutex_
+    //! to be locked.
+    bool overlaps_extent(uint64_t pos, uint64_t size) const;
+
+    //! Finds the last allocated region before the free end of the file.
+    //! Returns false if nothing is allocated. Expects the mutex_ to be locked.
+    bool last_allocated_region(uint64_t& pos, uint64_t& size) const;
+
+    //! allocate the region [pos, pos + size), returns false if it is not
+    //! entirely free. Expects the mutex_ to be locked.
+    bool take_region(uint64_t pos, uint64_t size);
+
+    //! allocate a contiguous region of size bytes ending at or before limit,
+    //! at the lowest offset. Expects the mutex_ to be locked.
+    bool allocate_region_below(uint64_t size, uint64_t limit, uint64_t& pos);
+
+    //! allocate blocks in [begin, end) from the free space, bypassing the
+    //! thread cache. The blocks are counted by the caller.
+    template <typename BIDIterator>
+    void allocate_blocks(BIDIterator begin, BIDIterator end);
+
+    //! Takes a free block of size bytes from the calling thread's cache,
+    //! refilling it if empty. Returns false if the cache cannot be refilled.
+    bool take_cached_block(uint64_t size, uint64_t& pos);
+
+    //! Puts a freed block into the calling thread's cache, draining half of
+    //! it if full. Throws bad_ext_alloc if the block is in the cache already.
+    void put_cached_block(uint64_t pos, uint64_t size);
+
+    //! Frees regions like delete_regions(), without counting them.
+    void free_regions(std::vector<place>& regions);
+
+    //! Frees the first count blocks in offsets with one lock acquisition and
+    //! removes them from offsets.
+    void release_cached_blocks(
+        std::vector<uint64_t>& offsets, size_t count, uint64_t size);
+
+    //! (un)register this allocator as a valid target of thread caches
+    void register_thread_cache();
+    void unregister_thread_cache();
+
     // expects the mutex_ to be locked to prevent concurrent access
     void grow_file(uint64_t extend_bytes)
     {
         if (extend_bytes == 0)
             return;
 
-        storage_->set_size(disk_bytes_ + extend_bytes);
-        add_free_region(disk_bytes_, extend_bytes);
+        // keep the file a multiple of the block size
+        if (block_size_ != 0)
+            extend_bytes = div_ceil(extend_bytes, block_size_) * block_size_;
+
+        if (prealloc_)
+            storage_->preallocate(disk_bytes_ + extend_bytes);
+        else
+            storage_->set_size(disk_bytes_ + extend_bytes);
+
+        if (block_size_ != 0) {
+            bitmap_.grow((disk_bytes_ + extend_bytes) / block_size_);
+            free_bytes_ += extend_bytes;
+        }
+        else {
+            add_free_region(disk_bytes_, extend_bytes);
+        }
         disk_bytes_ += extend_bytes;
     }
+
+    //! grows the file for an allocation and counts the growth. Expects the
+    //! mutex_ to be locked.
+    void grow_for_allocation(uint64_t extend_bytes)
+    {
+        const uint64_t old_bytes = disk_bytes_;
+        grow_file(extend_bytes);
+        stats_.grown(disk_bytes_ - old_bytes);
+    }
 };
 
 template <typename BIDIterator>
-void disk_block_allocator::new_blocks(BIDIterator begin, BIDIterator end)
+void disk_block_allocator::allocate_blocks(BIDIterator begin, BIDIterator end)
 {
     uint64_t requested_size = 0;
 
@@ -164,9 +468,19 @@ void disk_block_allocator::new_blocks(BIDIterator begin, BIDIterator end)
     {
         TLX_LOG << "Asking for a block with size: " << cur->size;
         requested_size += cur->size;
+
+        if (block_size_ != 0 && cur->size != block_size_) {
+            FOXXLL_THROW(
+                bad_ext_alloc,
+                "Block of " << cur->size << " bytes requested on a disk "
+                "configured for block_size=" << block_size_
+            );
+        }
     }
 
+    const ticks_type lock_begin = timestamp_ticks();
     std::unique_lock<std::mutex> lock(mutex_);
+    const ticks_type locked = timestamp_ticks();
 
     TLX_LOG << "disk_block_allocator::new_blocks<BlockSize>"
         ", BlockSize = " << begin->size <<
@@ -190,20 +504,15 @@ void disk_block_allocator::new_blocks(BIDIterator begin, BIDIterator end)
             << " bytes requested, " << free_bytes_
             << " bytes free. Trying to extend the external memory space...";
 
-        grow_file(requested_size);
+        grow_for_allocation(requested_size);
     }
 
     // dump();
 
-    space_map_type::iterator space =
-        std::find_if(
-            free_space_.begin(), free_space_.end(),
-            [requested_size](const place& entry) {
-                return (entry.second >= requested_size);
-            }
-        );
+    uint64_t region_pos = 0;
+    bool found = allocate_region(requested_size, region_pos);
 
-    if (space == free_space_.end() && begin + 1 == end)
+    if (!found && begin + 1 == end)
     {
         if (!autogrow_) {
             TLX_LOG1 << "Warning: Severe external memory space fragmentation!";
@@ -214,24 +523,15 @@ void disk_block_allocator::new_blocks(BIDIterator begin, BIDIterator end)
                 " bytes free. Trying to extend the external memory space...";
         }
 
-        grow_file(begin->size);
+        grow_for_allocation(begin->size);
 
-        space = std::find_if(
-                free_space_.begin(), free_space_.end(),
-                [requested_size](const place& entry) {
-                    return (entry.second >= requested_size);
-                }
-            );
+        found = allocate_region(requested_size, region_pos);
     }
 
-    if (space != free_space_.end())
+    if (found)
     {
-        uint64_t region_pos = (*space).first;
-        uint64_t region_size = (*space).second;
-        free_space_.erase(space);
-
-        if (region_size > requested_size)
-            free_space_[region_pos + requested_size] = region_size - requested_size;
+        if (!discard_space_.empty())
+            remove_discard_region(region_pos, requested_size);
 
         for (uint64_t pos = region_pos; begin != end; ++begin)
         {
@@ -243,6 +543,7 @@ void disk_block_allocator::new_blocks(BIDIterator begin, BIDIterator end)
         free_bytes_ -= requested_size;
         //dump();
 
+        stats_.locked(locked - lock_begin, timestamp_ticks() - locked);
         return;
     }
 
@@ -252,11 +553,13 @@ void disk_block_allocator::new_blocks(BIDIterator begin, BIDIterator end)
 
     assert(end - begin > 1);
 
+    stats_.split();
+    stats_.locked(locked - lock_begin, timestamp_ticks() - locked);
     lock.unlock();
 
     BIDIterator middle = begin + ((end - begin) / 2);
-    new_blocks(begin, middle);
-    new_blocks(middle, end);
+    allocate_blocks(begin, middle);
+    allocate_blocks(middle, end);
 }
 
 //! \}
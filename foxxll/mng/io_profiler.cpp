@@ -0,0 +1,262 @@
+/***************************************************************************
+ *  foxxll/mng/io_profiler.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/mng/io_profiler.hpp>
+
+#include <foxxll/config.hpp>
+
+#if FOXXLL_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#else
+ #include <sys/resource.h>
+ #include <sys/time.h>
+#endif
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include <tlx/logger/core.hpp>
+
+#include <foxxll/common/timer.hpp>
+#include <foxxll/mng/config.hpp>
+
+namespace foxxll {
+
+//! innermost open phase of the calling thread, nullptr if none
+static thread_local io_profiler::phase* s_current_phase = nullptr;
+
+io_profiler::io_profiler()
+{
+    // create config first, such that it is destroyed after the profiler,
+    // which reads the disks' bandwidths when reporting at exit
+    config::get_instance();
+}
+
+io_profiler::~io_profiler()
+{
+    if (report_at_exit_ && !root_.children.empty())
+    {
+        std::ostringstream oss;
+        report(oss);
+        TLX_LOG1 << oss.str();
+    }
+}
+
+double io_profiler::process_cpu_time()
+{
+#if FOXXLL_WINDOWS
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0.0;
+    auto seconds = [](const FILETIME& ft) {
+                       return static_cast<double>(
+                           (static_cast<uint64_t>(ft.dwHighDateTime) << 32)
+                           | ft.dwLowDateTime) * 1e-7;
+                   };
+    return seconds(kernel) + seconds(user);
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.0;
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+           + static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+double io_profiler::get_peak_bandwidth()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (peak_bandwidth_ >= 0.0)
+            return peak_bandwidth_;
+    }
+
+    // disks are used in parallel, hence their bandwidths add up. If any
+    // disk's bandwidth is unknown, so is the peak.
+    config* cfg = config::get_instance();
+    double peak = 0.0;
+    for (size_t i = 0; i < cfg->disks_number(); ++i)
+    {
+        if (cfg->disk(i).bandwidth == 0)
+            return 0.0;
+        peak += static_cast<double>(cfg->disk(i).bandwidth);
+    }
+    return peak;
+}
+
+void io_profiler::set_peak_bandwidth(double bytes_per_second)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    peak_bandwidth_ = bytes_per_second;
+}
+
+void io_profiler::set_report_at_exit(bool report_at_exit)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    report_at_exit_ = report_at_exit;
+}
+
+void io_profiler::clear()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    root_.children.clear();
+}
+
+io_profiler::phase* io_profiler::enter(const std::string& name)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    phase* parent = s_current_phase ? s_current_phase : &root_;
+
+    for (const std::unique_ptr<phase>& child : parent->children)
+    {
+        if (child->name == name)
+            return s_current_phase = child.get();
+    }
+
+    parent->children.emplace_back(new phase(name, parent));
+    return s_current_phase = parent->children.back().get();
+}
+
+void io_profiler::leave(phase* p, double wall_time, double cpu_time,
+                        const stats_data& io)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    assert(s_current_phase == p);
+
+    p->count++;
+    p->wall_time += wall_time;
+    p->cpu_time += cpu_time;
+    p->read_bytes += io.get_read_bytes();
+    p->write_bytes += io.get_write_bytes();
+    p->wait_read_time += io.get_wait_read_time();
+    p->wait_write_time += io.get_wait_write_time();
+    p->io_time += io.get_pio_time();
+
+    s_current_phase = (p->parent == &root_) ? nullptr : p->parent;
+}
+
+//! width of the phase name column of the subtree
+static size_t name_width(const io_profiler::phase& p, size_t depth)
+{
+    size_t width = 2 * depth + p.name.size();
+    for (const auto& child : p.children)
+        width = std::max(width, name_width(*child, depth + 1));
+    return width;
+}
+
+//! print a phase and its subphases, indented by depth
+static void report_phase(std::ostream& os, const io_profiler::phase& p,
+                         size_t depth, size_t width, double peak)
+{
+    constexpr double one_mib = 1024.0 * 1024;
+
+    const double wait = p.wait_read_time + p.wait_write_time;
+    const double bandwidth =
+        p.wall_time > 0.0
+        ? static_cast<double>(p.read_bytes + p.write_bytes) / p.wall_time : 0.0;
+
+    os << ' ' << std::string(2 * depth, ' ')
+       << std::left << std::setw(static_cast<int>(width - 2 * depth)) << p.name
+       << std::right
+       << std::setw(7) << p.count
+       << std::setprecision(3)
+       << std::setw(10) << p.wall_time
+       << std::setw(10) << p.cpu_time
+       << std::setw(12) << add_IEC_binary_multiplier(p.read_bytes, "B")
+       << std::setw(12) << add_IEC_binary_multiplier(p.write_bytes, "B")
+       << std::setw(10) << wait
+       << std::setprecision(1)
+       << std::setw(9)
+       << (p.wall_time > 0.0 ? 100.0 * p.io_time / p.wall_time : 0.0) << '%'
+       << std::setw(10) << bandwidth / one_mib;
+    if (peak > 0.0)
+        os << std::setw(8) << 100.0 * bandwidth / peak << '%';
+    else
+        os << std::setw(9) << "-";
+
+    if (wait >= 0.5 * p.wall_time && p.wall_time > 0.0)
+        os << "  I/O-bound";
+    else if (p.io_time < 0.5 * p.wall_time && p.cpu_time >= 0.5 * p.wall_time)
+        os << "  CPU-bound, disks idle";
+    os << '\n';
+
+    for (const auto& child : p.children)
+        report_phase(os, *child, depth + 1, width, peak);
+}
+
+void io_profiler::report(std::ostream& os)
+{
+    const double peak = get_peak_bandwidth();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    size_t width = 5;
+    for (const auto& child : root_.children)
+        width = std::max(width, name_width(*child, 0));
+
+    const std::ios::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(1);
+
+    os << "I/O profile, peak bandwidth ";
+    if (peak > 0.0)
+        os << peak / (1024.0 * 1024) << " MiB/s\n";
+    else
+        os << "unknown (set bandwidth= of the disks)\n";
+
+    os << ' ' << std::left << std::setw(static_cast<int>(width)) << "phase"
+       << std::right
+       << std::setw(7) << "count"
+       << std::setw(10) << "wall s"
+       << std::setw(10) << "CPU s"
+       << std::setw(12) << "read"
+       << std::setw(12) << "written"
+       << std::setw(10) << "wait s"
+       << std::setw(10) << "disks"
+       << std::setw(10) << "MiB/s"
+       << std::setw(9) << "of peak"
+       << '\n';
+
+    for (const auto& child : root_.children)
+        report_phase(os, *child, 0, width, peak);
+
+    os.precision(precision);
+    os.flags(flags);
+}
+
+/******************************************************************************/
+// scoped_io_phase
+
+scoped_io_phase::scoped_io_phase(const std::string& name)
+    : phase_(io_profiler::get_instance()->enter(name)),
+      begin_time_(timestamp()),
+      begin_cpu_(io_profiler::process_cpu_time()),
+      begin_io_(*stats::get_instance())
+{ }
+
+scoped_io_phase::~scoped_io_phase()
+{
+    const stats_data io = stats_data(*stats::get_instance()) - begin_io_;
+    const double cpu = io_profiler::process_cpu_time() - begin_cpu_;
+    io_profiler::get_instance()->leave(
+        phase_, timestamp() - begin_time_, cpu, io);
+}
+
+} // namespace foxxll
+
+/**************************************************************************/
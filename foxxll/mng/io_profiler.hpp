@@ -0,0 +1,172 @@
+/***************************************************************************
+ *  foxxll/mng/io_profiler.hpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef FOXXLL_MNG_IO_PROFILER_HEADER
+#define FOXXLL_MNG_IO_PROFILER_HEADER
+
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <foxxll/common/types.hpp>
+#include <foxxll/io/iostats.hpp>
+#include <foxxll/singleton.hpp>
+
+namespace foxxll {
+
+//! \addtogroup foxxll_mnglayer
+//! \{
+
+/*!
+ * Hierarchical profiler attributing I/O volume, I/O wait and CPU time to a
+ * tree of named phases, which are opened by scoped_io_phase.
+ *
+ * For each phase, the profiler sums over all times it was entered: the wall
+ * time, the CPU time of the process, the bytes read and written, the time
+ * threads waited for I/O, and the time during which any I/O was running.
+ * The report rates the achieved bandwidth against the peak bandwidth of the
+ * configured disks (see the bandwidth= option of disk_config), and marks
+ * phases which mostly wait for I/O, and phases during which the disks mostly
+ * idle. The report is logged at program exit if any phase was recorded.
+ *
+ * Each thread nests its phases separately. As I/O statistics are global, the
+ * phases of concurrent threads all see the I/O done during their lifetime.
+ */
+class io_profiler : public singleton<io_profiler>
+{
+    friend class singleton<io_profiler>;
+
+public:
+    //! accumulated measurements of a phase, including its subphases
+    struct phase
+    {
+        std::string name;
+        phase* parent;
+        std::vector<std::unique_ptr<phase> > children;
+
+        //! number of times the phase was entered
+        size_t count = 0;
+        //! seconds of wall time and of CPU time of the process
+        double wall_time = 0.0, cpu_time = 0.0;
+        //! bytes transferred
+        external_size_type read_bytes = 0, write_bytes = 0;
+        //! seconds threads waited for reads/writes to complete
+        double wait_read_time = 0.0, wait_write_time = 0.0;
+        //! seconds during which any I/O was running
+        double io_time = 0.0;
+
+        phase(const std::string& _name, phase* _parent)
+            : name(_name), parent(_parent)
+        { }
+    };
+
+    //! Peak bandwidth of all disks in bytes per second, the sum of the
+    //! bandwidths of the configured disks unless set explicitly. 0 -> unknown.
+    double get_peak_bandwidth();
+
+    //! override the peak bandwidth in bytes per second
+    void set_peak_bandwidth(double bytes_per_second);
+
+    //! whether to log the report at program exit (default: true)
+    void set_report_at_exit(bool report_at_exit);
+
+    //! write the tree of phases with their measurements
+    void report(std::ostream& os);
+
+    //! The tree of phases, whose root is not a phase itself. Must not be
+    //! accessed while other threads open or close phases.
+    const phase & get_root() const
+    {
+        return root_;
+    }
+
+    //! discard all phases, which must not be open
+    void clear();
+
+    //! \name Internal interface of scoped_io_phase
+    //! \{
+
+    //! enter the named subphase of the calling thread's current phase
+    phase * enter(const std::string& name);
+
+    //! leave a phase entered by the calling thread, adding the measurements
+    void leave(phase* p, double wall_time, double cpu_time,
+               const stats_data& io);
+
+    //! CPU time of the process in seconds
+    static double process_cpu_time();
+
+    //! \}
+
+private:
+    //! root of the tree of phases, not a phase itself
+    phase root_ { "", nullptr };
+
+    //! serializes access to the tree
+    std::mutex mutex_;
+
+    //! explicit peak bandwidth, negative if taken from the configuration
+    double peak_bandwidth_ = -1.0;
+
+    bool report_at_exit_ = true;
+
+    io_profiler();
+
+    //! logs the report at exit
+    ~io_profiler();
+};
+
+/*!
+ * Opens a phase of the io_profiler for its lifetime. Phases opened while
+ * another one is open on the same thread become its subphases.
+ *
+ * \code
+ * {
+ *     foxxll::scoped_io_phase sort("sort");
+ *     {
+ *         foxxll::scoped_io_phase runs("run formation");
+ *         ...
+ *     }
+ *     foxxll::scoped_io_phase merge("merge");
+ *     ...
+ * }
+ * \endcode
+ */
+class scoped_io_phase
+{
+    io_profiler::phase* phase_;
+
+    //! measurements at the begin of the phase
+    double begin_time_;
+    double begin_cpu_;
+    stats_data begin_io_;
+
+public:
+    explicit scoped_io_phase(const std::string& name);
+
+    //! non-copyable: delete copy-constructor
+    scoped_io_phase(const scoped_io_phase&) = delete;
+    //! non-copyable: delete assignment operator
+    scoped_io_phase& operator = (const scoped_io_phase&) = delete;
+
+    ~scoped_io_phase();
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !FOXXLL_MNG_IO_PROFILER_HEADER
+
+/**************************************************************************/
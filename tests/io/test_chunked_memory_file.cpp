@@ -0,0 +1,166 @@
+/***************************************************************************
+ *  tests/io/test_chunked_memory_file.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <unistd.h>
+
+#include <cstring>
+#include <vector>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io.hpp>
+
+using foxxll::chunked_memory_file;
+
+static const size_t chunk = chunked_memory_file::chunk_size;
+static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+//! fill buffer with a pattern depending on seed
+static void fill(char* buffer, size_t bytes, size_t seed)
+{
+    for (size_t i = 0; i < bytes; ++i)
+        buffer[i] = static_cast<char>((i * 7 + seed) % 251);
+}
+
+//! whether buffer holds the pattern of fill()
+static bool check(const char* buffer, size_t bytes, size_t seed)
+{
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        if (buffer[i] != static_cast<char>((i * 7 + seed) % 251))
+            return false;
+    }
+    return true;
+}
+
+static bool is_zero(const char* buffer, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        if (buffer[i] != 0)
+            return false;
+    }
+    return true;
+}
+
+//! requests crossing the boundary of two chunks
+void test_chunk_boundary(char* buffer, size_t bytes)
+{
+    chunked_memory_file file(1006);
+    file.set_size(2 * chunk);
+
+    // unaligned requests starting before the boundary
+    for (size_t shift : { size_t(1), page, bytes / 2, bytes - 1 })
+    {
+        const size_t offset = chunk - shift;
+
+        fill(buffer, bytes, shift);
+        file.awrite(buffer, offset, bytes)->wait();
+
+        memset(buffer, 0, bytes);
+        file.aread(buffer, offset, bytes)->wait();
+        die_unless(check(buffer, bytes, shift));
+    }
+
+    // both halves landed in their chunks, read them separately
+    fill(buffer, bytes, 42);
+    file.awrite(buffer, chunk - bytes / 2, bytes)->wait();
+
+    std::vector<char> half(bytes / 2);
+    file.aread(half.data(), chunk - bytes / 2, bytes / 2)->wait();
+    die_unless(memcmp(half.data(), buffer, bytes / 2) == 0);
+    file.aread(half.data(), chunk, bytes / 2)->wait();
+    die_unless(memcmp(half.data(), buffer + bytes / 2, bytes / 2) == 0);
+}
+
+//! growing replaces the chunk table and keeps the data, shrinking and
+//! regrowing yields zeros
+void test_resize(char* buffer, size_t bytes)
+{
+    chunked_memory_file file(1007);
+    file.set_size(chunk + bytes);
+
+    fill(buffer, bytes, 1);
+    file.awrite(buffer, chunk - bytes / 2, bytes)->wait();
+
+    // more chunks than the initial table holds
+    file.set_size(20 * chunk);
+    die_unequal(file.size(), 20 * chunk);
+
+    memset(buffer, 0, bytes);
+    file.aread(buffer, chunk - bytes / 2, bytes)->wait();
+    die_unless(check(buffer, bytes, 1));
+
+    fill(buffer, bytes, 2);
+    file.awrite(buffer, 19 * chunk, bytes)->wait();
+
+    file.set_size(chunk);
+    file.set_size(20 * chunk);
+
+    file.aread(buffer, chunk - bytes / 2, bytes / 2)->wait();
+    die_unless(check(buffer, bytes / 2, 1));
+    file.aread(buffer, chunk, bytes / 2)->wait();
+    die_unless(is_zero(buffer, bytes / 2));
+    file.aread(buffer, 19 * chunk, bytes)->wait();
+    die_unless(is_zero(buffer, bytes));
+}
+
+//! discard() releases the whole pages of the region only
+void test_discard(char* buffer, size_t bytes)
+{
+    chunked_memory_file file(1008);
+    file.set_size(2 * chunk);
+
+    const size_t offset = chunk - bytes / 2;
+    fill(buffer, bytes, 3);
+    file.awrite(buffer, offset, bytes)->wait();
+
+    // the region starts and ends inside pages, which are kept
+    file.discard(offset + 1, bytes - 2);
+
+    std::vector<char> data(bytes);
+    file.aread(data.data(), offset, bytes)->wait();
+
+    die_unless(check(data.data(), 1, 3));
+    die_unless(data[bytes - 1] == buffer[bytes - 1]);
+
+#if !(defined(FOXXLL_MEMFILE_LAZY_FREE) && defined(MADV_FREE))
+    // the whole pages inside the region, on both chunks, read as zeros
+    die_unless(memcmp(data.data(), buffer, page) == 0);
+    die_unless(is_zero(data.data() + page, bytes - 2 * page));
+    die_unless(memcmp(data.data() + bytes - page,
+                      buffer + bytes - page, page) == 0);
+#endif
+
+    // discarded memory is written again
+    fill(buffer, bytes, 4);
+    file.awrite(buffer, offset, bytes)->wait();
+    file.aread(data.data(), offset, bytes)->wait();
+    die_unless(check(data.data(), bytes, 4));
+}
+
+int main()
+{
+    const size_t bytes = 16 * page;
+    char* buffer = static_cast<char*>(
+        foxxll::aligned_alloc<foxxll::BlockAlignment>(bytes));
+
+    test_chunk_boundary(buffer, bytes);
+    test_resize(buffer, bytes);
+    test_discard(buffer, bytes);
+
+    foxxll::aligned_dealloc<foxxll::BlockAlignment>(buffer);
+    return 0;
+}
+
+/**************************************************************************/
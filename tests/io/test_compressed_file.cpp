@@ -0,0 +1,102 @@
+/***************************************************************************
+ *  tests/io/test_compressed_file.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io/compressed_file.hpp>
+
+using foxxll::compressed_file;
+
+static const compressed_file::algorithm_type lz4 = compressed_file::LZ4;
+
+//! compress and decompress data, returns the compressed size
+static size_t roundtrip(const std::vector<char>& data)
+{
+    const size_t bound = compressed_file::compress_bound(lz4, data.size());
+    std::vector<char> packed(bound);
+    const size_t cbytes = compressed_file::compress(
+        lz4, data.data(), data.size(), packed.data(), bound);
+    die_unless(cbytes > 0 && cbytes <= bound);
+
+    std::vector<char> unpacked(data.size() + 1, 'x');
+    die_unless(compressed_file::decompress(
+                   lz4, packed.data(), cbytes, unpacked.data(), data.size()));
+    die_unless(memcmp(unpacked.data(), data.data(), data.size()) == 0);
+    // nothing is written beyond the output size
+    die_unequal(unpacked[data.size()], 'x');
+
+    // truncated input or a wrong output size is rejected
+    if (cbytes > 1) {
+        die_unless(!compressed_file::decompress(
+                       lz4, packed.data(), cbytes - 1, unpacked.data(), data.size()));
+    }
+    die_unless(!compressed_file::decompress(
+                   lz4, packed.data(), cbytes, unpacked.data(), data.size() + 1));
+
+    return cbytes;
+}
+
+static std::vector<char> random_bytes(size_t n, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<char> data(n);
+    for (char& c : data)
+        c = static_cast<char>(rng());
+    return data;
+}
+
+int main()
+{
+    const size_t block_size = 2 * 1024 * 1024;
+
+    // empty and one byte inputs are a single literal sequence
+    die_unequal(roundtrip(std::vector<char>()), 1u);
+    die_unequal(roundtrip(std::vector<char>(1, 'a')), 2u);
+
+    // inputs around the shortest one which may contain a match
+    for (size_t n = 11; n <= 14; ++n)
+        roundtrip(std::vector<char>(n, 0));
+
+    // all zeros shrink to a tiny fraction
+    die_unless(roundtrip(std::vector<char>(block_size, 0)) < block_size / 100);
+
+    // incompressible data grows by at most the bound
+    const std::vector<char> noise = random_bytes(block_size, 1);
+    die_unless(roundtrip(noise) <= compressed_file::compress_bound(lz4, block_size));
+
+    // repetitions at the maximum match offset and beyond it
+    std::vector<char> repeated = random_bytes(65535, 2);
+    repeated.insert(repeated.end(), repeated.begin(), repeated.begin() + 1000);
+    die_unless(roundtrip(repeated) < repeated.size());
+    std::vector<char> distant = random_bytes(65536, 3);
+    distant.insert(distant.end(), distant.begin(), distant.begin() + 1000);
+    roundtrip(distant);
+
+    // the per-thread hash table still holds the positions of the previous
+    // input, a different input must not match against them
+    const std::vector<char> other = random_bytes(block_size, 4);
+    roundtrip(other);
+    roundtrip(std::vector<char>(other.begin(), other.begin() + 4096));
+
+    // a too small output buffer makes compression fail
+    std::vector<char> small(16);
+    die_unequal(compressed_file::compress(
+                    lz4, noise.data(), noise.size(), small.data(), small.size()), 0u);
+
+    return 0;
+}
+
+/**************************************************************************/
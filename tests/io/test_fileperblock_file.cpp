@@ -0,0 +1,208 @@
+/***************************************************************************
+ *  tests/io/test_fileperblock_file.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(__linux__)
+#include <dirent.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <tlx/die.hpp>
+#include <tlx/logger.hpp>
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io.hpp>
+
+using foxxll::file;
+
+//! exposes the block file names and the open files cache
+class test_file : public foxxll::fileperblock_file<foxxll::syscall_file>
+{
+public:
+    using fileperblock_file::fileperblock_file;
+    using fileperblock_file::filename_for_block;
+    using fileperblock_file::invalidate_block_file;
+};
+
+static const size_t block = 4096;
+
+static void fill(char* buffer, size_t seed)
+{
+    for (size_t i = 0; i < block; ++i)
+        buffer[i] = static_cast<char>((i + seed) % 253);
+}
+
+static bool check(const char* buffer, size_t seed)
+{
+    for (size_t i = 0; i < block; ++i)
+    {
+        if (buffer[i] != static_cast<char>((i + seed) % 253))
+            return false;
+    }
+    return true;
+}
+
+//! size of a file, or -1 if it does not exist
+static long long file_size(const std::string& path)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0)
+        return -1;
+    return static_cast<long long>(st.st_size);
+}
+
+//! number of open file descriptors of the process, or 0 if unknown
+static size_t open_fds()
+{
+    size_t count = 0;
+#if defined(__linux__)
+    DIR* dir = opendir("/proc/self/fd");
+    if (!dir)
+        return 0;
+    while (readdir(dir) != nullptr)
+        ++count;
+    closedir(dir);
+#endif
+    return count;
+}
+
+//! more blocks than the cache holds are written and read back, evicted
+//! files are reopened without losing their data
+void test_lru(const std::string& prefix, char* buffer)
+{
+    const size_t num_blocks = 3 * test_file::open_files_cache_size;
+
+    test_file f(prefix, file::CREAT | file::RDWR, 1009);
+    f.set_size(num_blocks * block);
+
+    const size_t fds_before = open_fds();
+
+    for (size_t i = 0; i < num_blocks; ++i)
+    {
+        fill(buffer, i);
+        f.awrite(buffer, i * block, block)->wait();
+    }
+
+    // at most the cached files are open
+    if (fds_before != 0)
+        die_unless(open_fds() <= fds_before + test_file::open_files_cache_size);
+
+    // read in reverse, the first blocks were evicted long ago
+    for (size_t i = num_blocks; i > 0; --i)
+    {
+        memset(buffer, 0, block);
+        f.aread(buffer, (i - 1) * block, block)->wait();
+        die_unless(check(buffer, i - 1));
+    }
+
+    // a block read from the cache and after explicit invalidation
+    f.aread(buffer, 0, block)->wait();
+    die_unless(check(buffer, 0));
+    die_unless(f.invalidate_block_file(0));
+    die_unless(!f.invalidate_block_file(0));
+    memset(buffer, 0, block);
+    f.aread(buffer, 0, block)->wait();
+    die_unless(check(buffer, 0));
+
+    for (size_t i = 0; i < num_blocks; ++i)
+        f.discard(i * block, block);
+}
+
+//! discard() closes the cached file and removes it, later writes create a
+//! new file
+void test_discard(const std::string& prefix, char* buffer)
+{
+    test_file f(prefix, file::CREAT | file::RDWR, 1009);
+    f.set_size(2 * block);
+
+    const std::string name = f.filename_for_block(block);
+
+    fill(buffer, 1);
+    f.awrite(buffer, block, block)->wait();
+    die_unequal(file_size(name), static_cast<long long>(block));
+
+    f.discard(block, block);
+    die_unequal(file_size(name), -1);
+    die_unless(!f.invalidate_block_file(block));
+
+    // the removed file is not written through a stale handle
+    fill(buffer, 2);
+    f.awrite(buffer, block, block)->wait();
+    die_unequal(file_size(name), static_cast<long long>(block));
+
+    memset(buffer, 0, block);
+    f.aread(buffer, block, block)->wait();
+    die_unless(check(buffer, 2));
+
+    f.discard(block, block);
+}
+
+//! export_files() renames the file of a block out of reach, the block
+//! itself starts over in a new file
+void test_export(const std::string& dir, const std::string& prefix, char* buffer)
+{
+    test_file f(prefix, file::CREAT | file::RDWR, 1009);
+    f.set_size(block);
+
+    const std::string exported = dir + "/test_fileperblock_exported";
+
+    fill(buffer, 3);
+    f.awrite(buffer, 0, block)->wait();
+    f.export_files(0, block / 2, "test_fileperblock_exported");
+
+    die_unequal(file_size(f.filename_for_block(0)), -1);
+    die_unequal(file_size(exported), static_cast<long long>(block / 2));
+
+    // writing the block again does not touch the exported file
+    fill(buffer, 4);
+    f.awrite(buffer, 0, block)->wait();
+    die_unequal(file_size(exported), static_cast<long long>(block / 2));
+
+    FILE* in = fopen(exported.c_str(), "rb");
+    die_unless(in != nullptr);
+    die_unequal(fread(buffer, 1, block / 2, in), block / 2);
+    fclose(in);
+    for (size_t i = 0; i < block / 2; ++i)
+        die_unless(buffer[i] == static_cast<char>((i + 3) % 253));
+
+    f.discard(0, block);
+    std::remove(exported.c_str());
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        LOG1 << "Usage: " << argv[0] << " tempdir";
+        return -1;
+    }
+
+    const std::string dir = argv[1];
+    const std::string prefix = dir + "/test_fileperblock";
+
+    char* buffer = static_cast<char*>(
+        foxxll::aligned_alloc<foxxll::BlockAlignment>(block));
+
+    test_lru(prefix, buffer);
+    test_discard(prefix, buffer);
+    test_export(dir, prefix, buffer);
+
+    foxxll::aligned_dealloc<foxxll::BlockAlignment>(buffer);
+    return 0;
+}
+
+/**************************************************************************/
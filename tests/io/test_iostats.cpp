@@ -0,0 +1,227 @@
+/***************************************************************************
+ *  tests/io/test_iostats.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io.hpp>
+
+//! a single timed read is accounted as serial and as parallel time
+void test_serial()
+{
+    foxxll::memory_file file(
+        foxxll::file::DEFAULT_QUEUE, foxxll::file::NO_ALLOCATOR, 1000);
+    foxxll::file_stats* fs = file.get_file_stats();
+
+    foxxll::stats_data before(*foxxll::stats::get_instance());
+    {
+        foxxll::file_stats::scoped_read_timer timer(fs, 4096);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    {
+        foxxll::stats::scoped_wait_timer timer(foxxll::stats::WAIT_OP_READ);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    foxxll::stats_data diff =
+        foxxll::stats_data(*foxxll::stats::get_instance()) - before;
+
+    die_unequal(fs->get_read_count(), 1u);
+    die_unequal(fs->get_read_bytes(), 4096u);
+    die_unless(fs->get_read_time() >= 0.02);
+    die_unless(diff.get_pread_time() >= 0.02);
+    die_unless(diff.get_pio_time() >= 0.02);
+    die_unless(diff.get_wait_read_time() >= 0.01);
+    die_unequal(diff.get_wait_write_time(), 0.0);
+}
+
+//! many threads account operations concurrently, counts stay exact and the
+//! parallel time does not exceed the wall time
+void test_concurrent()
+{
+    foxxll::memory_file file(
+        foxxll::file::DEFAULT_QUEUE, foxxll::file::NO_ALLOCATOR, 1001);
+    foxxll::file_stats* fs = file.get_file_stats();
+
+    const size_t num_threads = 8, num_ops = 20000;
+
+    foxxll::stats_data before(*foxxll::stats::get_instance());
+    const double begin = foxxll::timestamp();
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back(
+            [fs, t]() {
+                for (size_t i = 0; i < num_ops; ++i)
+                {
+                    const bool is_write = (i + t) % 2 != 0;
+                    foxxll::file_stats::scoped_read_write_timer timer(
+                        fs, 512, is_write);
+                    foxxll::stats::scoped_wait_timer wait(
+                        is_write ? foxxll::stats::WAIT_OP_WRITE
+                        : foxxll::stats::WAIT_OP_READ);
+                }
+                fs->read_op_finished(1, 0);
+            });
+    }
+    for (std::thread& t : threads)
+        t.join();
+
+    const double elapsed = foxxll::timestamp() - begin;
+    foxxll::stats_data diff =
+        foxxll::stats_data(*foxxll::stats::get_instance()) - before;
+
+    const unsigned ops = num_threads * num_ops;
+    die_unequal(fs->get_read_count() + fs->get_write_count(),
+                ops + num_threads);
+    die_unequal(fs->get_read_count(), ops / 2 + num_threads);
+    die_unequal(fs->get_read_bytes(), 512u * ops / 2 + num_threads);
+    die_unequal(fs->get_write_bytes(), 512u * ops / 2);
+
+    // the snapshot includes this file
+    die_unequal(diff.get_read_count() + diff.get_write_count(),
+                ops + num_threads);
+
+    die_unless(diff.get_pio_time() <= elapsed);
+    die_unless(diff.get_pread_time() <= diff.get_pio_time() + 1e-9);
+    die_unless(diff.get_pwrite_time() <= diff.get_pio_time() + 1e-9);
+    die_unless(diff.get_wait_read_time() + diff.get_wait_write_time()
+               <= diff.get_io_wait_time() * (1 + 1e-9) + 1e-9);
+}
+
+//! requests are attributed to the tag of the scope creating them, or to an
+//! explicit tag
+void test_io_tags()
+{
+    foxxll::stats* s = foxxll::stats::get_instance();
+
+    const foxxll::io_tag_type sort = s->get_io_tag("sort");
+    const foxxll::io_tag_type prefetch = s->get_io_tag("prefetch");
+    die_unless(sort != 0 && prefetch != 0 && sort != prefetch);
+    die_unequal(s->get_io_tag("sort"), sort);
+
+    const size_t block = 4096;
+    char* buffer = static_cast<char*>(
+        foxxll::aligned_alloc<foxxll::BlockAlignment>(block));
+
+    foxxll::memory_file file(
+        foxxll::file::DEFAULT_QUEUE, foxxll::file::NO_ALLOCATOR, 1002);
+    file.set_size(4 * block);
+
+    foxxll::stats_data before(*s);
+    {
+        foxxll::scoped_io_tag scope("sort");
+        die_unequal(foxxll::scoped_io_tag::current(), sort);
+        for (size_t i = 0; i < 3; ++i)
+            file.awrite(buffer, i * block, block)->wait();
+        {
+            foxxll::scoped_io_tag inner(prefetch);
+            file.aread(buffer, 0, block)->wait();
+        }
+        // an explicit tag overrides the scope
+        file.aread(buffer, block, block, prefetch)->wait();
+        die_unequal(foxxll::scoped_io_tag::current(), sort);
+    }
+    die_unequal(foxxll::scoped_io_tag::current(), 0u);
+    // untagged requests are not attributed
+    file.aread(buffer, 0, block)->wait();
+
+    foxxll::stats_data diff = foxxll::stats_data(*s) - before;
+
+    const foxxll::tag_stats_data ts = diff.get_tag_stats_data(sort);
+    die_unequal(ts.get_name(), "sort");
+    die_unequal(ts.get_write_count(), 3u);
+    die_unequal(ts.get_write_bytes(), 3 * block);
+    die_unequal(ts.get_read_count(), 0u);
+#if !FOXXLL_TIMESTAMP_COARSE
+    // a coarse clock may not advance during I/O to memory
+    die_unless(ts.get_write_time() > 0.0);
+#endif
+    die_unless(ts.get_wait_write_time() >= 0.0);
+
+    const foxxll::tag_stats_data tp = diff.get_tag_stats_data(prefetch);
+    die_unequal(tp.get_read_count(), 2u);
+    die_unequal(tp.get_read_bytes(), 2 * block);
+    die_unequal(tp.get_write_count(), 0u);
+
+    die_unequal(diff.get_tag_stats_data(0).get_read_count(), 0u);
+
+    foxxll::aligned_dealloc<foxxll::BlockAlignment>(buffer);
+}
+
+//! the busy time of a device counts overlapping operations once, and a
+//! device busy during the whole interval is saturated if another one idles
+void test_utilization()
+{
+    foxxll::memory_file busy_file(
+        foxxll::file::DEFAULT_QUEUE, foxxll::file::NO_ALLOCATOR, 1004);
+    foxxll::memory_file idle_file(
+        foxxll::file::DEFAULT_QUEUE, foxxll::file::NO_ALLOCATOR, 1003);
+    foxxll::file_stats* fs = busy_file.get_file_stats();
+
+    // files are registered with the stats of their own device
+    die_unequal(fs->get_device_id(), 1004u);
+    die_unequal(idle_file.get_file_stats()->get_device_id(), 1003u);
+
+    foxxll::stats_data before(*foxxll::stats::get_instance());
+    {
+        foxxll::file_stats::scoped_read_timer timer(fs, 4096);
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        {
+            foxxll::file_stats::scoped_write_timer overlapping(fs, 4096);
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        }
+    }
+    foxxll::stats_data diff =
+        foxxll::stats_data(*foxxll::stats::get_instance()) - before;
+
+    die_unless(fs->get_busy_time() >= 0.06);
+    die_unless(fs->get_busy_time() <
+               fs->get_read_time() + fs->get_write_time());
+
+    double busy = -1.0, idle = -1.0;
+    for (const foxxll::file_stats_data& fsd : diff.get_file_stats_data_list())
+    {
+        if (fsd.get_device_id() == 1004)
+            busy = fsd.get_busy_time();
+        if (fsd.get_device_id() == 1003)
+            idle = fsd.get_busy_time();
+    }
+    die_unless(busy >= 0.06 && busy <= diff.get_elapsed_time());
+    die_unequal(idle, 0.0);
+
+    const auto utilization = diff.get_utilization_summary();
+    die_unequal(utilization.min, 0.0);
+    die_unless(utilization.max > 0.8 && utilization.max <= 1.0);
+    die_unequal(utilization.values_per_device.back().second, 1004u);
+
+    const std::vector<unsigned> saturated = diff.get_saturated_devices(0.8);
+    die_unequal(saturated.size(), 1u);
+    die_unequal(saturated[0], 1004u);
+
+    // without an idle device nothing is saturated
+    die_unless(diff.get_saturated_devices(0.8, 0.0).empty());
+}
+
+int main()
+{
+    test_serial();
+    test_concurrent();
+    test_io_tags();
+    test_utilization();
+    return 0;
+}
+
+/**************************************************************************/
@@ -0,0 +1,112 @@
+/***************************************************************************
+ *  tests/io/test_latency_histogram.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <cstdint>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io.hpp>
+
+using foxxll::latency_histogram;
+using foxxll::latency_histogram_data;
+
+//! buckets are contiguous and each value lies in its bucket
+void test_buckets()
+{
+    for (size_t b = 0; b + 1 < latency_histogram::num_buckets; ++b)
+        die_unequal(latency_histogram::bucket_end(b),
+                    latency_histogram::bucket_begin(b + 1));
+
+    for (uint64_t v = 0; v < (uint64_t(1) << 20); v = v * 3 / 2 + 1)
+    {
+        const size_t b = latency_histogram::bucket(v);
+        die_unless(latency_histogram::bucket_begin(b) <= v);
+        die_unless(v < latency_histogram::bucket_end(b));
+        // relative width of the bucket is at most 1/16
+        die_unless((latency_histogram::bucket_end(b) -
+                    latency_histogram::bucket_begin(b)) * 16 <=
+                   latency_histogram::bucket_begin(b) + 16);
+    }
+
+    die_unequal(latency_histogram::bucket(uint64_t(1) << 50),
+                latency_histogram::num_buckets - 1);
+}
+
+//! percentiles of a known distribution, and snapshot differences
+void test_percentiles()
+{
+    latency_histogram h;
+    die_unequal(latency_histogram_data(h).percentile(0.5), 0.0);
+
+    // 990 operations of 100 us and 10 of 10 ms
+    for (size_t i = 0; i < 990; ++i)
+        h.add(100e-6);
+    latency_histogram_data first(h);
+    for (size_t i = 0; i < 10; ++i)
+        h.add(10e-3);
+
+    latency_histogram_data all(h);
+    die_unequal(all.get_count(), 1000u);
+
+    const double p50 = all.percentile(0.5), p99 = all.percentile(0.99);
+    die_unless(p50 >= 100e-6 && p50 <= 100e-6 * 1.07);
+    die_unless(p99 >= 100e-6 && p99 <= 100e-6 * 1.07);
+    const double p999 = all.percentile(0.999);
+    die_unless(p999 >= 10e-3 && p999 <= 10e-3 * 1.07);
+
+    latency_histogram_data last = all - first;
+    die_unequal(last.get_count(), 10u);
+    die_unless(last.percentile(0.5) >= 10e-3);
+
+    die_unequal((first + last).get_count(), 1000u);
+    die_unequal((first + last).percentile(0.999), p999);
+}
+
+//! file_stats feed the histograms, which stats_data aggregates
+void test_file_stats()
+{
+    foxxll::memory_file file(
+        foxxll::file::DEFAULT_QUEUE, foxxll::file::NO_ALLOCATOR, 1002);
+    foxxll::file_stats* fs = file.get_file_stats();
+
+    foxxll::stats_data before(*foxxll::stats::get_instance());
+
+    for (size_t i = 0; i < 100; ++i)
+        fs->read_op_finished(4096, foxxll::seconds_to_ticks(1e-3));
+    fs->write_op_finished(4096, foxxll::seconds_to_ticks(5e-3));
+    {
+        foxxll::file_stats::scoped_write_timer timer(fs, 4096);
+    }
+
+    // canceled operations are not counted
+    fs->read_canceled(4096, fs->read_started(4096));
+
+    foxxll::stats_data diff =
+        foxxll::stats_data(*foxxll::stats::get_instance()) - before;
+
+    die_unequal(diff.get_read_latency().get_count(), 100u);
+    die_unequal(diff.get_write_latency().get_count(), 2u);
+    die_unless(diff.get_read_latency().percentile(0.99) >= 1e-3);
+    die_unless(diff.get_write_latency().percentile(1.0) >= 5e-3);
+
+    die_unless(diff.get_read_latency_summary(0.99).max >= 1e-3);
+}
+
+int main()
+{
+    test_buckets();
+    test_percentiles();
+    test_file_stats();
+    return 0;
+}
+
+/**************************************************************************/
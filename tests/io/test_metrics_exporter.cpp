@@ -0,0 +1,213 @@
+/***************************************************************************
+ *  tests/io/test_metrics_exporter.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io.hpp>
+#include <foxxll/mng/block_manager.hpp>
+
+#if !FOXXLL_WINDOWS
+ #include <sys/socket.h>
+ #include <sys/un.h>
+ #include <unistd.h>
+#endif
+
+//! value of the metric with the given name and label, or -1
+static double find(const foxxll::metrics_sample& s, const std::string& name,
+                   const std::string& label = std::string())
+{
+    for (const auto& m : s.metrics())
+    {
+        if (m.name != name) continue;
+        if (!label.empty() && (m.labels.empty() || m.labels[0].second != label))
+            continue;
+        return m.value;
+    }
+    return -1;
+}
+
+static std::string read_file(const std::string& path)
+{
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+int main()
+{
+    using foxxll::metrics_exporter;
+
+    const size_t block = 4096;
+    const unsigned device = 1005;
+    const std::string dev = std::to_string(device);
+
+    die_unequal(metrics_exporter::parse_format("json"), metrics_exporter::JSON);
+    die_unless_throws(metrics_exporter::parse_format("xml"),
+                      foxxll::bad_parameter);
+
+    char* buffer = static_cast<char*>(
+        foxxll::aligned_alloc<foxxll::BlockAlignment>(block));
+
+    foxxll::memory_file file(1005, foxxll::file::NO_ALLOCATOR, device);
+    file.set_size(4 * block);
+
+    // deltas and rates cover the I/O since the previous sample only
+    {
+        metrics_exporter exporter("unused.prom", metrics_exporter::PROMETHEUS);
+
+        for (size_t i = 0; i < 4; ++i)
+            file.awrite(buffer, i * block, block)->wait();
+
+        foxxll::metrics_sample s1 = exporter.collect();
+        die_unequal(find(s1, "foxxll_write_ops_total", dev), 4.0);
+        die_unequal(find(s1, "foxxll_write_ops_interval", dev), 4.0);
+        die_unequal(find(s1, "foxxll_write_bytes_interval", dev), 4.0 * block);
+        die_unless(find(s1, "foxxll_write_bytes_per_second", dev) > 0.0);
+        die_unless(find(s1, "foxxll_write_latency_seconds", dev) > 0.0);
+
+        file.aread(buffer, 0, block)->wait();
+
+        foxxll::metrics_sample s2 = exporter.collect();
+        die_unequal(find(s2, "foxxll_write_ops_total", dev), 4.0);
+        die_unequal(find(s2, "foxxll_write_ops_interval", dev), 0.0);
+        die_unequal(find(s2, "foxxll_read_ops_interval", dev), 1.0);
+        die_unequal(find(s2, "foxxll_read_bytes_interval", dev), double(block));
+        // no writes in the interval, hence no write percentiles
+        die_unequal(find(s2, "foxxll_write_latency_seconds", dev), -1.0);
+        die_unless(find(s2, "foxxll_queue_dequeued_total", "1005") >= 5.0);
+    }
+
+    // Prometheus text format, written by the thread and on stop()
+    {
+        const std::string path = "test_metrics_exporter.prom";
+        metrics_exporter exporter(path, metrics_exporter::PROMETHEUS, 0.01);
+        exporter.add_source([](foxxll::metrics_sample& s) {
+                                s.add("app_items_total",
+                                      foxxll::metrics_sample::COUNTER,
+                                      "Items processed.", 42);
+                            });
+        exporter.start();
+        file.awrite(buffer, 0, block)->wait();
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        exporter.stop();
+
+        const std::string text = read_file(path);
+        die_unless(text.find("# TYPE foxxll_write_ops_total counter\n")
+                   != std::string::npos);
+        die_unless(text.find("foxxll_write_ops_total{device=\"" + dev + "\"} ")
+                   != std::string::npos);
+        die_unless(text.find("\napp_items_total 42\n") != std::string::npos);
+        // each family is described once
+        const std::string help = "# HELP foxxll_wait_seconds_total";
+        die_unequal(text.find(help), text.rfind(help));
+        std::remove(path.c_str());
+    }
+
+    // newline-delimited JSON, appended for each sample
+    {
+        const std::string path = "test_metrics_exporter.json";
+        std::remove(path.c_str());
+        metrics_exporter exporter(path, metrics_exporter::JSON);
+        exporter.export_now();
+        exporter.export_now();
+
+        std::ifstream in(path);
+        std::string line;
+        size_t lines = 0;
+        while (std::getline(in, line)) {
+            die_unless(line.compare(0, 8, "{\"time\":") == 0);
+            die_unless(line.find("{\"name\":\"foxxll_write_ops_total\","
+                                 "\"device\":\"" + dev + "\",\"value\":")
+                       != std::string::npos);
+            die_unequal(line.substr(line.size() - 2), "]}");
+            ++lines;
+        }
+        die_unequal(lines, 2u);
+        std::remove(path.c_str());
+    }
+
+#if !FOXXLL_WINDOWS
+    // UNIX socket of a local agent
+    {
+        const std::string path = "test_metrics_exporter.sock";
+        ::unlink(path.c_str());
+
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, path.c_str(), path.size());
+
+        const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        die_unless(listener >= 0);
+        die_unless(::bind(listener, reinterpret_cast<sockaddr*>(&addr),
+                          sizeof(addr)) == 0);
+        die_unless(::listen(listener, 1) == 0);
+
+        metrics_exporter exporter("unix:" + path, metrics_exporter::JSON);
+        exporter.export_now();
+
+        const int conn = ::accept(listener, nullptr, nullptr);
+        die_unless(conn >= 0);
+        std::string received;
+        char buf[4096];
+        ssize_t rc;
+        while ((rc = ::read(conn, buf, sizeof(buf))) > 0)
+            received.append(buf, static_cast<size_t>(rc));
+        ::close(conn);
+        ::close(listener);
+        ::unlink(path.c_str());
+
+        die_unless(received.compare(0, 8, "{\"time\":") == 0);
+        die_unequal(received.back(), '\n');
+
+        // without a listener the sample is dropped, not thrown
+        exporter.export_now();
+    }
+#endif
+
+    // the disks of the block manager are exported once it adds its source
+    {
+        metrics_exporter exporter("unused.prom", metrics_exporter::PROMETHEUS);
+        die_unequal(find(exporter.collect(), "foxxll_disk_free_bytes"), -1.0);
+
+        foxxll::block_manager* bm = foxxll::block_manager::get_instance();
+        bm->add_metrics_source(exporter);
+
+        foxxll::BID<4096> bid;
+        bm->new_block(foxxll::single_disk(0), bid);
+
+        foxxll::metrics_sample s = exporter.collect();
+        die_unless(find(s, "foxxll_allocated_bytes") >= 4096.0);
+        die_unequal(find(s, "foxxll_disk_alloc_blocks_total", "0"), 1.0);
+        die_unequal(find(s, "foxxll_disk_alloc_bytes_total", "0"), 4096.0);
+        die_unless(find(s, "foxxll_disk_free_regions", "0") >= 1.0);
+        die_unless(find(s, "foxxll_disk_fragmentation_ratio", "0") >= 0.0);
+        die_unless(find(s, "foxxll_disk_alloc_lock_hold_seconds_total", "0") >= 0.0);
+
+        bm->delete_block(bid);
+    }
+
+    foxxll::aligned_dealloc<foxxll::BlockAlignment>(buffer);
+
+    return 0;
+}
+
+/**************************************************************************/
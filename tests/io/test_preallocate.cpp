@@ -0,0 +1,141 @@
+/***************************************************************************
+ *  tests/io/test_preallocate.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/config.hpp>
+
+#if !FOXXLL_WINDOWS
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <tlx/die.hpp>
+#include <tlx/logger.hpp>
+
+#include <foxxll/io/syscall_file.hpp>
+#include <foxxll/mng/disk_block_allocator.hpp>
+
+using bid_type = foxxll::BID<65536>;
+constexpr uint64_t block = 65536;
+
+#if defined(__linux__)
+
+//! allocated bytes of a file
+static uint64_t allocated_bytes(const std::string& path)
+{
+    struct stat st;
+    die_unless(::stat(path.c_str(), &st) == 0);
+    return static_cast<uint64_t>(st.st_blocks) * 512;
+}
+
+//! whether the file system of path allocates space with fallocate()
+static bool supports_fallocate(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    die_unless(fd >= 0);
+    const bool ok = ::fallocate(fd, 0, 0, block) == 0;
+    ::close(fd);
+    std::remove(path.c_str());
+    return ok;
+}
+
+//! preallocate() extends the file with allocated space and truncates it
+//! when shrinking
+void test_preallocate(const std::string& path)
+{
+    foxxll::syscall_file f(path, foxxll::file::CREAT | foxxll::file::RDWR);
+    die_unequal(allocated_bytes(path), 0u);
+
+    f.preallocate(16 * block);
+    die_unequal(f.size(), 16 * block);
+    die_unless(allocated_bytes(path) >= 16 * block);
+
+    // the extension keeps the allocated space of the file
+    f.preallocate(32 * block);
+    die_unequal(f.size(), 32 * block);
+    die_unless(allocated_bytes(path) >= 32 * block);
+
+    f.preallocate(8 * block);
+    die_unequal(f.size(), 8 * block);
+    die_unless(allocated_bytes(path) < 16 * block);
+}
+
+//! with prealloc the allocator allocates the initial size and each growth
+//! of the file, without it the file stays sparse
+void test_grow_file(const std::string& path, bool prealloc)
+{
+    foxxll::syscall_file storage(path, foxxll::file::CREAT | foxxll::file::RDWR);
+    foxxll::disk_config cfg(path, 4 * block, "syscall");
+    cfg.prealloc = prealloc;
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    die_unequal(storage.size(), 4 * block);
+    if (prealloc)
+        die_unless(allocated_bytes(path) >= 4 * block);
+    else
+        die_unequal(allocated_bytes(path), 0u);
+
+    // more blocks than the disk holds grow the file
+    std::vector<bid_type> bids(12, bid_type(&storage, 0));
+    alloc.new_blocks(bids.begin(), bids.end());
+
+    die_unequal(storage.size(), alloc.total_bytes());
+    die_unless(alloc.total_bytes() >= 12 * block);
+    if (prealloc)
+        die_unless(allocated_bytes(path) >= alloc.total_bytes());
+    else
+        die_unequal(allocated_bytes(path), 0u);
+
+    for (const bid_type& bid : bids)
+        alloc.delete_block(bid);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        LOG1 << "Usage: " << argv[0] << " tempdir";
+        return -1;
+    }
+
+    const std::string path = std::string(argv[1]) + "/test_preallocate.dat";
+
+    if (!supports_fallocate(path)) {
+        LOG1 << "File system of " << argv[1] << " does not preallocate, skipped.";
+        return 0;
+    }
+
+    test_preallocate(path);
+    std::remove(path.c_str());
+    test_grow_file(path, true);
+    std::remove(path.c_str());
+    test_grow_file(path, false);
+    std::remove(path.c_str());
+
+    return 0;
+}
+
+#else
+
+int main()
+{
+    LOG1 << "fallocate() is not available, skipped.";
+    return 0;
+}
+
+#endif
+
+/**************************************************************************/
@@ -0,0 +1,101 @@
+/***************************************************************************
+ *  tests/io/test_queue_stats.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io.hpp>
+
+int main()
+{
+    const int queue = 1004;
+    const size_t block = 4096, num_blocks = 8;
+
+    foxxll::disk_queues* queues = foxxll::disk_queues::get_instance();
+
+    // unknown queues have empty gauges
+    die_unequal(queues->get_queue_stats(queue).get_enqueued(), 0u);
+
+    char* buffer = static_cast<char*>(
+        foxxll::aligned_alloc<foxxll::BlockAlignment>(block * num_blocks));
+
+    foxxll::memory_file file(queue, foxxll::file::NO_ALLOCATOR, 1004);
+    file.set_size(block * num_blocks);
+
+    // the handler of the first request blocks the queue worker
+    std::atomic<bool> entered { false }, release { false };
+    auto blocking = [&](foxxll::request*, bool) {
+                        entered = true;
+                        while (!release)
+                            std::this_thread::yield();
+                    };
+
+    std::vector<foxxll::request_ptr> reqs;
+    reqs.push_back(file.awrite(buffer, 0, block, blocking));
+    while (!entered)
+        std::this_thread::yield();
+
+    for (size_t i = 1; i < num_blocks; ++i)
+        reqs.push_back(file.awrite(buffer + i * block, i * block, block));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    foxxll::request_queue_stats_data busy = queues->get_queue_stats(queue);
+    die_unequal(busy.get_depth(), num_blocks - 1);
+    die_unequal(busy.get_in_flight(), 1u);
+    die_unequal(busy.get_enqueued(), num_blocks);
+    die_unequal(busy.get_dequeued(), 1u);
+    die_unless(busy.get_max_depth() >= num_blocks - 1);
+
+    // a waiting request can be canceled
+    die_unless(reqs.back()->cancel());
+
+    release = true;
+    foxxll::wait_all(reqs.begin(), reqs.end());
+
+    // the worker completes the last request after waking its waiter
+    foxxll::request_queue_stats_data idle;
+    do {
+        std::this_thread::yield();
+        idle = queues->get_queue_stats(queue);
+    } while (idle.get_in_flight() != 0);
+
+    die_unequal(idle.get_depth(), 0u);
+    die_unequal(idle.get_dequeued(), num_blocks - 1);
+    die_unequal(idle.get_canceled(), 1u);
+    die_unequal(idle.get_wait_latency().get_count(), num_blocks - 1);
+
+    // the queued requests waited at least the 10 ms the worker was blocked
+    die_unless(idle.get_wait_latency().percentile(1.0) >= 0.01);
+    die_unless(idle.get_mean_wait_time() > 0.0);
+
+    // differences count the interval only
+    foxxll::request_queue_stats_data delta = idle - busy;
+    die_unequal(delta.get_dequeued(), num_blocks - 2);
+    die_unequal(delta.get_wait_latency().get_count(), num_blocks - 2);
+
+    // the queue is listed among all queues
+    bool found = false;
+    for (const auto& q : queues->get_queue_stats())
+        found |= (q.first == queue && q.second.get_enqueued() == num_blocks);
+    die_unless(found);
+
+    foxxll::aligned_dealloc<foxxll::BlockAlignment>(buffer);
+
+    return 0;
+}
+
+/**************************************************************************/
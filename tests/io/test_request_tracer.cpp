@@ -0,0 +1,127 @@
+/***************************************************************************
+ *  tests/io/test_request_tracer.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io.hpp>
+
+//! number of occurrences of pattern in text
+static size_t count(const std::string& text, const std::string& pattern)
+{
+    size_t n = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos;
+         pos = text.find(pattern, pos + 1))
+        ++n;
+    return n;
+}
+
+int main()
+{
+    foxxll::request_tracer* tracer = foxxll::request_tracer::get_instance();
+
+    const size_t block = 4096, num_blocks = 16;
+    char* buffer = static_cast<char*>(
+        foxxll::aligned_alloc<foxxll::BlockAlignment>(block * num_blocks));
+
+    foxxll::memory_file file(
+        foxxll::file::DEFAULT_QUEUE, foxxll::file::NO_ALLOCATOR, 1003);
+    file.set_size(block * num_blocks);
+
+    std::atomic<size_t> handled { 0 };
+    auto handler = [&handled](foxxll::request*, bool) { ++handled; };
+
+    // requests are not traced unless enabled
+    file.awrite(buffer, 0, block)->wait();
+    die_unequal(tracer->size(), 0u);
+
+    tracer->enable();
+
+    std::vector<foxxll::request_ptr> reqs;
+    for (size_t i = 0; i < num_blocks; ++i)
+        reqs.push_back(file.awrite(buffer + i * block, i * block, block, handler));
+    foxxll::wait_all(reqs.begin(), reqs.end());
+
+    reqs.clear();
+    for (size_t i = 0; i < num_blocks; ++i)
+        reqs.push_back(file.aread(buffer + i * block, i * block, block, handler));
+    foxxll::wait_any(reqs.data(), reqs.size());
+    foxxll::wait_all(reqs.begin(), reqs.end());
+
+    tracer->disable();
+    die_unequal(handled.load(), 2 * num_blocks);
+
+    // untraced again
+    const size_t recorded = tracer->size();
+    file.aread(buffer, 0, block)->wait();
+    die_unequal(tracer->size(), recorded);
+
+    std::ostringstream oss;
+    tracer->write_chrome_trace(oss);
+    const std::string trace = oss.str();
+
+    // each request is an async slice with its steps
+    die_unequal(count(trace, "\"ph\":\"b\""), 2 * num_blocks);
+    die_unequal(count(trace, "\"ph\":\"e\""), 2 * num_blocks);
+    die_unequal(count(trace, "\"name\":\"submit\""), 2 * num_blocks);
+    die_unequal(count(trace, "\"name\":\"dequeue\""), 2 * num_blocks);
+    die_unequal(count(trace, "\"name\":\"complete\""), 2 * num_blocks);
+    die_unequal(count(trace, "\"name\":\"handler_begin\""), 2 * num_blocks);
+    die_unequal(count(trace, "\"name\":\"handler_end\""), 2 * num_blocks);
+    die_unless(count(trace, "\"name\":\"wakeup\"") >= 2 * num_blocks);
+    die_unless(count(trace, "\"offset\":4096") > 0);
+    die_unless(count(trace, "foxxll queue worker") == 1);
+    die_unequal(count(trace, "{"), count(trace, "}"));
+    die_unequal(count(trace, "["), count(trace, "]"));
+
+    // the ring buffers keep only the latest events
+    tracer->enable(8);
+    die_unequal(tracer->size(), 0u);
+    for (size_t i = 0; i < num_blocks; ++i)
+        file.aread(buffer, 0, block)->wait();
+    tracer->disable();
+    die_unless(tracer->size() <= 8 * 2);
+
+    tracer->clear();
+    die_unequal(tracer->size(), 0u);
+
+    // threads started one after another reuse the buffer of the exited one
+    tracer->enable();
+    for (size_t i = 0; i < 8; ++i)
+    {
+        std::thread thread([&]() {
+                               foxxll::request_tracer::name_thread("short-lived");
+                               file.awrite(buffer, i * block, block)->wait();
+                           });
+        thread.join();
+    }
+    tracer->disable();
+
+    oss.str("");
+    tracer->write_chrome_trace(oss);
+    die_unequal(count(oss.str(), "\"name\":\"submit\""), 1u);
+    die_unequal(count(oss.str(), "short-lived"), 1u);
+
+    tracer->clear();
+    die_unequal(tracer->size(), 0u);
+
+    foxxll::aligned_dealloc<foxxll::BlockAlignment>(buffer);
+
+    return 0;
+}
+
+/**************************************************************************/
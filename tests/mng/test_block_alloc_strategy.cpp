@@ -12,12 +12,16 @@
  *  http://www.boost.org/LICENSE_1_0.txt)
  **************************************************************************/
 
+#include <cmath>
 #include <sstream>
+#include <vector>
 
+#include <tlx/die.hpp>
 #include <tlx/logger.hpp>
 
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/mng.hpp>
+#include <foxxll/mng/block_alloc_strategy_dynamic.hpp>
 #include <foxxll/mng/block_alloc_strategy_interleaved.hpp>
 
 template <typename strategy>
@@ -63,6 +67,7 @@ int main()
     test_strategy<foxxll::fully_random>();
     test_strategy<foxxll::simple_random>();
     test_strategy<foxxll::random_cyclic>();
+    test_strategy<foxxll::load_aware>();
     LOG1 << "Regular disks: [" << cfg->regular_disk_range().first << "," << cfg->regular_disk_range().second << ")";
     if (cfg->regular_disk_range().first != cfg->regular_disk_range().second)
         test_strategy<foxxll::random_cyclic_disk>();
@@ -70,6 +75,32 @@ int main()
     if (cfg->flash_range().first != cfg->flash_range().second)
         test_strategy<foxxll::random_cyclic_flash>();
     test_strategy<foxxll::single_disk>();
+    test_strategy<foxxll::dynamic_alloc_strategy>();
+
+    // strategies selected at runtime behave like the functors
+    foxxll::striping st(1, 4);
+    foxxll::dynamic_alloc_strategy dst("striping", 1, 4);
+    for (size_t i = 0; i < 16; ++i)
+        die_unequal(dst(i), st(i));
+
+    die_unless_throws(
+        foxxll::dynamic_alloc_strategy("no_such_strategy"), std::runtime_error);
+
+    // the load-aware sequence only uses the disks in range, each with a
+    // share matching its weight
+    foxxll::load_aware la(0, cfg->disks_number());
+    std::vector<double> weights =
+        foxxll::load_aware::disk_weights(0, cfg->disks_number());
+    double total = 0;
+    for (double w : weights)
+        total += w;
+    std::vector<size_t> count(cfg->disks_number(), 0);
+    for (size_t i = 0; i < la.sequence_.size(); ++i)
+        count.at(la(i))++;
+    for (size_t d = 0; d < count.size(); ++d) {
+        const double share = total > 0 ? weights[d] / total : 1.0 / count.size();
+        die_unless(std::abs(count[d] - share * la.sequence_.size()) <= 1.0);
+    }
 }
 
 /**************************************************************************/
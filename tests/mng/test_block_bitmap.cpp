@@ -0,0 +1,210 @@
+/***************************************************************************
+ *  tests/mng/test_block_bitmap.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <random>
+#include <vector>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io/memory_file.hpp>
+#include <foxxll/mng/block_bitmap.hpp>
+#include <foxxll/mng/disk_block_allocator.hpp>
+
+// compare block_bitmap against a plain vector<bool> under random operations
+void test_bitmap()
+{
+    // beyond 64 * 64 bits, the summary has three levels
+    const size_t max_size = 20000;
+
+    foxxll::block_bitmap bitmap;
+    std::vector<bool> ref;
+
+    std::mt19937 rng(42);
+
+    for (size_t round = 0; round < 4000; ++round)
+    {
+        const size_t op = rng() % 16;
+
+        if (op == 0) {
+            if (ref.size() >= max_size)
+                continue;
+            // grow across word and summary level boundaries
+            const size_t new_size = ref.size() + rng() % 5000;
+            bitmap.grow(new_size);
+            ref.resize(new_size, true);
+        }
+        else if (op < 9) {
+            const size_t n = 1 + rng() % 100;
+            const size_t pos = bitmap.allocate(n);
+
+            // reference first-fit
+            size_t expect = foxxll::block_bitmap::npos;
+            for (size_t i = 0, run = 0; i < ref.size(); ++i) {
+                run = ref[i] ? run + 1 : 0;
+                if (run == n) {
+                    expect = i + 1 - n;
+                    break;
+                }
+            }
+
+            die_unequal(pos, expect);
+            if (pos != foxxll::block_bitmap::npos) {
+                for (size_t i = pos; i < pos + n; ++i)
+                    ref[i] = false;
+            }
+        }
+        else if (!ref.empty()) {
+            // free a random allocated run
+            size_t pos = rng() % ref.size();
+            size_t n = 0;
+            while (pos + n < ref.size() && !ref[pos + n] && n < 100)
+                ++n;
+
+            if (n == 0) {
+                die_unless(!bitmap.set_free(pos, 1));
+                continue;
+            }
+
+            die_unless(bitmap.set_free(pos, n));
+            for (size_t i = pos; i < pos + n; ++i)
+                ref[i] = true;
+        }
+
+        if (round % 250 == 0) {
+            size_t free = 0, runs = 0, longest = 0;
+            for (size_t i = 0, run = 0; i < ref.size(); ++i) {
+                die_unequal(bitmap.is_free(i), ref[i]);
+                if (ref[i]) {
+                    ++free, ++run;
+                    runs += (run == 1);
+                    longest = std::max(longest, run);
+                }
+                else {
+                    run = 0;
+                }
+            }
+            die_unequal(bitmap.size(), ref.size());
+            die_unequal(bitmap.free_count(), free);
+            die_unequal(bitmap.free_run_count(), runs);
+            die_unequal(bitmap.longest_free_run(), longest);
+        }
+    }
+
+    die_unless(bitmap.size() > 64 * 64);
+}
+
+void test_allocator()
+{
+    const size_t block_size = 4096;
+
+    foxxll::memory_file storage;
+
+    foxxll::disk_config cfg("/dev/null", 10 * block_size + 1, "memory");
+    cfg.block_size = block_size;
+
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    // grown to a multiple of the block size
+    die_unequal(alloc.total_bytes(), 11 * block_size);
+    die_unequal(alloc.free_bytes(), 11 * block_size);
+
+    std::vector<foxxll::BID<0> > bids(8);
+    for (foxxll::BID<0>& bid : bids) {
+        bid.storage = &storage;
+        bid.size = block_size;
+    }
+
+    alloc.new_blocks(bids.begin(), bids.end());
+    for (size_t i = 0; i < bids.size(); ++i)
+        die_unequal(bids[i].offset, i * block_size);
+
+    alloc.delete_block(bids[2]);
+    alloc.delete_block(bids[3]);
+    die_unequal(alloc.free_region_count(), 2u);
+    die_unequal(alloc.largest_free_region(), 3 * block_size);
+
+    // double free
+    die_unless_throws(alloc.delete_block(bids[2]), foxxll::bad_ext_alloc);
+
+    // first-fit reuses the freed run
+    alloc.new_blocks(bids.begin() + 2, bids.begin() + 4);
+    die_unequal(bids[2].offset, 2 * block_size);
+    die_unequal(bids[3].offset, 3 * block_size);
+
+    // autogrow beyond the configured size, the run starts in the free tail
+    std::vector<foxxll::BID<0> > more(bids);
+    alloc.new_blocks(more.begin(), more.end());
+    die_unequal(more[0].offset, 8 * block_size);
+    die_unequal(alloc.free_bytes(), 3 * block_size);
+
+    // blocks of another size are rejected
+    foxxll::BID<0> other(&storage, 0, block_size / 2);
+    die_unless_throws(alloc.new_blocks(&other, &other + 1), foxxll::bad_ext_alloc);
+
+    for (const foxxll::BID<0>& bid : bids)
+        alloc.delete_block(bid);
+    for (const foxxll::BID<0>& bid : more)
+        alloc.delete_block(bid);
+
+    die_unequal(alloc.free_bytes(), alloc.total_bytes());
+    die_unequal(alloc.free_region_count(), 1u);
+}
+
+//! freeing batches of blocks with delete_regions()
+void test_allocator_batch()
+{
+    const size_t block_size = 4096;
+    using place = foxxll::disk_block_allocator::place;
+
+    foxxll::memory_file storage;
+
+    foxxll::disk_config cfg("/dev/null", 8 * block_size, "memory");
+    cfg.block_size = block_size;
+
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    std::vector<foxxll::BID<0> > bids(8, foxxll::BID<0>(&storage, 0, block_size));
+    alloc.new_blocks(bids.begin(), bids.end());
+
+    // unsorted blocks, adjacent ones coalesce to two free runs
+    std::vector<place> regions;
+    for (size_t i : { 5, 1, 6, 2 })
+        regions.emplace_back(bids[i].offset, block_size);
+    alloc.delete_regions(regions);
+
+    die_unequal(alloc.free_bytes(), 4 * block_size);
+    die_unequal(alloc.free_region_count(), 2u);
+    die_unequal(alloc.largest_free_region(), 2 * block_size);
+
+    // a batch containing a free block is a double free
+    regions.assign(1, place(bids[1].offset, block_size));
+    die_unless_throws(alloc.delete_regions(regions), foxxll::bad_ext_alloc);
+
+    // the remaining blocks join all runs
+    regions.clear();
+    for (size_t i : { 7, 0, 4, 3 })
+        regions.emplace_back(bids[i].offset, block_size);
+    alloc.delete_regions(regions);
+
+    die_unequal(alloc.free_bytes(), alloc.total_bytes());
+    die_unequal(alloc.free_region_count(), 1u);
+}
+
+int main()
+{
+    test_bitmap();
+    test_allocator();
+    test_allocator_batch();
+    return 0;
+}
+
+/**************************************************************************/
@@ -0,0 +1,110 @@
+/***************************************************************************
+ *  tests/mng/test_block_extent_allocator.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <map>
+#include <vector>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io/memory_file.hpp>
+#include <foxxll/mng.hpp>
+#include <foxxll/mng/block_extent_allocator.hpp>
+
+using bid_type = foxxll::BID<4096>;
+
+//! reserve extents directly from a fragmented disk_block_allocator
+void test_reserve_extent()
+{
+    foxxll::memory_file storage;
+
+    foxxll::disk_config cfg("/dev/null", 16 * bid_type::size, "memory");
+    cfg.autogrow = false;
+
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    // free every other block of the first half
+    std::vector<bid_type> bids(16, bid_type(&storage, 0));
+    alloc.new_blocks(bids.begin(), bids.end());
+    for (size_t i = 0; i < 8; i += 2)
+        alloc.delete_block(bids[i]);
+    for (size_t i = 8; i < 16; ++i)
+        alloc.delete_block(bids[i]);
+
+    uint64_t bytes = 12 * bid_type::size, pos;
+    die_unless(!alloc.reserve_extent(bytes, pos));
+
+    bytes = 8 * bid_type::size;
+    die_unless(alloc.reserve_extent(bytes, pos));
+    die_unequal(pos, 8 * bid_type::size);
+    die_unequal(alloc.free_bytes(), 4 * bid_type::size);
+
+    alloc.release_extent(pos, pos, bytes);
+    die_unequal(alloc.free_bytes(), 12 * bid_type::size);
+}
+
+//! carve a striped stream interleaved with other allocations
+void test_stream()
+{
+    foxxll::block_manager* bm = foxxll::block_manager::get_instance();
+    const uint64_t allocated = bm->current_allocation();
+
+    foxxll::block_extent_allocator extents(8 * bid_type::size);
+
+    std::vector<bid_type> stream, other;
+    for (size_t batch = 0; batch < 10; ++batch)
+    {
+        std::vector<bid_type> bids(3);
+        extents.new_blocks(foxxll::striping(), bids.begin(), bids.end(),
+                           stream.size());
+        stream.insert(stream.end(), bids.begin(), bids.end());
+
+        bid_type bid;
+        bm->new_block(foxxll::striping(), bid, batch);
+        other.push_back(bid);
+    }
+
+    // consecutive blocks of the stream on each disk are adjacent, except
+    // where a new extent starts
+    std::map<foxxll::file*, std::vector<uint64_t> > disk_offsets;
+    for (const bid_type& bid : stream)
+        disk_offsets[bid.storage].push_back(bid.offset);
+
+    for (const auto& d : disk_offsets)
+    {
+        const std::vector<uint64_t>& offsets = d.second;
+        for (size_t i = 1; i < offsets.size(); ++i)
+        {
+            if (i % 8 != 0)
+                die_unequal(offsets[i], offsets[i - 1] + bid_type::size);
+        }
+    }
+
+    die_unequal(bm->current_allocation(),
+                allocated + (stream.size() + other.size()) * bid_type::size);
+    die_unless(extents.reserved_bytes() > 0);
+
+    extents.release();
+    die_unequal(extents.reserved_bytes(), 0u);
+
+    bm->delete_blocks(stream.begin(), stream.end());
+    bm->delete_blocks(other.begin(), other.end());
+    die_unequal(bm->current_allocation(), allocated);
+}
+
+int main()
+{
+    test_reserve_extent();
+    test_stream();
+    return 0;
+}
+
+/**************************************************************************/
@@ -12,6 +12,7 @@
 
 #include <iostream>
 
+#include <tlx/die.hpp>
 #include <tlx/logger.hpp>
 
 #include <foxxll/mng.hpp>
@@ -60,6 +61,9 @@ int main()
     bm->delete_blocks(b5d.begin(), b5d.end());
 
     bm->delete_blocks(b2.begin(), b2.end());
+
+    die_unequal(bm->current_allocation(), 0u);
+    die_unequal(bm->free_bytes(), bm->total_bytes());
 }
 
 /**************************************************************************/
@@ -0,0 +1,200 @@
+/***************************************************************************
+ *  tests/mng/test_block_metadata.cpp
+ *
+ *  Stores named blocks in one run of the program and reattaches them in a
+ *  second run, which this test starts as a child process.
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <tlx/die.hpp>
+#include <tlx/unused.hpp>
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/mng.hpp>
+
+using bid_type = foxxll::BID<4096>;
+
+static const char* disk_path = "/tmp/foxxll_test_metadata.dat";
+static const char* metadata_path = "/tmp/foxxll_test_metadata.meta";
+static const char* no_metadata_path = "/tmp/foxxll_test_no_metadata.dat";
+
+static void configure()
+{
+    foxxll::disk_config disk(
+        disk_path, 64 * bid_type::size,
+        std::string("syscall direct=off metadata=") + metadata_path);
+    foxxll::config::get_instance()->add_disk(disk);
+}
+
+//! fill a block with its index, or check that it does
+static void fill_block(char* buffer, size_t index)
+{
+    memset(buffer, static_cast<int>('a' + index % 26), bid_type::size);
+}
+
+//! first run: allocate beyond the configured size and store named blocks
+static void write_run()
+{
+    configure();
+    foxxll::block_manager* bm = foxxll::block_manager::get_instance();
+
+    std::vector<bid_type> temp(70), data(40);
+    bm->new_blocks(foxxll::striping(), temp.begin(), temp.end());
+    bm->new_blocks(foxxll::striping(), data.begin(), data.end());
+    bm->delete_blocks(temp.begin(), temp.end());
+
+    char* buffer = static_cast<char*>(foxxll::aligned_alloc<4096>(bid_type::size));
+    for (size_t i = 0; i < data.size(); ++i) {
+        fill_block(buffer, i);
+        data[i].write(buffer, bid_type::size)->wait();
+    }
+    foxxll::aligned_dealloc<4096>(buffer);
+
+    bm->store_blocks("data", data.begin(), data.end());
+
+    std::vector<foxxll::BID<0> > varsize(
+        3, foxxll::BID<0>(nullptr, 0, 3 * bid_type::size));
+    bm->new_blocks(foxxll::striping(), varsize.begin(), varsize.end());
+    bm->store_blocks("varsize", varsize.begin(), varsize.end());
+
+    die_unless_throws(bm->store_blocks("bad name", data.begin(), data.end()),
+                      foxxll::bad_parameter);
+
+    // a block is stored under one name only
+    die_unless_throws(bm->store_blocks("copy", data.begin(), data.begin() + 1),
+                      foxxll::bad_parameter);
+
+    // freeing a stored block drops its name, the space is stored again
+    // under another name without corrupting the checkpoint
+    std::vector<bid_type> stale(2);
+    bm->new_blocks(foxxll::striping(), stale.begin(), stale.end());
+    bm->store_blocks("stale", stale.begin(), stale.end());
+    bm->delete_blocks(stale.begin(), stale.begin() + 1);
+    die_unless(!bm->load_blocks("stale", stale));
+    bm->delete_blocks(stale.begin() + 1, stale.end());
+
+    std::vector<bid_type> reused(2);
+    bm->new_blocks(foxxll::striping(), reused.begin(), reused.end());
+    bm->store_blocks("reused", reused.begin(), reused.end());
+
+    // the block_manager checkpoints on destruction
+}
+
+//! second run: reattach the blocks and check their contents
+static void read_run()
+{
+    configure();
+    foxxll::block_manager* bm = foxxll::block_manager::get_instance();
+
+    std::vector<bid_type> data;
+    die_unless(bm->load_blocks("data", data));
+    die_unequal(data.size(), 40u);
+
+    std::vector<foxxll::BID<0> > varsize;
+    die_unless(bm->load_blocks("varsize", varsize));
+    die_unequal(varsize.size(), 3u);
+    die_unequal(varsize[0].size, 3 * bid_type::size);
+
+    std::vector<bid_type> reused;
+    die_unless(bm->load_blocks("reused", reused));
+    die_unequal(reused.size(), 2u);
+
+    std::vector<bid_type> wrong;
+    die_unless(!bm->load_blocks("missing", wrong));
+    die_unless(!bm->load_blocks("stale", wrong));
+    die_unless_throws(bm->load_blocks("varsize", wrong), foxxll::bad_parameter);
+
+    // only the stored blocks are allocated
+    die_unequal(bm->current_allocation(), (40 + 9 + 2) * bid_type::size);
+    die_unequal(bm->total_bytes() - bm->free_bytes(), (40 + 9 + 2) * bid_type::size);
+
+    char* buffer = static_cast<char*>(foxxll::aligned_alloc<4096>(bid_type::size));
+    char* expected = static_cast<char*>(foxxll::aligned_alloc<4096>(bid_type::size));
+    for (size_t i = 0; i < data.size(); ++i) {
+        fill_block(expected, i);
+        data[i].read(buffer, bid_type::size)->wait();
+        die_unless(memcmp(buffer, expected, bid_type::size) == 0);
+    }
+    foxxll::aligned_dealloc<4096>(expected);
+    foxxll::aligned_dealloc<4096>(buffer);
+
+    // new blocks do not overlap the stored ones
+    std::vector<bid_type> more(20);
+    bm->new_blocks(foxxll::striping(), more.begin(), more.end());
+    for (const bid_type& a : more) {
+        for (const bid_type& b : data)
+            die_unless(a.offset != b.offset);
+        for (const foxxll::BID<0>& b : varsize)
+            die_unless(a.offset + a.size <= b.offset || b.offset + b.size <= a.offset);
+    }
+    bm->delete_blocks(more.begin(), more.end());
+
+    bm->erase_blocks("data");
+    bm->erase_blocks("varsize");
+    bm->delete_blocks(data.begin(), data.end());
+    bm->delete_blocks(varsize.begin(), varsize.end());
+    bm->delete_blocks(reused.begin(), reused.end());
+    die_unless(bm->stored_names().empty());
+}
+
+//! blocks on a disk without metadata file cannot be stored
+static void no_metadata_run()
+{
+    foxxll::disk_config disk(
+        no_metadata_path, 64 * bid_type::size, "syscall direct=off delete_on_exit");
+    foxxll::config::get_instance()->add_disk(disk);
+    foxxll::block_manager* bm = foxxll::block_manager::get_instance();
+
+    std::vector<bid_type> bids(2);
+    bm->new_blocks(foxxll::striping(), bids.begin(), bids.end());
+    die_unless_throws(bm->store_blocks("data", bids.begin(), bids.end()),
+                      foxxll::bad_parameter);
+    die_unless(bm->stored_names().empty());
+    bm->delete_blocks(bids.begin(), bids.end());
+}
+
+int main(int argc, char* argv[])
+{
+#if !FOXXLL_WINDOWS
+    if (argc == 2 && std::string(argv[1]) == "write") {
+        write_run();
+        return 0;
+    }
+    if (argc == 2 && std::string(argv[1]) == "read") {
+        read_run();
+        return 0;
+    }
+    if (argc == 2 && std::string(argv[1]) == "no_metadata") {
+        no_metadata_run();
+        return 0;
+    }
+
+    std::remove(disk_path);
+    std::remove(metadata_path);
+
+    die_unequal(std::system((std::string(argv[0]) + " write").c_str()), 0);
+    die_unequal(std::system((std::string(argv[0]) + " read").c_str()), 0);
+    die_unequal(std::system((std::string(argv[0]) + " no_metadata").c_str()), 0);
+
+    std::remove(disk_path);
+    std::remove(metadata_path);
+#else
+    tlx::unused(argc, argv);
+#endif
+    return 0;
+}
+
+/**************************************************************************/
@@ -0,0 +1,105 @@
+/***************************************************************************
+ *  tests/mng/test_block_thread_cache.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io/memory_file.hpp>
+#include <foxxll/mng/disk_block_allocator.hpp>
+
+using bid_type = foxxll::BID<4096>;
+
+int main()
+{
+    foxxll::memory_file storage;
+
+    foxxll::disk_config cfg("/dev/null", 64 * bid_type::size, "memory");
+    cfg.autogrow = false;
+    cfg.thread_cache = 8;
+
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    // the first single block allocation reserves a batch for this thread
+    bid_type bid(&storage, 0);
+    alloc.new_blocks(&bid, &bid + 1);
+    die_unequal(alloc.free_bytes(), (64 - 8) * bid_type::size);
+
+    // freeing and allocating again reuses the cached block
+    const uint64_t offset = bid.offset;
+    alloc.delete_block(bid);
+    alloc.new_blocks(&bid, &bid + 1);
+    die_unequal(bid.offset, offset);
+    die_unequal(alloc.free_bytes(), (64 - 8) * bid_type::size);
+    alloc.delete_block(bid);
+
+    // a block freed twice is not cached twice
+    die_unless_throws(alloc.delete_block(bid), foxxll::bad_ext_alloc);
+    bid_type first(&storage, 0), second(&storage, 0);
+    alloc.new_blocks(&first, &first + 1);
+    alloc.new_blocks(&second, &second + 1);
+    die_unequal(first.offset, offset);
+    die_unless(second.offset != offset);
+    alloc.delete_block(second);
+    alloc.delete_block(first);
+
+    // multi-block allocations bypass the cache
+    std::vector<bid_type> run(4, bid_type(&storage, 0));
+    alloc.new_blocks(run.begin(), run.end());
+    die_unequal(alloc.free_bytes(), (64 - 12) * bid_type::size);
+
+    // threads allocate distinct blocks and return their caches on exit
+    std::vector<std::thread> threads;
+    std::vector<std::vector<bid_type> > blocks(4);
+    for (size_t t = 0; t < blocks.size(); ++t)
+    {
+        threads.emplace_back(
+            [&alloc, &storage, &blocks, t]() {
+                for (size_t i = 0; i < 6; ++i) {
+                    bid_type b(&storage, 0);
+                    alloc.new_blocks(&b, &b + 1);
+                    blocks[t].push_back(b);
+                }
+                // free half, keep the rest
+                for (size_t i = 0; i < 3; ++i)
+                    alloc.delete_block(blocks[t][i]);
+                blocks[t].erase(blocks[t].begin(), blocks[t].begin() + 3);
+            });
+    }
+    for (std::thread& t : threads)
+        t.join();
+
+    std::set<uint64_t> offsets;
+    for (const bid_type& b : run)
+        offsets.insert(b.offset);
+    for (const std::vector<bid_type>& v : blocks) {
+        for (const bid_type& b : v)
+            offsets.insert(b.offset);
+    }
+    die_unequal(offsets.size(), 4u + 4u * 3u);
+
+    // only this thread's cache and the live blocks are in use
+    die_unequal(alloc.free_bytes(), (64 - 8 - 4 - 4 * 3) * bid_type::size);
+
+    for (const std::vector<bid_type>& v : blocks) {
+        for (const bid_type& b : v)
+            alloc.delete_block(b);
+    }
+    for (const bid_type& b : run)
+        alloc.delete_block(b);
+
+    return 0;
+}
+
+/**************************************************************************/
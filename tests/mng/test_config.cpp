@@ -10,9 +10,14 @@
  *  http://www.boost.org/LICENSE_1_0.txt)
  **************************************************************************/
 
+#include <cstdio>
+#include <fstream>
+#include <string>
+
 #include <tlx/die.hpp>
 
 #include <foxxll/mng.hpp>
+#include <foxxll/mng/block_alloc_strategy_dynamic.hpp>
 
 void test1()
 {
@@ -36,6 +41,118 @@ void test1()
     die_unequal(cfg.queue, 5);
     die_unequal(cfg.direct, foxxll::disk_config::DIRECT_ON);
 
+    // test discard_batch and prealloc options
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall discard_batch=64MiB prealloc");
+
+    die_unequal(cfg.discard_batch, 64 * 1024 * uint64_t(1024));
+    die_unequal(cfg.prealloc, true);
+    die_unequal(cfg.fileio_string(), "syscall prealloc discard_batch=67108864");
+
+    die_unless_throws(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, memory discard_batch=1MiB"),
+        std::runtime_error
+    );
+
+    // test placement option, first-fit is the default
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall");
+
+    die_unequal(cfg.placement, foxxll::disk_config::FIRST_FIT);
+    die_unequal(cfg.fileio_string(), "syscall");
+
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall placement=best_fit");
+
+    die_unequal(cfg.placement, foxxll::disk_config::BEST_FIT);
+    die_unequal(cfg.fileio_string(), "syscall placement=best_fit");
+
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall placement=next_fit");
+
+    die_unequal(cfg.placement, foxxll::disk_config::NEXT_FIT);
+    die_unequal(cfg.fileio_string(), "syscall placement=next_fit");
+
+    die_unless_throws(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, syscall placement=worst_fit"),
+        std::runtime_error
+    );
+
+    // test block_size option
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall block_size=2MiB");
+
+    die_unequal(cfg.block_size, 2 * 1024 * uint64_t(1024));
+    die_unequal(cfg.fileio_string(), "syscall block_size=2097152");
+
+    die_unless_throws(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, syscall block_size=0"),
+        std::runtime_error
+    );
+
+    // test thread_cache option
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall thread_cache=64");
+
+    die_unequal(cfg.thread_cache, 64u);
+    die_unequal(cfg.fileio_string(), "syscall thread_cache=64");
+
+    die_unless_throws(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, syscall thread_cache=many"),
+        std::runtime_error
+    );
+
+    // test shrink option
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall shrink=256MiB");
+
+    die_unequal(cfg.shrink, 256 * 1024 * uint64_t(1024));
+    die_unequal(cfg.fileio_string(), "syscall shrink=268435456");
+
+    die_unless_throws(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, syscall shrink=lots"),
+        std::runtime_error
+    );
+
+    // test bandwidth option
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall bandwidth=200M");
+
+    die_unequal(cfg.bandwidth, 200 * uint64_t(1000000));
+    die_unequal(cfg.fileio_string(), "syscall bandwidth=200000000");
+
+    die_unless_throws(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, syscall bandwidth=fast"),
+        std::runtime_error
+    );
+
+    // test metadata option
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall metadata=/var/tmp/foxxll.meta");
+
+    die_unequal(cfg.metadata, "/var/tmp/foxxll.meta");
+    die_unequal(cfg.fileio_string(), "syscall metadata=/var/tmp/foxxll.meta");
+
+    die_unless_throws(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, memory metadata=/var/tmp/foxxll.meta"),
+        std::runtime_error
+    );
+
+    // metadata is rejected for files which do not persist blocks as written
+    for (const char* line : {
+             "disk=/var/tmp/foxxll.tmp, 100 GiB, chunked_memory metadata=/var/tmp/foxxll.meta",
+             "disk=/var/tmp/foxxll.tmp, 100 GiB, syscall compress=lz4 metadata=/var/tmp/foxxll.meta",
+             "disk=/var/tmp/foxxll.tmp, 100 GiB, syscall metadata=/var/tmp/foxxll.meta compress=lz4",
+             "disk=/var/tmp/foxxll.tmp, 100 GiB, syscall metadata=/var/tmp/foxxll.meta delete_on_exit",
+             "disk=/var/tmp/foxxll.tmp, 100 GiB, syscall unlink metadata=/var/tmp/foxxll.meta",
+             "disk=/var/tmp/foxxll.tmp, 0, syscall metadata=/var/tmp/foxxll.meta"
+         })
+    {
+        die_unless_throws(cfg.parse_line(line), std::runtime_error);
+    }
+
+    // test compress option
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , linuxaio compress=lz4");
+
+    die_unequal(cfg.compress, "lz4");
+    die_unequal(cfg.fileio_string(), "linuxaio compress=lz4");
+
+    die_unless_throws(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, syscall compress=zstd:1"),
+        std::runtime_error
+    );
+
     // bad configurations
 
     die_unless_throws(
@@ -97,13 +214,48 @@ void test2()
     die_unequal(bm->total_bytes(), 300u * 1024 * 1024);
     die_unequal(bm->free_bytes(), 300u * 1024 * 1024);
 
+    // select the runtime allocation strategy
+    config->set_alloc_strategy("striping");
+
+    foxxll::dynamic_alloc_strategy strategy;
+    die_unequal(std::string(strategy.name()), "striping");
+    for (size_t i = 0; i < 8; ++i)
+        die_unequal(strategy(i), i % 2);
+
 #endif
 }
 
+//! the global alloc_strategy line of a configuration file
+void test_alloc_strategy_line()
+{
+    foxxll::config* config = foxxll::config::get_instance();
+    const std::string path = "test_config_alloc_strategy.cfg";
+
+    {
+        std::ofstream out(path.c_str());
+        out << " alloc_strategy =  fully_random \n"
+            << "disk=/tmp/foxxll_###.tmp,10MiB,memory\n";
+    }
+    config->load_config_file(path);
+    die_unequal(foxxll::dynamic_alloc_strategy::configured_name(), "fully_random");
+
+    // unknown strategies are rejected while parsing
+    {
+        std::ofstream out(path.c_str());
+        out << "alloc_strategy=round_robin\n"
+            << "disk=/tmp/foxxll_###.tmp,10MiB,memory\n";
+    }
+    die_unless_throws(config->load_config_file(path), std::runtime_error);
+    die_unequal(foxxll::dynamic_alloc_strategy::configured_name(), "fully_random");
+
+    std::remove(path.c_str());
+}
+
 int main()
 {
     test1();
     test2();
+    test_alloc_strategy_line();
 
     return 0;
 }
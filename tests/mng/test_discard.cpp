@@ -0,0 +1,258 @@
+/***************************************************************************
+ *  tests/mng/test_discard.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/config.hpp>
+
+#if !FOXXLL_WINDOWS
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tlx/die.hpp>
+#include <tlx/logger.hpp>
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io/syscall_file.hpp>
+#include <foxxll/mng/disk_block_allocator.hpp>
+
+using bid_type = foxxll::BID<65536>;
+constexpr uint64_t block = 65536;
+
+#if defined(__linux__) && defined(SEEK_HOLE) && defined(FALLOC_FL_PUNCH_HOLE) \
+    && !defined(FOXXLL_UFS_NO_PUNCH_HOLE)
+
+//! allocated bytes of a file
+static uint64_t allocated_bytes(const std::string& path)
+{
+    struct stat st;
+    die_unless(::stat(path.c_str(), &st) == 0);
+    return static_cast<uint64_t>(st.st_blocks) * 512;
+}
+
+//! offset of the first hole at or after offset
+static uint64_t next_hole(const std::string& path, uint64_t offset)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    die_unless(fd >= 0);
+    const off_t pos = ::lseek(fd, static_cast<off_t>(offset), SEEK_HOLE);
+    ::close(fd);
+    die_unless(pos >= 0);
+    return static_cast<uint64_t>(pos);
+}
+
+//! whether the file system of path punches holes
+static bool supports_punch_hole(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    die_unless(fd >= 0);
+    const bool ok =
+        ::ftruncate(fd, block) == 0 &&
+        ::fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 0, block) == 0;
+    ::close(fd);
+    std::remove(path.c_str());
+    return ok;
+}
+
+//! allocate all 8 blocks of the disk and write them
+static std::vector<bid_type> fill_disk(
+    foxxll::disk_block_allocator& alloc, foxxll::file& storage, char* buffer)
+{
+    std::vector<bid_type> bids(8, bid_type(&storage, 0));
+    alloc.new_blocks(bids.begin(), bids.end());
+
+    memset(buffer, 0x5a, block);
+    for (const bid_type& bid : bids)
+        storage.awrite(buffer, bid.offset, block)->wait();
+    return bids;
+}
+
+//! each freed block is punched at once
+void test_discard(const std::string& path, char* buffer)
+{
+    foxxll::syscall_file storage(path, foxxll::file::CREAT | foxxll::file::RDWR);
+    foxxll::disk_config cfg(path, 8 * block, "syscall");
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    std::vector<bid_type> bids = fill_disk(alloc, storage, buffer);
+    die_unequal(next_hole(path, 0), 8 * block);
+    const uint64_t allocated = allocated_bytes(path);
+
+    alloc.delete_block(bids[2]);
+    die_unequal(next_hole(path, 0), 2 * block);
+    die_unless(allocated_bytes(path) <= allocated - block);
+
+    // the other blocks keep their data
+    storage.aread(buffer, 3 * block, block)->wait();
+    die_unequal(buffer[0], 0x5a);
+
+    for (size_t i = 0; i < 8; ++i)
+    {
+        if (i != 2)
+            alloc.delete_block(bids[i]);
+    }
+}
+
+//! freed blocks are punched once they coalesce to discard_batch bytes
+void test_discard_batch(const std::string& path, char* buffer)
+{
+    foxxll::syscall_file storage(path, foxxll::file::CREAT | foxxll::file::RDWR);
+    foxxll::disk_config cfg(path, 8 * block, "syscall");
+    cfg.discard_batch = 3 * block;
+    cfg.placement = foxxll::disk_config::BEST_FIT;
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    std::vector<bid_type> bids = fill_disk(alloc, storage, buffer);
+    const uint64_t allocated = allocated_bytes(path);
+
+    // separate blocks stay below the batch size
+    alloc.delete_block(bids[1]);
+    alloc.delete_block(bids[3]);
+    die_unequal(next_hole(path, 0), 8 * block);
+    die_unequal(allocated_bytes(path), allocated);
+
+    // the block in between joins them to one region of three blocks
+    alloc.delete_block(bids[2]);
+    die_unequal(next_hole(path, 0), 1 * block);
+    die_unequal(next_hole(path, 4 * block), 8 * block);
+    die_unless(allocated_bytes(path) <= allocated - 3 * block);
+
+    // a pending region allocated again is not punched with its neighbors
+    alloc.delete_block(bids[6]);
+    bid_type again(&storage, 0);
+    alloc.new_blocks(&again, &again + 1);
+    die_unequal(again.offset, bids[6].offset);
+
+    memset(buffer, 0x77, block);
+    storage.awrite(buffer, again.offset, block)->wait();
+    alloc.delete_block(bids[5]);
+    alloc.delete_block(bids[7]);
+    die_unequal(next_hole(path, 4 * block), 8 * block);
+
+    memset(buffer, 0, block);
+    storage.aread(buffer, again.offset, block)->wait();
+    die_unequal(buffer[0], 0x77);
+
+    // freeing it joins the three blocks, which are punched
+    alloc.delete_block(again);
+    die_unequal(next_hole(path, 4 * block), 5 * block);
+
+    alloc.delete_block(bids[0]);
+    alloc.delete_block(bids[4]);
+}
+
+//! threads allocate, write, check and free blocks concurrently. A discard
+//! of a freed region must not hit the data of a thread which allocated the
+//! region again.
+void test_discard_threads(const std::string& path)
+{
+    const size_t num_threads = 8, rounds = 1000;
+
+    foxxll::syscall_file storage(path, foxxll::file::CREAT | foxxll::file::RDWR);
+    foxxll::disk_config cfg(path, 2 * num_threads * block, "syscall");
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back(
+            [&, t]() {
+                char* buffer = static_cast<char*>(
+                    foxxll::aligned_alloc<foxxll::BlockAlignment>(2 * block));
+
+                for (size_t r = 0; r < rounds; ++r)
+                {
+                    std::vector<bid_type> bids(2, bid_type(&storage, 0));
+                    alloc.new_blocks(bids.begin(), bids.end());
+
+                    const char seed = static_cast<char>((t * rounds + r) % 255 + 1);
+                    for (const bid_type& bid : bids)
+                    {
+                        memset(buffer, seed, block);
+                        storage.awrite(buffer, bid.offset, block)->wait();
+                    }
+                    for (const bid_type& bid : bids)
+                    {
+                        memset(buffer, 0, block);
+                        storage.aread(buffer, bid.offset, block)->wait();
+                        die_unequal(buffer[0], seed);
+                        die_unequal(buffer[block - 1], seed);
+                    }
+
+                    // free single blocks and batches
+                    if (t % 2 == 0) {
+                        for (const bid_type& bid : bids)
+                            alloc.delete_block(bid);
+                    }
+                    else {
+                        std::vector<foxxll::disk_block_allocator::place> regions;
+                        for (const bid_type& bid : bids)
+                            regions.emplace_back(bid.offset, block);
+                        alloc.delete_regions(regions);
+                    }
+                }
+
+                foxxll::aligned_dealloc<foxxll::BlockAlignment>(buffer);
+            });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        LOG1 << "Usage: " << argv[0] << " tempdir";
+        return -1;
+    }
+
+    const std::string path = std::string(argv[1]) + "/test_discard.dat";
+
+    if (!supports_punch_hole(path)) {
+        LOG1 << "File system of " << argv[1] << " does not punch holes, skipped.";
+        return 0;
+    }
+
+    char* buffer = static_cast<char*>(
+        foxxll::aligned_alloc<foxxll::BlockAlignment>(block));
+
+    test_discard(path, buffer);
+    std::remove(path.c_str());
+    test_discard_batch(path, buffer);
+    std::remove(path.c_str());
+    test_discard_threads(path);
+    std::remove(path.c_str());
+
+    foxxll::aligned_dealloc<foxxll::BlockAlignment>(buffer);
+    return 0;
+}
+
+#else
+
+int main()
+{
+    LOG1 << "Hole punching is not available, skipped.";
+    return 0;
+}
+
+#endif
+
+/**************************************************************************/
@@ -0,0 +1,187 @@
+/***************************************************************************
+ *  tests/mng/test_disk_allocation_stats.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <vector>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io/memory_file.hpp>
+#include <foxxll/mng/block_extent_allocator.hpp>
+#include <foxxll/mng/block_manager.hpp>
+#include <foxxll/mng/disk_block_allocator.hpp>
+
+using bid_type = foxxll::BID<4096>;
+constexpr uint64_t block = 4096;
+
+//! allocations, frees, fragmentation, splits and growth of one disk
+void test_allocator(bool bitmap)
+{
+    foxxll::disk_config cfg("/dev/null", 8 * block, "memory");
+    cfg.block_size = bitmap ? block : 0;
+
+    foxxll::memory_file storage;
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    // the initial size of the file is no growth by allocations
+    foxxll::disk_allocation_stats_data s0 = alloc.allocation_stats();
+    die_unequal(s0.get_total_bytes(), 8 * block);
+    die_unequal(s0.get_free_bytes(), 8 * block);
+    die_unequal(s0.get_free_regions(), 1u);
+    die_unequal(s0.get_largest_free_region(), 8 * block);
+    die_unequal(s0.get_fragmentation(), 0.0);
+    die_unequal(s0.get_grow_count(), 0u);
+
+    std::vector<bid_type> bids(8, bid_type(&storage, 0));
+    alloc.new_blocks(bids.begin(), bids.end());
+
+    // free every other block: three separate free blocks and one at the end
+    for (size_t i = 1; i < 8; i += 2)
+        alloc.delete_block(bids[i]);
+
+    foxxll::disk_allocation_stats_data s1 = alloc.allocation_stats();
+    die_unequal(s1.get_alloc_blocks(), 8u);
+    die_unequal(s1.get_alloc_bytes(), 8 * block);
+    die_unequal(s1.get_freed_blocks(), 4u);
+    die_unequal(s1.get_freed_bytes(), 4 * block);
+    die_unequal(s1.get_free_bytes(), 4 * block);
+    die_unequal(s1.get_free_regions(), 4u);
+    die_unequal(s1.get_largest_free_region(), block);
+    die_unequal(s1.get_fragmentation(), 0.75);
+    die_unless(s1.get_lock_hold_time() >= 0.0);
+
+    // two blocks fit into the free space, but not contiguously
+    std::vector<bid_type> pair(2, bid_type(&storage, 0));
+    alloc.new_blocks(pair.begin(), pair.end());
+
+    // four blocks do not fit, the file grows
+    std::vector<bid_type> more(4, bid_type(&storage, 0));
+    alloc.new_blocks(more.begin(), more.end());
+
+    foxxll::disk_allocation_stats_data s2 = alloc.allocation_stats();
+    die_unequal(s2.get_split_count(), 1u);
+    die_unequal(s2.get_grow_count(), 1u);
+    die_unequal(s2.get_grow_bytes(), 4 * block);
+    die_unequal(s2.get_total_bytes(), 12 * block);
+
+    // the difference holds the counters of the interval and the current
+    // free space
+    foxxll::disk_allocation_stats_data d = s2 - s1;
+    die_unequal(d.get_alloc_blocks(), 6u);
+    die_unequal(d.get_alloc_bytes(), 6 * block);
+    die_unequal(d.get_freed_blocks(), 0u);
+    die_unequal(d.get_split_count(), 1u);
+    die_unequal(d.get_free_bytes(), s2.get_free_bytes());
+    die_unequal(d.get_free_regions(), s2.get_free_regions());
+    die_unequal(d.get_alloc_rate(2.0), 3.0);
+    die_unequal(d.get_free_rate(0.0), 0.0);
+
+    // freeing a batch counts each block
+    std::vector<foxxll::disk_block_allocator::place> regions;
+    for (const bid_type& bid : more)
+        regions.emplace_back(bid.offset, block);
+    alloc.delete_regions(regions);
+    die_unequal((alloc.allocation_stats() - s2).get_freed_blocks(), 4u);
+}
+
+//! blocks handed out by and returned to a thread cache are counted, the
+//! refills and drains of the cache are not
+void test_thread_cache()
+{
+    foxxll::disk_config cfg("/dev/null", 64 * block, "memory");
+    cfg.thread_cache = 4;
+
+    foxxll::memory_file storage;
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    // the first allocation refills the cache with 4 blocks
+    bid_type bid(&storage, 0);
+    alloc.new_blocks(&bid, &bid + 1);
+
+    foxxll::disk_allocation_stats_data s = alloc.allocation_stats();
+    die_unequal(s.get_alloc_blocks(), 1u);
+    die_unequal(s.get_alloc_bytes(), block);
+    alloc.delete_block(bid);
+
+    // 12 blocks refill the cache repeatedly, freeing them drains it
+    std::vector<bid_type> bids(12, bid_type(&storage, 0));
+    for (bid_type& b : bids)
+        alloc.new_blocks(&b, &b + 1);
+    for (const bid_type& b : bids)
+        alloc.delete_block(b);
+
+    s = alloc.allocation_stats();
+    die_unequal(s.get_alloc_blocks(), 13u);
+    die_unequal(s.get_alloc_bytes(), 13 * block);
+    die_unequal(s.get_freed_blocks(), 13u);
+    die_unequal(s.get_freed_bytes(), 13 * block);
+}
+
+//! an extent counts its bytes, the blocks carved from it are counted one by
+//! one, and its tail counts as freed bytes
+void test_extent()
+{
+    foxxll::block_manager* bm = foxxll::block_manager::get_instance();
+    const foxxll::disk_allocation_stats_data before = bm->allocation_stats(0);
+
+    std::vector<bid_type> bids(3);
+    {
+        foxxll::block_extent_allocator extents(8 * block, bm);
+        extents.new_blocks(foxxll::single_disk(0), bids.begin(), bids.end());
+
+        const foxxll::disk_allocation_stats_data d =
+            bm->allocation_stats(0) - before;
+        die_unequal(d.get_alloc_blocks(), 3u);
+        die_unequal(d.get_alloc_bytes(), 8 * block);
+        die_unequal(d.get_freed_blocks(), 0u);
+    }
+
+    bm->delete_blocks(bids.begin(), bids.end());
+
+    const foxxll::disk_allocation_stats_data d = bm->allocation_stats(0) - before;
+    die_unequal(d.get_alloc_blocks(), 3u);
+    die_unequal(d.get_freed_blocks(), 3u);
+    die_unequal(d.get_alloc_bytes(), 8 * block);
+    die_unequal(d.get_freed_bytes(), 8 * block);
+}
+
+//! the block manager reports the statistics of each disk
+void test_block_manager()
+{
+    foxxll::block_manager* bm = foxxll::block_manager::get_instance();
+    const foxxll::disk_allocation_stats_data before = bm->allocation_stats(0);
+
+    bid_type bid;
+    bm->new_block(foxxll::single_disk(0), bid);
+
+    const std::vector<foxxll::disk_allocation_stats_data> disks =
+        bm->allocation_stats();
+    die_unless(!disks.empty());
+    die_unequal((disks[0] - before).get_alloc_blocks(), 1u);
+    die_unequal((disks[0] - before).get_alloc_bytes(), block);
+
+    bm->delete_block(bid);
+    die_unequal((bm->allocation_stats(0) - before).get_freed_blocks(), 1u);
+}
+
+int main()
+{
+    for (bool bitmap : { false, true })
+        test_allocator(bitmap);
+
+    test_thread_cache();
+    test_block_manager();
+    test_extent();
+
+    return 0;
+}
+
+/**************************************************************************/
@@ -0,0 +1,136 @@
+/***************************************************************************
+ *  tests/mng/test_disk_placement.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io/memory_file.hpp>
+#include <foxxll/mng/disk_block_allocator.hpp>
+
+using foxxll::disk_config;
+
+constexpr uint64_t block = 4096;
+
+//! allocate a region of n blocks, returns its offset in blocks
+static uint64_t allocate(foxxll::disk_block_allocator& alloc,
+                         foxxll::file* storage, size_t n)
+{
+    foxxll::BID<0> bid(storage, 0, n * block);
+    alloc.new_blocks(&bid, &bid + 1);
+    return bid.offset / block;
+}
+
+//! Fills a disk of 32 blocks and frees the regions (in blocks)
+//! [1,3) [5,9) [11,14) [16,17) [19,21) [24,32)
+//! then allocates 3, 1 and 2 blocks and checks their offsets.
+static void test_policy(disk_config::placement_type placement,
+                        const std::vector<uint64_t>& expected)
+{
+    foxxll::memory_file storage;
+    disk_config cfg("/dev/null", 32 * block, "memory");
+    cfg.autogrow = false;
+    cfg.placement = placement;
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    std::vector<foxxll::BID<0> > bids(32, foxxll::BID<0>(&storage, 0, block));
+    alloc.new_blocks(bids.begin(), bids.end());
+
+    const std::pair<size_t, size_t> free_runs[] = {
+        { 1, 3 }, { 5, 9 }, { 11, 14 }, { 16, 17 }, { 19, 21 }, { 24, 32 }
+    };
+    for (const std::pair<size_t, size_t>& run : free_runs) {
+        for (size_t i = run.first; i < run.second; ++i)
+            alloc.delete_block(bids[i]);
+    }
+    die_unequal(alloc.free_region_count(), 6u);
+
+    const size_t sizes[] = { 3, 1, 2 };
+    for (size_t i = 0; i < expected.size(); ++i)
+        die_unequal(allocate(alloc, &storage, sizes[i]), expected[i]);
+}
+
+//! first-fit through the size classes matches a linear scan for the first
+//! run of free blocks under random allocations and frees
+static void test_first_fit_random()
+{
+    const size_t num_blocks = 256;
+
+    foxxll::memory_file storage;
+    disk_config cfg("/dev/null", num_blocks * block, "memory");
+    cfg.autogrow = false;
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    // the reference of free blocks and the allocated regions
+    std::vector<bool> free(num_blocks, true);
+    std::vector<foxxll::BID<0> > allocated;
+
+    std::mt19937 rng(42);
+
+    for (size_t round = 0; round < 4000; ++round)
+    {
+        if (rng() % 2 == 0 || allocated.empty())
+        {
+            const size_t n = 1 + rng() % 12;
+
+            // the first run of n free blocks
+            size_t expect = num_blocks;
+            for (size_t i = 0, run = 0; i < num_blocks; ++i) {
+                run = free[i] ? run + 1 : 0;
+                if (run == n) {
+                    expect = i + 1 - n;
+                    break;
+                }
+            }
+            if (expect == num_blocks)
+                continue;
+
+            die_unequal(allocate(alloc, &storage, n), expect);
+            for (size_t i = expect; i < expect + n; ++i)
+                free[i] = false;
+            allocated.emplace_back(&storage, expect * block, n * block);
+        }
+        else
+        {
+            const size_t k = rng() % allocated.size();
+            const foxxll::BID<0> bid = allocated[k];
+            allocated[k] = allocated.back();
+            allocated.pop_back();
+
+            alloc.delete_block(bid);
+            for (size_t i = bid.offset / block; i < (bid.offset + bid.size) / block; ++i)
+                free[i] = true;
+        }
+    }
+
+    for (const foxxll::BID<0>& bid : allocated)
+        alloc.delete_block(bid);
+    die_unequal(alloc.free_region_count(), 1u);
+}
+
+int main()
+{
+    // lowest offset: a 4 block region precedes the fitting one of 3 blocks
+    test_policy(disk_config::FIRST_FIT, { 5, 1, 11 });
+    // smallest region, lowest offset among equally sized ones
+    test_policy(disk_config::BEST_FIT, { 11, 16, 1 });
+    // continues after the previous allocation
+    test_policy(disk_config::NEXT_FIT, { 5, 8, 11 });
+
+    test_first_fit_random();
+
+    return 0;
+}
+
+/**************************************************************************/
@@ -0,0 +1,283 @@
+/***************************************************************************
+ *  tests/mng/test_disk_shrink.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io/memory_file.hpp>
+#include <foxxll/mng.hpp>
+#include <foxxll/mng/block_extent_allocator.hpp>
+#include <foxxll/mng/disk_block_allocator.hpp>
+
+using bid_type = foxxll::BID<4096>;
+constexpr uint64_t block = 4096;
+
+//! configured for 4 blocks, autogrown to 12
+static foxxll::disk_config make_config(bool bitmap, uint64_t shrink)
+{
+    foxxll::disk_config cfg("/dev/null", 4 * block, "memory");
+    cfg.block_size = bitmap ? block : 0;
+    cfg.shrink = shrink;
+    return cfg;
+}
+
+//! fill the configured blocks, then grow the file by 8 blocks
+static std::vector<bid_type> allocate_blocks(
+    foxxll::disk_block_allocator& alloc, foxxll::file* storage)
+{
+    std::vector<bid_type> bids(12, bid_type(storage, 0));
+    alloc.new_blocks(bids.begin(), bids.begin() + 4);
+    alloc.new_blocks(bids.begin() + 4, bids.end());
+    die_unequal(alloc.total_bytes(), 12 * block);
+    return bids;
+}
+
+//! freeing the end of an autogrown file truncates it
+void test_shrink(bool bitmap)
+{
+    foxxll::memory_file storage;
+    foxxll::disk_block_allocator alloc(&storage, make_config(bitmap, 2 * block));
+
+    std::vector<bid_type> bids = allocate_blocks(alloc, &storage);
+
+    // one free block at the end is below the threshold
+    alloc.delete_block(bids[11]);
+    die_unequal(alloc.total_bytes(), 12 * block);
+
+    alloc.delete_block(bids[10]);
+    die_unequal(alloc.total_bytes(), 10 * block);
+    die_unequal(storage.size(), 10 * block);
+    die_unequal(alloc.free_bytes(), 0u);
+
+    // never below the configured size
+    std::vector<foxxll::disk_block_allocator::place> regions;
+    for (size_t i = 1; i < 10; ++i)
+        regions.emplace_back(bids[i].offset, block);
+    alloc.delete_regions(regions);
+    die_unequal(alloc.total_bytes(), 4 * block);
+    die_unequal(alloc.free_bytes(), 3 * block);
+
+    // and the file grows again
+    bids.assign(6, bid_type(&storage, 0));
+    alloc.new_blocks(bids.begin() + 1, bids.end());
+    die_unless(alloc.total_bytes() >= 6 * block);
+}
+
+//! relocate the blocks at the end to the free front
+void test_compact(bool bitmap, uint64_t max_bytes, uint64_t expected_size)
+{
+    foxxll::memory_file storage;
+    foxxll::disk_block_allocator alloc(&storage, make_config(bitmap, 0));
+
+    std::vector<bid_type> bids = allocate_blocks(alloc, &storage);
+
+    std::vector<foxxll::disk_block_allocator::place> regions;
+    for (size_t i = 0; i < 6; ++i)
+        regions.emplace_back(bids[i].offset, block);
+    alloc.delete_regions(regions);
+    bids.erase(bids.begin(), bids.begin() + 6);
+
+    // the owner of the blocks updates their offsets
+    auto relocate = [&bids](uint64_t from, uint64_t to, uint64_t size) {
+                        for (bid_type& bid : bids) {
+                            if (bid.offset >= from && bid.offset < from + size)
+                                bid.offset = bid.offset - from + to;
+                        }
+                        return true;
+                    };
+
+    const uint64_t moved = alloc.compact(max_bytes, relocate);
+
+    die_unequal(alloc.total_bytes(), expected_size);
+    die_unequal(storage.size(), expected_size);
+    die_unequal(moved, 12 * block - expected_size);
+
+    std::set<uint64_t> offsets;
+    for (const bid_type& bid : bids) {
+        die_unless(bid.offset + block <= expected_size);
+        offsets.insert(bid.offset);
+    }
+    die_unequal(offsets.size(), bids.size());
+
+    die_unequal(alloc.used_bytes(), 6 * block);
+}
+
+//! the owner frees a block while it is being moved
+void test_compact_free(bool bitmap)
+{
+    foxxll::memory_file storage;
+    foxxll::disk_block_allocator alloc(&storage, make_config(bitmap, 0));
+
+    std::vector<bid_type> bids = allocate_blocks(alloc, &storage);
+
+    std::vector<foxxll::disk_block_allocator::place> regions;
+    for (size_t i = 0; i < 6; ++i)
+        regions.emplace_back(bids[i].offset, block);
+    alloc.delete_regions(regions);
+    bids.erase(bids.begin(), bids.begin() + 6);
+
+    // the third remaining block is freed during its first move
+    bool freed = false;
+    auto relocate = [&](uint64_t from, uint64_t to, uint64_t size) {
+                        if (!freed && bids[2].offset >= from &&
+                            bids[2].offset < from + size)
+                        {
+                            alloc.delete_block(bids[2]);
+                            bids.erase(bids.begin() + 2);
+                            freed = true;
+                        }
+                        for (bid_type& bid : bids) {
+                            if (bid.offset >= from && bid.offset < from + size)
+                                bid.offset = bid.offset - from + to;
+                        }
+                        return true;
+                    };
+
+    alloc.compact(12 * block, relocate);
+    die_unless(freed);
+
+    // the freed block is free at its new location, the others stay allocated
+    die_unequal(alloc.used_bytes(), 5 * block);
+    die_unequal(alloc.total_bytes(), (bitmap ? 5 : 6) * block);
+
+    std::set<uint64_t> offsets;
+    for (const bid_type& bid : bids) {
+        die_unless(bid.offset + block <= alloc.total_bytes());
+        offsets.insert(bid.offset);
+    }
+    die_unequal(offsets.size(), 5u);
+
+    for (const bid_type& bid : bids)
+        alloc.delete_block(bid);
+    die_unequal(alloc.used_bytes(), 0u);
+}
+
+//! relocate function for compactions which must not move anything
+static bool relocate_none(uint64_t, uint64_t, uint64_t)
+{
+    die("an unowned region was relocated");
+    return false;
+}
+
+//! blocks in thread caches have no owner, compact() refuses to run
+void test_compact_thread_cache()
+{
+    foxxll::memory_file storage;
+    foxxll::disk_config cfg = make_config(false, 0);
+    cfg.thread_cache = 2;
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    bid_type bid(&storage, 0);
+    alloc.new_blocks(&bid, &bid + 1);
+
+    die_unless_throws(alloc.compact(12 * block, relocate_none),
+                      foxxll::bad_parameter);
+
+    alloc.delete_block(bid);
+}
+
+//! compact() stops at an open extent at the end of the file, and moves the
+//! blocks in front of it once the extent is released
+void test_compact_extent(bool bitmap)
+{
+    foxxll::memory_file storage;
+    foxxll::disk_block_allocator alloc(&storage, make_config(bitmap, 0));
+
+    std::vector<bid_type> bids(8, bid_type(&storage, 0));
+    alloc.new_blocks(bids.begin(), bids.begin() + 4);
+    alloc.new_blocks(bids.begin() + 4, bids.end());
+
+    // the extent grows the file behind the blocks
+    uint64_t bytes = 4 * block, pos;
+    die_unless(alloc.reserve_extent(bytes, pos));
+    die_unequal(pos, 8 * block);
+
+    std::vector<foxxll::disk_block_allocator::place> regions;
+    for (size_t i = 0; i < 4; ++i)
+        regions.emplace_back(bids[i].offset, block);
+    alloc.delete_regions(regions);
+    bids.erase(bids.begin(), bids.begin() + 4);
+
+    die_unequal(alloc.compact(12 * block, relocate_none), 0u);
+    die_unequal(alloc.total_bytes(), 12 * block);
+
+    alloc.release_extent(pos, pos, bytes);
+
+    auto relocate = [&bids](uint64_t from, uint64_t to, uint64_t size) {
+                        for (bid_type& bid : bids) {
+                            if (bid.offset >= from && bid.offset < from + size)
+                                bid.offset = bid.offset - from + to;
+                        }
+                        return true;
+                    };
+
+    die_unequal(alloc.compact(12 * block, relocate), 4 * block);
+    die_unequal(alloc.total_bytes(), 4 * block);
+
+    for (const bid_type& bid : bids)
+        alloc.delete_block(bid);
+    die_unequal(alloc.used_bytes(), 0u);
+}
+
+//! an open block_extent_allocator keeps the block_manager from compacting
+//! its extent
+void test_compact_extent_allocator()
+{
+    foxxll::block_manager* bm = foxxll::block_manager::get_instance();
+    const uint64_t total = bm->total_bytes(0);
+
+    {
+        // an extent larger than the disk grows the file
+        foxxll::block_extent_allocator extents(total + 16 * block, bm);
+        bid_type bid;
+        extents.new_block(foxxll::single_disk(0), bid);
+
+        die_unequal(bm->compact(0, ~uint64_t(0), relocate_none), 0u);
+        die_unless(bm->total_bytes(0) > total);
+
+        bm->delete_block(bid);
+    }
+
+    // the released extent is free and truncated
+    die_unequal(bm->compact(0, ~uint64_t(0), relocate_none), 0u);
+    die_unequal(bm->total_bytes(0), total);
+}
+
+int main()
+{
+    for (bool bitmap : { false, true })
+    {
+        test_shrink(bitmap);
+
+        // all blocks are moved to the front
+        test_compact(bitmap, 6 * block, 6 * block);
+
+        test_compact_free(bitmap);
+    }
+
+    // the allocated region of 6 blocks exceeds the bound
+    test_compact(false, 3 * block, 12 * block);
+    // single blocks are moved
+    test_compact(true, 3 * block, 9 * block);
+
+    test_compact_thread_cache();
+    for (bool bitmap : { false, true })
+        test_compact_extent(bitmap);
+    test_compact_extent_allocator();
+
+    return 0;
+}
+
+/**************************************************************************/
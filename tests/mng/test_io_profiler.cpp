@@ -0,0 +1,102 @@
+/***************************************************************************
+ *  tests/mng/test_io_profiler.cpp
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <tlx/die.hpp>
+
+#include <foxxll/io.hpp>
+#include <foxxll/mng.hpp>
+
+using foxxll::io_profiler;
+
+int main()
+{
+    const size_t block = 4096;
+    char* buffer = static_cast<char*>(
+        foxxll::aligned_alloc<foxxll::BlockAlignment>(block));
+
+    foxxll::memory_file file(
+        foxxll::file::DEFAULT_QUEUE, foxxll::file::NO_ALLOCATOR, 1010);
+    file.set_size(4 * block);
+
+    io_profiler* profiler = io_profiler::get_instance();
+
+    {
+        foxxll::scoped_io_phase sort("sort");
+        for (size_t round = 0; round < 2; ++round)
+        {
+            foxxll::scoped_io_phase runs("run formation");
+            file.awrite(buffer, round * block, block)->wait();
+        }
+        {
+            foxxll::scoped_io_phase merge("merge");
+            file.aread(buffer, 0, block)->wait();
+            file.aread(buffer, block, block)->wait();
+            // burn CPU without I/O
+            const double begin = foxxll::timestamp();
+            while (foxxll::timestamp() - begin < 0.05) { }
+        }
+    }
+
+    // phases of another thread start at the root
+    std::thread([]() { foxxll::scoped_io_phase other("other thread"); }).join();
+
+    const io_profiler::phase& root = profiler->get_root();
+    die_unequal(root.children.size(), 2u);
+
+    const io_profiler::phase& sort = *root.children[0];
+    die_unequal(sort.name, "sort");
+    die_unequal(sort.count, 1u);
+    die_unequal(sort.children.size(), 2u);
+    // a phase includes the I/O of its subphases
+    die_unequal(sort.write_bytes, 2 * block);
+    die_unequal(sort.read_bytes, 2 * block);
+
+    const io_profiler::phase& runs = *sort.children[0];
+    die_unequal(runs.name, "run formation");
+    die_unequal(runs.count, 2u);
+    die_unequal(runs.write_bytes, 2 * block);
+    die_unequal(runs.read_bytes, 0u);
+
+    const io_profiler::phase& merge = *sort.children[1];
+    die_unequal(merge.read_bytes, 2 * block);
+    die_unless(merge.wall_time >= 0.05);
+    die_unless(merge.cpu_time > 0.0);
+    die_unless(sort.wall_time >= runs.wall_time + merge.wall_time);
+
+    die_unequal(root.children[1]->name, "other thread");
+    die_unless(root.children[1]->children.empty());
+
+    profiler->set_peak_bandwidth(100.0 * 1024 * 1024);
+    die_unequal(profiler->get_peak_bandwidth(), 100.0 * 1024 * 1024);
+
+    std::ostringstream oss;
+    profiler->report(oss);
+    const std::string text = oss.str();
+    die_unless(text.find("peak bandwidth 100.0 MiB/s") != std::string::npos);
+    die_unless(text.find("\n sort ") != std::string::npos);
+    die_unless(text.find("\n   run formation ") != std::string::npos);
+    die_unless(text.find("CPU-bound") != std::string::npos);
+
+    profiler->clear();
+    die_unless(profiler->get_root().children.empty());
+
+    foxxll::aligned_dealloc<foxxll::BlockAlignment>(buffer);
+
+    return 0;
+}
+
+/**************************************************************************/
@@ -0,0 +1,128 @@
+/***************************************************************************
+ *  tools/benchmark_alloc_strategy.cpp
+ *
+ *  Benchmark the overhead of allocation strategies selected at runtime
+ *  against the compile-time strategy functors.
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/logger.hpp>
+
+#include <foxxll/mng.hpp>
+#include <foxxll/mng/block_alloc_strategy_dynamic.hpp>
+
+using clock_type = std::chrono::steady_clock;
+
+//! nanoseconds per disk assignment, summing the disks to keep the calls
+template <typename Strategy>
+static double time_assign(const Strategy& strategy, size_t num, size_t& sum)
+{
+    clock_type::time_point begin = clock_type::now();
+    for (size_t i = 0; i < num; ++i)
+        sum += strategy(i);
+    return std::chrono::duration<double, std::nano>(
+        clock_type::now() - begin).count() / num;
+}
+
+//! nanoseconds per block allocated and freed through the block_manager
+template <typename Strategy>
+static double time_allocate(const Strategy& strategy, size_t rounds,
+                            size_t batch, size_t block_size)
+{
+    foxxll::block_manager* bm = foxxll::block_manager::get_instance();
+    std::vector<foxxll::BID<0> > bids;
+
+    clock_type::time_point begin = clock_type::now();
+    for (size_t r = 0; r < rounds; ++r)
+    {
+        bids.assign(batch, foxxll::BID<0>(nullptr, 0, block_size));
+        bm->new_blocks(strategy, bids.begin(), bids.end());
+        bm->delete_blocks(bids.begin(), bids.end());
+    }
+    return std::chrono::duration<double, std::nano>(
+        clock_type::now() - begin).count() / (rounds * batch);
+}
+
+template <typename Strategy>
+static void compare(const std::string& name, size_t num, size_t rounds,
+                    size_t batch, size_t block_size)
+{
+    Strategy templated;
+    foxxll::dynamic_alloc_strategy dynamic(name);
+
+    size_t sum = 0;
+    const double t_assign = time_assign(templated, num, sum);
+    const double d_assign = time_assign(dynamic, num, sum);
+
+    const double t_alloc = time_allocate(templated, rounds, batch, block_size);
+    const double d_alloc = time_allocate(dynamic, rounds, batch, block_size);
+
+    LOG1 << "strategy=" << name
+         << " assign_ns_template=" << t_assign
+         << " assign_ns_dynamic=" << d_assign
+         << " alloc_ns_template=" << t_alloc
+         << " alloc_ns_dynamic=" << d_alloc
+         << " overhead=" << (d_alloc - t_alloc) / t_alloc * 100 << "%"
+         << " checksum=" << sum % 2;
+}
+
+int benchmark_alloc_strategy(int argc, char* argv[])
+{
+    tlx::CmdlineParser cp;
+
+    size_t num = 100000000, rounds = 100000, batch = 16;
+    foxxll::external_size_type block_size = 1024 * 1024;
+
+    cp.add_size_t(
+        'n', "num", num,
+        "Number of disk assignments timed per strategy, default: 100000000."
+    );
+    cp.add_size_t(
+        'r', "rounds", rounds,
+        "Number of block batches allocated per strategy, default: 100000."
+    );
+    cp.add_size_t(
+        'b', "batch", batch,
+        "Number of blocks per batch, default: 16."
+    );
+    cp.add_bytes(
+        'B', "block_size", block_size,
+        "Size of blocks, default: 1 MiB."
+    );
+
+    cp.set_description(
+        "Compare the allocation strategy functors used as template parameter "
+        "with the same strategies selected at runtime by name through "
+        "dynamic_alloc_strategy: the time of a single disk assignment, and "
+        "of allocating and freeing blocks on the .foxxll configured disks."
+    );
+
+    if (!cp.process(argc, argv))
+        return -1;
+
+    if (num == 0) num = 1;
+    if (rounds == 0 || batch == 0) rounds = batch = 1;
+
+    const size_t bs = static_cast<size_t>(block_size);
+    compare<foxxll::striping>("striping", num, rounds, batch, bs);
+    compare<foxxll::simple_random>("simple_random", num, rounds, batch, bs);
+    compare<foxxll::fully_random>("fully_random", num, rounds, batch, bs);
+    compare<foxxll::random_cyclic>("random_cyclic", num, rounds, batch, bs);
+    compare<foxxll::load_aware>("load_aware", num, rounds, batch, bs);
+
+    return 0;
+}
+
+/**************************************************************************/
@@ -0,0 +1,224 @@
+/***************************************************************************
+ *  tools/benchmark_allocator.cpp
+ *
+ *  Benchmark allocation time and fragmentation of disk_block_allocator
+ *  placement policies under a random allocate/free workload.
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/logger.hpp>
+#include <tlx/unused.hpp>
+
+#include <foxxll/io/disk_queued_file.hpp>
+#include <foxxll/mng/bid.hpp>
+#include <foxxll/mng/config.hpp>
+#include <foxxll/mng/disk_block_allocator.hpp>
+
+using foxxll::external_size_type;
+
+//! file which only records its size: the benchmark performs no I/O.
+class null_file final : public foxxll::disk_queued_file
+{
+public:
+    null_file()
+        : foxxll::file(),
+          foxxll::disk_queued_file(DEFAULT_QUEUE, NO_ALLOCATOR)
+    { }
+
+    void serve(void* buffer, offset_type offset, size_type bytes,
+               foxxll::request::read_or_write op) final
+    {
+        tlx::unused(buffer, offset, bytes, op);
+    }
+
+    offset_type size() final { return size_; }
+    void set_size(offset_type newsize) final { size_ = newsize; }
+    void lock() final { }
+    const char * io_type() const final { return "null"; }
+
+private:
+    offset_type size_ = 0;
+};
+
+using bid_run = std::vector<foxxll::BID<0> >;
+
+static void run_placement(
+    foxxll::disk_config::placement_type placement, const char* name,
+    external_size_type disk_size, size_t num_ops,
+    size_t min_block_log, size_t max_block_log, size_t max_run, unsigned seed)
+{
+    null_file storage;
+
+    foxxll::disk_config cfg;
+    cfg.size = disk_size;
+    cfg.autogrow = true;
+    cfg.placement = placement;
+
+    foxxll::disk_block_allocator alloc(&storage, cfg);
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> block_log(min_block_log, max_block_log);
+    std::uniform_int_distribution<size_t> run_length(1, max_run);
+
+    std::vector<bid_run> live;
+    external_size_type live_bytes = 0;
+    // keep the disk about 80% full in the steady state
+    const external_size_type target_bytes = disk_size / 5 * 4;
+
+    using clock = std::chrono::steady_clock;
+    clock::duration alloc_time { 0 }, free_time { 0 };
+    size_t num_allocs = 0, num_frees = 0;
+
+    for (size_t op = 0; op < num_ops; ++op)
+    {
+        bool do_alloc = live.empty() || live_bytes < target_bytes ||
+                        (rng() % 2 == 0 && live_bytes < disk_size);
+
+        if (do_alloc)
+        {
+            // a run of equally sized blocks which must be contiguous
+            bid_run run(run_length(rng));
+            const size_t block_size = size_t(1) << block_log(rng);
+            for (foxxll::BID<0>& bid : run) {
+                bid.storage = &storage;
+                bid.size = block_size;
+            }
+
+            clock::time_point begin = clock::now();
+            alloc.new_blocks(run.begin(), run.end());
+            alloc_time += clock::now() - begin;
+            ++num_allocs;
+
+            live_bytes += block_size * run.size();
+            live.emplace_back(std::move(run));
+        }
+        else
+        {
+            // free a random run
+            size_t i = rng() % live.size();
+            std::swap(live[i], live.back());
+
+            clock::time_point begin = clock::now();
+            for (const foxxll::BID<0>& bid : live.back())
+                alloc.delete_block(bid);
+            free_time += clock::now() - begin;
+            ++num_frees;
+
+            live_bytes -= live.back().size() * live.back().front().size;
+            live.pop_back();
+        }
+    }
+
+    const double free_bytes = static_cast<double>(alloc.free_bytes());
+    const double largest = static_cast<double>(alloc.largest_free_region());
+
+    using ns = std::chrono::duration<double, std::nano>;
+    LOG1 << "placement=" << name
+         << " allocs=" << num_allocs
+         << " frees=" << num_frees
+         << " ns/alloc=" << ns(alloc_time).count() / std::max<size_t>(num_allocs, 1)
+         << " ns/free=" << ns(free_time).count() / std::max<size_t>(num_frees, 1)
+         << " free_regions=" << alloc.free_region_count()
+         << " largest_free_region=" << alloc.largest_free_region()
+         << " fragmentation=" << (free_bytes > 0 ? 1.0 - largest / free_bytes : 0.0)
+         << " disk_bytes=" << alloc.total_bytes()
+         << " growth=" << static_cast<double>(alloc.total_bytes()) / disk_size;
+}
+
+int benchmark_allocator(int argc, char* argv[])
+{
+    tlx::CmdlineParser cp;
+
+    external_size_type disk_size = 64 * external_size_type(1024 * 1024 * 1024);
+    size_t num_ops = 1000000;
+    external_size_type min_block = 4096, max_block = 4 * 1024 * 1024;
+    unsigned max_run = 8, seed = 1;
+    std::string placement;
+
+    cp.add_opt_param_string(
+        "placement", placement,
+        "Placement policy: best_fit, first_fit, next_fit (default: all)."
+    );
+    cp.add_bytes(
+        's', "size", disk_size,
+        "Initial size of the simulated disk, default: 64 GiB."
+    );
+    cp.add_size_t(
+        'n', "ops", num_ops,
+        "Number of allocate and free operations, default: 1000000."
+    );
+    cp.add_bytes(
+        0, "min_block", min_block,
+        "Smallest block size, rounded to a power of two, default: 4 KiB."
+    );
+    cp.add_bytes(
+        0, "max_block", max_block,
+        "Largest block size, rounded to a power of two, default: 4 MiB."
+    );
+    cp.add_unsigned(
+        'r', "run", max_run,
+        "Maximum number of contiguous blocks per allocation, default: 8."
+    );
+    cp.add_unsigned(
+        0, "seed", seed,
+        "Random seed, default: 1."
+    );
+
+    cp.set_description(
+        "Benchmark disk_block_allocator placement policies with a random "
+        "workload of allocating and freeing runs of blocks. Reports the "
+        "time per operation and the resulting fragmentation, which is one "
+        "minus the ratio of the largest free region to all free space. "
+        "No I/O is performed."
+    );
+
+    if (!cp.process(argc, argv))
+        return -1;
+
+    size_t min_log = 0, max_log = 0;
+    while ((external_size_type(2) << min_log) <= min_block) ++min_log;
+    while ((external_size_type(2) << max_log) <= max_block) ++max_log;
+    if (min_log > max_log) std::swap(min_log, max_log);
+
+    const std::pair<foxxll::disk_config::placement_type, const char*> policies[] = {
+        { foxxll::disk_config::BEST_FIT, "best_fit" },
+        { foxxll::disk_config::FIRST_FIT, "first_fit" },
+        { foxxll::disk_config::NEXT_FIT, "next_fit" }
+    };
+
+    bool found = false;
+    for (const auto& p : policies)
+    {
+        if (!placement.empty() && placement != p.second)
+            continue;
+
+        run_placement(p.first, p.second, disk_size, num_ops,
+                      min_log, max_log, max_run, seed);
+        found = true;
+    }
+
+    if (!found) {
+        LOG1 << "Unknown placement policy '" << placement << "'";
+        cp.print_usage();
+        return -1;
+    }
+
+    return 0;
+}
+
+/**************************************************************************/
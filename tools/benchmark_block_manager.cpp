@@ -0,0 +1,126 @@
+/***************************************************************************
+ *  tools/benchmark_block_manager.cpp
+ *
+ *  Benchmark concurrent block allocation and deallocation through the
+ *  block_manager with an increasing number of threads.
+ *
+ *  Part of FOXXLL. See http://foxxll.org
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <tlx/cmdline_parser.hpp>
+#include <tlx/logger.hpp>
+
+#include <foxxll/mng.hpp>
+
+using foxxll::external_size_type;
+
+//! each thread repeatedly allocates a batch of blocks, keeps a few batches
+//! alive and frees the oldest one, like run formation does.
+static void allocation_worker(
+    size_t rounds, size_t batch, size_t block_size, size_t live_batches)
+{
+    foxxll::block_manager* bm = foxxll::block_manager::get_instance();
+
+    std::vector<std::vector<foxxll::BID<0> > > live(live_batches);
+
+    for (size_t r = 0; r < rounds; ++r)
+    {
+        std::vector<foxxll::BID<0> >& bids = live[r % live_batches];
+
+        if (!bids.empty())
+            bm->delete_blocks(bids.begin(), bids.end());
+
+        bids.assign(batch, foxxll::BID<0>(nullptr, 0, block_size));
+        bm->new_blocks(foxxll::striping(), bids.begin(), bids.end());
+    }
+
+    for (std::vector<foxxll::BID<0> >& bids : live)
+        bm->delete_blocks(bids.begin(), bids.end());
+}
+
+int benchmark_block_manager(int argc, char* argv[])
+{
+    tlx::CmdlineParser cp;
+
+    unsigned max_threads = std::thread::hardware_concurrency();
+    size_t rounds = 100000, batch = 4, live_batches = 16;
+    external_size_type block_size = 2 * 1024 * 1024;
+
+    cp.add_unsigned(
+        't', "threads", max_threads,
+        "Maximum number of threads, doubled from 1, default: all cores."
+    );
+    cp.add_size_t(
+        'n', "rounds", rounds,
+        "Number of batches allocated and freed per thread, default: 100000."
+    );
+    cp.add_size_t(
+        'b', "batch", batch,
+        "Number of blocks per batch, default: 4."
+    );
+    cp.add_size_t(
+        'l', "live", live_batches,
+        "Number of batches each thread keeps allocated, default: 16."
+    );
+    cp.add_bytes(
+        'B', "block_size", block_size,
+        "Size of blocks, default: 2 MiB."
+    );
+
+    cp.set_description(
+        "Benchmark the throughput of concurrent block allocation and "
+        "deallocation through the block_manager on the .foxxll configured "
+        "disks, using striping. No I/O is performed, but the disk files may "
+        "grow."
+    );
+
+    if (!cp.process(argc, argv))
+        return -1;
+
+    if (max_threads == 0) max_threads = 1;
+    if (live_batches == 0) live_batches = 1;
+
+    // initialize disk configuration
+    foxxll::block_manager::get_instance();
+
+    using clock = std::chrono::steady_clock;
+
+    for (unsigned threads = 1; ; threads = std::min(2 * threads, max_threads))
+    {
+        clock::time_point begin = clock::now();
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t)
+            workers.emplace_back(allocation_worker, rounds, batch,
+                                 static_cast<size_t>(block_size), live_batches);
+        for (std::thread& w : workers)
+            w.join();
+
+        const double seconds =
+            std::chrono::duration<double>(clock::now() - begin).count();
+        const double ops = 2.0 * threads * rounds * batch;
+
+        LOG1 << "threads=" << threads
+             << " blocks=" << threads * rounds * batch
+             << " time=" << seconds
+             << " Mops/s=" << ops / seconds / 1e6
+             << " ns/op=" << seconds * 1e9 / ops * threads;
+
+        if (threads == max_threads)
+            break;
+    }
+
+    return 0;
+}
+
+/**************************************************************************/
@@ -38,6 +38,7 @@
 
 #include <foxxll/io.hpp>
 #include <foxxll/mng.hpp>
+#include <foxxll/mng/block_alloc_strategy_dynamic.hpp>
 
 using foxxll::timestamp;
 using foxxll::external_size_type;
@@ -115,6 +116,8 @@ int benchmark_disks_alloc(
             buffer[j][i] = static_cast<uint32_t>(j * block_size + i);
     }
 
+    const foxxll::stats_data stats_begin(*foxxll::stats::get_instance());
+
     try {
         AllocStrategy alloc;
         size_t current_batch_size;
@@ -241,6 +244,44 @@ int benchmark_disks_alloc(
          << std::setw(5) << std::setprecision(1)
          << (double(total_size_read) / MiB / total_time_read) << " MiB/s read";
 
+    const foxxll::stats_data stats_io =
+        foxxll::stats_data(*foxxll::stats::get_instance()) - stats_begin;
+    const foxxll::latency_histogram_data write_latency = stats_io.get_write_latency();
+    const foxxll::latency_histogram_data read_latency = stats_io.get_read_latency();
+
+    LOG1 << "# Latency p50/p99/p99.9/max: write "
+         << std::setprecision(3)
+         << write_latency.percentile(0.5) * 1e3 << "/"
+         << write_latency.percentile(0.99) * 1e3 << "/"
+         << write_latency.percentile(0.999) * 1e3 << "/"
+         << write_latency.percentile(1.0) * 1e3 << " ms, read "
+         << read_latency.percentile(0.5) * 1e3 << "/"
+         << read_latency.percentile(0.99) * 1e3 << "/"
+         << read_latency.percentile(0.999) * 1e3 << "/"
+         << read_latency.percentile(1.0) * 1e3 << " ms";
+
+    const auto utilization = stats_io.get_utilization_summary();
+    if (stats_io.num_files() != 0)
+    {
+        std::stringstream ss;
+        ss << "# Utilization per disk:" << std::fixed << std::setprecision(1);
+        for (const foxxll::file_stats_data& fsd : stats_io.get_file_stats_data_list())
+            ss << " " << fsd.get_device_id() << "@ "
+               << fsd.get_busy_time() / stats_io.get_elapsed_time() * 100.0 << "%";
+        LOG1 << ss.str();
+    }
+
+    const std::vector<unsigned> saturated = stats_io.get_saturated_devices();
+    if (!saturated.empty())
+    {
+        std::stringstream ss;
+        ss << "# WARNING: disk(s)";
+        for (const unsigned& d : saturated)
+            ss << " " << d;
+        ss << " saturated while others idle, check the striping.";
+        LOG1 << ss.str();
+    }
+
     std::cout << "RESULT"
               << (getenv("RESULT") ? getenv("RESULT") : "")
               << " size=" << size
@@ -254,6 +295,15 @@ int benchmark_disks_alloc(
               << " read_size=" << total_size_read
               << " time=" << (total_time_write + total_time_read)
               << " total_size=" << (total_size_write + total_size_read)
+              << " write_p50=" << write_latency.percentile(0.5)
+              << " write_p99=" << write_latency.percentile(0.99)
+              << " write_p999=" << write_latency.percentile(0.999)
+              << " read_p50=" << read_latency.percentile(0.5)
+              << " read_p99=" << read_latency.percentile(0.99)
+              << " read_p999=" << read_latency.percentile(0.999)
+              << " utilization_min=" << utilization.min
+              << " utilization_max=" << utilization.max
+              << " saturated=" << saturated.size()
               << std::endl;
 
     delete[] reqs;
@@ -289,7 +339,7 @@ int benchmark_disks(int argc, char* argv[])
     );
     cp.add_opt_param_string(
         "alloc", allocstr,
-        "Block allocation strategy: random_cyclic, simple_random, fully_random, striping. (default: random_cyclic)"
+        "Block allocation strategy: random_cyclic, simple_random, fully_random, striping, load_aware. (default: random_cyclic)"
     );
 
     cp.add_unsigned(
@@ -340,6 +390,18 @@ int benchmark_disks(int argc, char* argv[])
             return benchmark_disks_alloc<foxxll::striping>(
                 size, offset, batch_size, block_size, optrw
             );
+        if (allocstr == "load_aware")
+            return benchmark_disks_alloc<foxxll::load_aware>(
+                size, offset, batch_size, block_size, optrw
+            );
+
+        // any other strategy registered for runtime selection
+        if (foxxll::alloc_strategy_registry::get_instance()->contains(allocstr)) {
+            foxxll::config::get_instance()->set_alloc_strategy(allocstr);
+            return benchmark_disks_alloc<foxxll::dynamic_alloc_strategy>(
+                size, offset, batch_size, block_size, optrw
+            );
+        }
 
         LOG1 << "Unknown allocation strategy '" << allocstr << "'";
         cp.print_usage();
@@ -91,8 +91,14 @@ int create_files(int argc, char* argv[])
 {
     std::vector<std::string> disks_arr;
     external_size_type offset = 0, length;
+    bool prealloc = false;
 
     tlx::CmdlineParser cp;
+    cp.add_bool(
+        'p', "prealloc", prealloc,
+        "Allocate the files' disk space with fallocate() instead of "
+        "writing every byte."
+    );
     cp.add_param_bytes(
         "filesize", length,
         "Number of bytes to write to files."
@@ -168,6 +174,22 @@ int create_files(int argc, char* argv[])
 #endif
     }
 
+    if (prealloc)
+    {
+        for (i = 0; i < ndisks; i++)
+        {
+            double begin = timestamp();
+            disks[i]->preallocate(endpos);
+            double end = timestamp();
+
+            LOG1 << "Preallocated " << endpos / MB << " MiB on "
+                 << disks_arr[i] << " in " << (end - begin) << " s";
+        }
+
+        // nothing left to write
+        offset = endpos;
+    }
+
     while (offset < endpos)
     {
         std::stringstream ss;
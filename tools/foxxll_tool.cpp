@@ -47,6 +47,9 @@ extern int benchmark_disks(int argc, char* argv[]);
 extern int benchmark_files(int argc, char* argv[]);
 extern int benchmark_sort(int argc, char* argv[]);
 extern int benchmark_disks_random(int argc, char* argv[]);
+extern int benchmark_allocator(int argc, char* argv[]);
+extern int benchmark_block_manager(int argc, char* argv[]);
+extern int benchmark_alloc_strategy(int argc, char* argv[]);
 extern int benchmark_pqueue(int argc, char* argv[]);
 extern int do_mlock(int argc, char* argv[]);
 extern int do_mallinfo(int argc, char* argv[]);
@@ -82,6 +85,21 @@ struct SubTool subtools[] = {
         "benchmark_disks_random", &benchmark_disks_random, false,
         "Benchmark random block access time to .foxxll configured disks."
     },
+    {
+        "benchmark_allocator", &benchmark_allocator, false,
+        "Benchmark allocation time and fragmentation of the disk block "
+        "allocator's placement policies."
+    },
+    {
+        "benchmark_block_manager", &benchmark_block_manager, false,
+        "Benchmark concurrent block allocation through the block manager "
+        "with an increasing number of threads."
+    },
+    {
+        "benchmark_alloc_strategy", &benchmark_alloc_strategy, false,
+        "Benchmark the overhead of allocation strategies selected at runtime "
+        "against the compile-time strategies."
+    },
     { nullptr, nullptr, false, nullptr }
 };
 